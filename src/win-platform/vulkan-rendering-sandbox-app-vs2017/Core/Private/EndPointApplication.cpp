@@ -1,4 +1,9 @@
 #include "../Public/EndPointApplication.hpp"
+#include "../Public/Infrastructure/Scene/SceneFile.hpp"
+
+#include <atomic>
+#include <exception>
+#include <thread>
 
 VulkanCore::EndPointApplication::EndPointApplication() :
 	width(1280),
@@ -30,12 +35,49 @@ VulkanCore::EndPointApplication::~EndPointApplication()
 
 void VulkanCore::EndPointApplication::Run()
 {
+	this->ApplySceneFromEnvironment();
 	this->OpenWindow();
 	this->Init();
 	this->Loop();
 	this->Clean();
 }
 
+// renders without a window or swap chain and saves the last frame, for CI and render nodes
+void VulkanCore::EndPointApplication::RunHeadless(uint32_t frameCount, const std::string& outputPath)
+{
+	this->window = nullptr;
+	this->ApplySceneFromEnvironment();
+
+	this->VkEngine = new RenderEngine(
+		this->width,
+		this->height,
+		this->modelPath,
+		this->baseColorTexturePath,
+		RenderEngine::GetSampleCountFromEnvironment(),
+		RenderEngine::GetPostProcessNoiseFromEnvironment(),
+		RenderEngine::GetMeshletCullingFromEnvironment()
+	);
+
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		this->Update();
+	}
+
+	std::vector<uint8_t> pixels;
+	this->VkEngine->ReadbackFrame(pixels);
+
+	ShaderExtensions::SaveTextureImage(
+		outputPath.c_str(),
+		static_cast<int>(this->VkEngine->GetFrameWidth()),
+		static_cast<int>(this->VkEngine->GetFrameHeight()),
+		pixels);
+
+	std::cout << "headless frame saved to " << outputPath << std::endl;
+
+	this->Wait();
+	this->VkEngine->CleanPipeline();
+}
+
 void VulkanCore::EndPointApplication::OpenWindow()
 {
 	glfwInit();
@@ -52,7 +94,10 @@ void VulkanCore::EndPointApplication::OpenWindow()
 		this->height,
 		this->modelPath,
 		this->baseColorTexturePath,
-		this->window
+		this->window,
+		RenderEngine::GetSampleCountFromEnvironment(),
+		RenderEngine::GetPostProcessNoiseFromEnvironment(),
+		RenderEngine::GetMeshletCullingFromEnvironment()
 	);
 }
 
@@ -73,6 +118,12 @@ void VulkanCore::EndPointApplication::Update()
 
 void VulkanCore::EndPointApplication::Loop()
 {
+	if (RenderEngine::GetPipelinedUpdateFromEnvironment())
+	{
+		this->LoopPipelined();
+		return;
+	}
+
 	while (!glfwWindowShouldClose(this->window))
 	{
 		glfwPollEvents();
@@ -82,6 +133,85 @@ void VulkanCore::EndPointApplication::Loop()
 	this->Wait();
 }
 
+// glfw only takes events on the main thread, so it stays the render thread and the simulation moves out
+void VulkanCore::EndPointApplication::LoopPipelined()
+{
+	this->VkEngine->SetPipelinedUpdate(true);
+
+	std::atomic<bool> updateFailed{ false };
+	std::exception_ptr updateFailure;
+
+	std::thread updateThread([this, &updateFailed, &updateFailure]() {
+		try
+		{
+			// one packet ahead of rendering is enough, frames that are never drawn are not simulated
+			while (this->VkEngine->WaitForFramePacketConsumed())
+			{
+				this->VkEngine->UpdateFramePacket();
+			}
+		}
+		catch (...)
+		{
+			updateFailure = std::current_exception();
+			updateFailed.store(true, std::memory_order_release);
+		}
+	});
+
+	try
+	{
+		while (!glfwWindowShouldClose(this->window) && !updateFailed.load(std::memory_order_acquire))
+		{
+			glfwPollEvents();
+			this->Update();
+		}
+	}
+	catch (...)
+	{
+		this->VkEngine->CancelFramePacketWait();
+		updateThread.join();
+		throw;
+	}
+
+	this->VkEngine->CancelFramePacketWait();
+	updateThread.join();
+
+	this->Wait();
+	this->VkEngine->SetPipelinedUpdate(false);
+
+	if (updateFailure)
+	{
+		std::rethrow_exception(updateFailure);
+	}
+}
+
+void VulkanCore::EndPointApplication::ApplySceneFromEnvironment()
+{
+	const std::string scenePath = SceneFile::GetPathFromEnvironment();
+
+	if (scenePath.empty())
+	{
+		return;
+	}
+
+	const SceneFile scene(scenePath);
+	const uint32_t meshNode = scene.FindFirstMeshNode();
+
+	if (meshNode == SceneFile::NO_INDEX)
+	{
+		throw std::runtime_error("scene " + scenePath + " has no mesh node");
+	}
+
+	const SceneFileNode& node = scene.GetNodes()[meshNode];
+	this->modelPath = scene.GetString(scene.GetMeshes()[node.mesh].path);
+
+	if (node.material != SceneFile::NO_INDEX && scene.GetMaterials()[node.material].baseColorTexture != SceneFile::NO_INDEX)
+	{
+		this->baseColorTexturePath = scene.GetString(scene.GetTextures()[scene.GetMaterials()[node.material].baseColorTexture].path);
+	}
+
+	std::cout << "scene " << scenePath << ": " << scene.GetNodeCount() << " nodes, drawing " << scene.GetString(node.name) << std::endl;
+}
+
 void VulkanCore::EndPointApplication::Clean()
 {
 	this->VkEngine->CleanPipeline();
@@ -0,0 +1,1008 @@
+#include "../../../Public/Infrastructure/Benchmarks/BenchmarkHarness.hpp"
+#include "../../../Public/Infrastructure/Math/SimdKernels.hpp"
+#include "../../../Public/Infrastructure/Scene/SceneCompiler.hpp"
+#include "../../../Public/Infrastructure/Scene/SceneFile.hpp"
+#include "../../../Public/Infrastructure/Scene/SceneGraph.hpp"
+#include "../../../Public/Infrastructure/Tasks/JobSystem.hpp"
+#include "../../../Public/RenderEngine.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	// the usual heap allocated node with child pointers, updated recursively with full matrix products
+	struct PointerSceneNode
+	{
+		glm::vec3 translation;
+		glm::quat rotation;
+		glm::vec3 scale;
+		glm::mat4 world;
+		std::vector<PointerSceneNode*> children;
+	};
+
+	void UpdatePointerSceneNode(PointerSceneNode* node, const glm::mat4& parentWorld)
+	{
+		node->world = parentWorld
+			* glm::translate(glm::mat4(1.0f), node->translation)
+			* glm::mat4_cast(node->rotation)
+			* glm::scale(glm::mat4(1.0f), node->scale);
+
+		for (PointerSceneNode* child : node->children)
+		{
+			UpdatePointerSceneNode(child, node->world);
+		}
+	}
+}
+
+VulkanCore::BenchmarkHarness::BenchmarkHarness(const BenchmarkSettings& settings) :
+	Settings(settings)
+{
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::Run()
+{
+	const auto loadStart = std::chrono::high_resolution_clock::now();
+
+	// headless keeps the run free of vsync, window events and the frame throttle
+	RenderEngine engine(
+		this->Settings.width,
+		this->Settings.height,
+		this->Settings.modelPath,
+		this->Settings.baseColorTexturePath,
+		this->Settings.sampleCount,
+		this->Settings.postProcessNoise,
+		this->Settings.meshletCulling);
+
+	const auto loadEnd = std::chrono::high_resolution_clock::now();
+
+	engine.SetFixedTimestep(this->Settings.timestepSeconds);
+
+	std::vector<double> cpuFrameTimes;
+	std::vector<double> gpuFrameTimes;
+	cpuFrameTimes.reserve(this->Settings.frameCount);
+	gpuFrameTimes.reserve(this->Settings.frameCount);
+
+	uint64_t lastGpuFrame = 0;
+	bool hasGpuFrame = false;
+	double timeToFirstFrame = 0.0;
+
+	const uint32_t totalFrames = this->Settings.warmupFrames + this->Settings.frameCount;
+
+	for (uint32_t frame = 0; frame < totalFrames; ++frame)
+	{
+		const auto frameStart = std::chrono::high_resolution_clock::now();
+
+		engine.Draw();
+
+		const auto frameEnd = std::chrono::high_resolution_clock::now();
+
+		if (frame == 0)
+		{
+			timeToFirstFrame = std::chrono::duration<double, std::milli>(frameEnd - loadStart).count();
+		}
+
+		if (frame < this->Settings.warmupFrames)
+		{
+			continue;
+		}
+
+		cpuFrameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+
+		uint64_t gpuFrame;
+		double gpuFrameTime;
+
+		// timestamps arrive MAX_FRAMES_IN_FLIGHT frames late, warmup frames are skipped here as well
+		if (engine.GetLastGpuFrameTime(gpuFrame, gpuFrameTime)
+			&& gpuFrame >= this->Settings.warmupFrames
+			&& (!hasGpuFrame || gpuFrame != lastGpuFrame))
+		{
+			gpuFrameTimes.push_back(gpuFrameTime);
+			lastGpuFrame = gpuFrame;
+			hasGpuFrame = true;
+		}
+	}
+
+	engine.WaitDevice();
+
+	nlohmann::json report;
+
+	report["settings"] = {
+		{ "device", engine.GetDeviceName() },
+		{ "model", this->Settings.modelPath },
+		{ "baseColorTexture", this->Settings.baseColorTexturePath },
+		{ "width", this->Settings.width },
+		{ "height", this->Settings.height },
+		{ "requestedSampleCount", this->Settings.sampleCount },
+		{ "sampleCount", engine.GetSampleCount() },
+		{ "postProcessNoise", this->Settings.postProcessNoise },
+		{ "meshletCulling", this->Settings.meshletCulling },
+		{ "frames", this->Settings.frameCount },
+		{ "warmupFrames", this->Settings.warmupFrames },
+		{ "timestepSeconds", this->Settings.timestepSeconds }
+	};
+
+	nlohmann::json loadTimings = nlohmann::json::object();
+
+	for (const auto& phase : engine.GetLoadTimings())
+	{
+		loadTimings[phase.first] = phase.second;
+	}
+
+	loadTimings["total"] = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+	loadTimings["timeToFirstFrame"] = timeToFirstFrame;
+
+	report["loadMs"] = loadTimings;
+	report["cpuFrameMs"] = Summarize(cpuFrameTimes);
+	report["gpuFrameMs"] = Summarize(gpuFrameTimes);
+
+	// rolling per-scope statistics over the last frames of the run
+	nlohmann::json gpuScopes = nlohmann::json::object();
+
+	for (const auto& scope : engine.GetGpuProfiler()->GetStatistics())
+	{
+		gpuScopes[scope.first] = {
+			{ "samples", scope.second.sampleCount },
+			{ "mean", scope.second.averageMilliseconds },
+			{ "min", scope.second.minMilliseconds },
+			{ "max", scope.second.maxMilliseconds },
+			{ "last", scope.second.lastMilliseconds }
+		};
+	}
+
+	report["gpuScopesMs"] = gpuScopes;
+	report["memory"] = {
+		{ "peakResidentBytes", GetPeakResidentBytes() },
+		{ "textureResidentBytes", static_cast<uint64_t>(engine.GetTextureResidentBytes()) },
+		{ "renderTargetBytes", static_cast<uint64_t>(engine.GetRenderGraph()->GetTransientMemorySize()) },
+		{ "lazilyAllocatedRenderTargetBytes", static_cast<uint64_t>(engine.GetRenderGraph()->GetLazilyAllocatedMemorySize()) }
+	};
+
+	// the fixed camera keeps the level of detail constant over the run
+	nlohmann::json lodTriangles = nlohmann::json::array();
+
+	for (const auto& lod : engine.GetModelLods())
+	{
+		lodTriangles.push_back(lod.indexCount / 3);
+	}
+
+	report["mesh"] = {
+		{ "lod", engine.GetModelLod() },
+		{ "triangles", lodTriangles[engine.GetModelLod()] },
+		{ "lodTriangles", lodTriangles },
+		{ "meshlets", engine.GetModelLods()[engine.GetModelLod()].meshletCount },
+		{ "visibleMeshlets", engine.CountVisibleMeshlets() }
+	};
+
+	return report;
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::CompareSampleCounts(const std::vector<uint32_t>& sampleCounts)
+{
+	const uint32_t configuredSampleCount = this->Settings.sampleCount;
+
+	nlohmann::json runs = nlohmann::json::array();
+	nlohmann::json comparison = nlohmann::json::array();
+
+	for (const uint32_t sampleCount : sampleCounts)
+	{
+		this->Settings.sampleCount = sampleCount;
+
+		const nlohmann::json run = this->Run();
+		const uint32_t usedSampleCount = run["settings"]["sampleCount"];
+
+		// counts above the device limit are clamped, a repeated count would only measure noise
+		const bool alreadyMeasured = std::any_of(comparison.begin(), comparison.end(), [usedSampleCount](const nlohmann::json& entry) {
+			return entry["sampleCount"] == usedSampleCount;
+		});
+
+		if (alreadyMeasured)
+		{
+			continue;
+		}
+
+		comparison.push_back({
+			{ "sampleCount", usedSampleCount },
+			{ "cpuFrameMsMean", run["cpuFrameMs"].value("mean", 0.0) },
+			{ "gpuFrameMsMean", run["gpuFrameMs"].value("mean", 0.0) },
+			{ "gpuFrameMsP95", run["gpuFrameMs"].value("p95", 0.0) },
+			{ "renderTargetBytes", run["memory"]["renderTargetBytes"] }
+		});
+		runs.push_back(run);
+	}
+
+	this->Settings.sampleCount = configuredSampleCount;
+
+	nlohmann::json report;
+	report["comparison"] = comparison;
+	report["runs"] = runs;
+
+	return report;
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::CompareFragmentThroughput(const std::vector<uint32_t>& resolutionScales)
+{
+	const int configuredWidth = this->Settings.width;
+	const int configuredHeight = this->Settings.height;
+
+	nlohmann::json runs = nlohmann::json::array();
+	nlohmann::json comparison = nlohmann::json::array();
+
+	for (const uint32_t scale : resolutionScales)
+	{
+		this->Settings.width = configuredWidth * static_cast<int>(scale);
+		this->Settings.height = configuredHeight * static_cast<int>(scale);
+
+		const nlohmann::json run = this->Run();
+		const double pixels = static_cast<double>(this->Settings.width) * static_cast<double>(this->Settings.height);
+
+		// the camera is fixed, so the model covers the same share of the target at every scale and
+		// the main pass shades proportionally more fragments
+		const double mainPassMs = run["gpuScopesMs"].value("main pass", nlohmann::json::object()).value("mean", 0.0);
+
+		comparison.push_back({
+			{ "width", this->Settings.width },
+			{ "height", this->Settings.height },
+			{ "mainPassMsMean", mainPassMs },
+			{ "mainPassNsPerPixel", mainPassMs * 1e6 / pixels },
+			{ "gpuFrameMsMean", run["gpuFrameMs"].value("mean", 0.0) },
+			{ "gpuFrameMsP95", run["gpuFrameMs"].value("p95", 0.0) }
+		});
+		runs.push_back(run);
+	}
+
+	this->Settings.width = configuredWidth;
+	this->Settings.height = configuredHeight;
+
+	nlohmann::json report;
+	report["comparison"] = comparison;
+	report["runs"] = runs;
+
+	return report;
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::CompareWorleyNoise(uint32_t cpuIterations)
+{
+	const uint32_t width = static_cast<uint32_t>(this->Settings.width);
+	const uint32_t height = static_cast<uint32_t>(this->Settings.height);
+
+	std::vector<double> naiveTimes;
+	std::vector<double> tiledTimes;
+	std::vector<float> naiveDistances;
+	std::vector<float> tiledDistances;
+	float maxDifference = 0.0f;
+
+	for (uint32_t iteration = 0; iteration < cpuIterations; ++iteration)
+	{
+		// the same simulated frames the GPU runs animate through
+		const float time = static_cast<float>(iteration * this->Settings.timestepSeconds);
+		const WorleyNoiseConstants constants = WorleyNoise::GetConstants(WorleyNoiseParameters(), time);
+
+		const auto naiveStart = std::chrono::high_resolution_clock::now();
+		WorleyNoise::RenderNaive(width, height, constants, naiveDistances);
+		const auto tiledStart = std::chrono::high_resolution_clock::now();
+		WorleyNoise::RenderTiled(width, height, constants, tiledDistances);
+		const auto tiledEnd = std::chrono::high_resolution_clock::now();
+
+		naiveTimes.push_back(std::chrono::duration<double, std::milli>(tiledStart - naiveStart).count());
+		tiledTimes.push_back(std::chrono::duration<double, std::milli>(tiledEnd - tiledStart).count());
+
+		for (size_t i = 0; i < naiveDistances.size(); ++i)
+		{
+			maxDifference = std::max(maxDifference, std::abs(naiveDistances[i] - tiledDistances[i]));
+		}
+	}
+
+	const bool configuredNoise = this->Settings.postProcessNoise;
+
+	this->Settings.postProcessNoise = false;
+	const nlohmann::json baseline = this->Run();
+
+	this->Settings.postProcessNoise = true;
+	const nlohmann::json withNoise = this->Run();
+
+	this->Settings.postProcessNoise = configuredNoise;
+
+	nlohmann::json report;
+	report["cpuReference"] = {
+		{ "naiveMs", Summarize(naiveTimes) },
+		{ "tiledMs", Summarize(tiledTimes) },
+		{ "maxDifference", maxDifference }
+	};
+	report["gpu"] = {
+		{ "baselineFrameMsMean", baseline["gpuFrameMs"].value("mean", 0.0) },
+		{ "noiseFrameMsMean", withNoise["gpuFrameMs"].value("mean", 0.0) },
+		{ "noisePassMs", withNoise["gpuScopesMs"].value("worley noise", nlohmann::json::object()) },
+		{ "presentCopyMs", withNoise["gpuScopesMs"].value("present copy", nlohmann::json::object()) }
+	};
+	report["runs"] = { baseline, withNoise };
+
+	return report;
+}
+
+void VulkanCore::BenchmarkHarness::WriteReport(const nlohmann::json& report) const
+{
+	std::ofstream reportFile(this->Settings.outputPath);
+
+	if (!reportFile.is_open())
+	{
+		throw std::runtime_error("failed to open benchmark report " + this->Settings.outputPath);
+	}
+
+	reportFile << report.dump(4) << std::endl;
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::Summarize(std::vector<double> samples)
+{
+	nlohmann::json summary;
+	summary["samples"] = samples.size();
+
+	if (samples.empty())
+	{
+		return summary;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	summary["min"] = samples.front();
+	summary["mean"] = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+	summary["p50"] = Percentile(samples, 50.0);
+	summary["p90"] = Percentile(samples, 90.0);
+	summary["p95"] = Percentile(samples, 95.0);
+	summary["p99"] = Percentile(samples, 99.0);
+	summary["max"] = samples.back();
+
+	return summary;
+}
+
+// nearest-rank percentile of already sorted samples
+double VulkanCore::BenchmarkHarness::Percentile(const std::vector<double>& sortedSamples, double percentile)
+{
+	const double rank = std::ceil(percentile / 100.0 * static_cast<double>(sortedSamples.size()));
+	const size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+
+	return sortedSamples[std::min(index, sortedSamples.size() - 1)];
+}
+
+uint64_t VulkanCore::BenchmarkHarness::GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+
+	return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+#else
+	rusage usage = {};
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+
+	// kilobytes on Linux
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::CompareSceneGraph(uint32_t nodeCount, uint32_t iterations)
+{
+	if (nodeCount == 0)
+	{
+		throw std::invalid_argument("the scene benchmark needs at least one node!");
+	}
+
+	// a single root with four children per node, every node slightly offset and turned from its parent
+	const glm::vec3 zAxis(0.0f, 0.0f, 1.0f);
+
+	SceneGraph scene;
+	scene.Reserve(nodeCount);
+
+	std::vector<PointerSceneNode*> pointerNodes(nodeCount);
+
+	for (uint32_t node = 0; node < nodeCount; ++node)
+	{
+		const SceneNodeId parent = node == 0 ? SceneGraph::NO_PARENT : (node - 1) / 4;
+		const glm::vec3 translation(static_cast<float>(node % 4) - 1.5f, 0.0f, 1.0f);
+		const glm::quat rotation = glm::angleAxis(glm::radians(static_cast<float>(node % 7)), zAxis);
+		const glm::vec3 scale(0.9f);
+
+		scene.AddNode(parent, translation, rotation, scale);
+
+		pointerNodes[node] = new PointerSceneNode{ translation, rotation, scale, glm::mat4(1.0f), {} };
+
+		if (parent != SceneGraph::NO_PARENT)
+		{
+			pointerNodes[parent]->children.push_back(pointerNodes[node]);
+		}
+	}
+
+	scene.UpdateWorldTransforms();
+
+	std::vector<double> fullTimes;
+	std::vector<double> partialTimes;
+	std::vector<double> cleanTimes;
+	std::vector<double> pointerTimes;
+	uint32_t partialUpdatedCount = 0;
+
+	for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		const glm::quat rootRotation = glm::angleAxis(static_cast<float>(iteration) * 0.01f, zAxis);
+
+		// turning the root moves every node
+		const auto fullStart = std::chrono::high_resolution_clock::now();
+		scene.SetRotation(0, rootRotation);
+		scene.UpdateWorldTransforms();
+		const auto fullEnd = std::chrono::high_resolution_clock::now();
+
+		pointerNodes[0]->rotation = rootRotation;
+		const auto pointerStart = std::chrono::high_resolution_clock::now();
+		UpdatePointerSceneNode(pointerNodes[0], glm::mat4(1.0f));
+		const auto pointerEnd = std::chrono::high_resolution_clock::now();
+
+		// an animated node in every hundred, most of them leaves like in a typical scene
+		const auto partialStart = std::chrono::high_resolution_clock::now();
+		for (uint32_t node = 1 + iteration % 100; node < nodeCount; node += 100)
+		{
+			scene.SetRotation(node, rootRotation);
+		}
+		partialUpdatedCount = scene.UpdateWorldTransforms();
+		const auto partialEnd = std::chrono::high_resolution_clock::now();
+
+		const auto cleanStart = std::chrono::high_resolution_clock::now();
+		scene.UpdateWorldTransforms();
+		const auto cleanEnd = std::chrono::high_resolution_clock::now();
+
+		fullTimes.push_back(std::chrono::duration<double, std::milli>(fullEnd - fullStart).count());
+		pointerTimes.push_back(std::chrono::duration<double, std::milli>(pointerEnd - pointerStart).count());
+		partialTimes.push_back(std::chrono::duration<double, std::milli>(partialEnd - partialStart).count());
+		cleanTimes.push_back(std::chrono::duration<double, std::milli>(cleanEnd - cleanStart).count());
+	}
+
+	// both trees are compared after one more full update with the same local transforms
+	for (uint32_t node = 0; node < nodeCount; ++node)
+	{
+		pointerNodes[node]->rotation = scene.GetRotation(node);
+	}
+
+	scene.SetRotation(0, scene.GetRotation(0));
+	scene.UpdateWorldTransforms();
+	UpdatePointerSceneNode(pointerNodes[0], glm::mat4(1.0f));
+
+	float maxDifference = 0.0f;
+
+	for (uint32_t node = 0; node < nodeCount; ++node)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				maxDifference = std::max(maxDifference, std::abs(scene.GetWorldTransform(node)[column][row] - pointerNodes[node]->world[column][row]));
+			}
+		}
+	}
+
+	for (PointerSceneNode* node : pointerNodes)
+	{
+		delete node;
+	}
+
+	nlohmann::json report;
+	report["settings"] = {
+		{ "nodes", nodeCount },
+		{ "iterations", iterations }
+	};
+	report["sceneGraph"] = {
+		{ "fullUpdateMs", Summarize(fullTimes) },
+		{ "partialUpdateMs", Summarize(partialTimes) },
+		{ "partialUpdatedNodes", partialUpdatedCount },
+		{ "cleanUpdateMs", Summarize(cleanTimes) }
+	};
+	report["pointerTree"] = {
+		{ "fullUpdateMs", Summarize(pointerTimes) }
+	};
+	report["maxDifference"] = maxDifference;
+
+	return report;
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::CompareSceneLoading(uint32_t nodeCount, uint32_t iterations)
+{
+	// the same four children per node hierarchy as CompareSceneGraph, every node draws the one mesh
+	nlohmann::json scene;
+	scene["meshes"] = { { { "name", "model" }, { "path", this->Settings.modelPath } } };
+	scene["nodes"] = nlohmann::json::array();
+
+	for (uint32_t node = 0; node < nodeCount; ++node)
+	{
+		nlohmann::json element = {
+			{ "name", "node " + std::to_string(node) },
+			{ "translation", { static_cast<float>(node % 4) - 1.5f, 0.0f, 1.0f } },
+			{ "scale", 0.9f },
+			{ "mesh", "model" }
+		};
+
+		if (node > 0)
+		{
+			element["parent"] = "node " + std::to_string((node - 1) / 4);
+		}
+
+		scene["nodes"].push_back(element);
+	}
+
+	const std::string sceneText = scene.dump();
+	const std::string compiledPath = (std::filesystem::temp_directory_path() / "benchmark_scene.scn").string();
+
+	{
+		std::vector<uint8_t> binary;
+		SceneCompiler::Compile(scene, binary);
+
+		std::ofstream compiledFile(compiledPath, std::ios::binary | std::ios::trunc);
+		compiledFile.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+
+		if (!compiledFile)
+		{
+			throw std::runtime_error("failed to write " + compiledPath);
+		}
+	}
+
+	std::vector<double> parseTimes;
+	std::vector<double> mapTimes;
+	std::vector<double> instantiateTimes;
+	uint32_t mappedNodeCount = 0;
+
+	for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		// parsing alone is a lower bound for any loader built on the authoring form
+		const auto parseStart = std::chrono::high_resolution_clock::now();
+		const nlohmann::json parsed = nlohmann::json::parse(sceneText);
+		const auto parseEnd = std::chrono::high_resolution_clock::now();
+
+		const auto mapStart = std::chrono::high_resolution_clock::now();
+		SceneFile sceneFile(compiledPath);
+		const auto mapEnd = std::chrono::high_resolution_clock::now();
+
+		SceneGraph sceneGraph;
+		const auto instantiateStart = std::chrono::high_resolution_clock::now();
+		sceneFile.AppendTo(sceneGraph);
+		sceneGraph.UpdateWorldTransforms();
+		const auto instantiateEnd = std::chrono::high_resolution_clock::now();
+
+		mappedNodeCount = sceneFile.GetNodeCount();
+
+		parseTimes.push_back(std::chrono::duration<double, std::milli>(parseEnd - parseStart).count());
+		mapTimes.push_back(std::chrono::duration<double, std::milli>(mapEnd - mapStart).count());
+		instantiateTimes.push_back(std::chrono::duration<double, std::milli>(instantiateEnd - instantiateStart).count());
+	}
+
+	std::error_code error;
+	const uint64_t compiledBytes = static_cast<uint64_t>(std::filesystem::file_size(compiledPath, error));
+	std::remove(compiledPath.c_str());
+
+	nlohmann::json report;
+	report["settings"] = {
+		{ "nodes", nodeCount },
+		{ "iterations", iterations }
+	};
+	report["json"] = {
+		{ "bytes", sceneText.size() },
+		{ "parseMs", Summarize(parseTimes) }
+	};
+	report["compiled"] = {
+		{ "bytes", compiledBytes },
+		{ "nodes", mappedNodeCount },
+		// open, map and validate, the nodes are usable in place from here on
+		{ "mapMs", Summarize(mapTimes) },
+		{ "sceneGraphMs", Summarize(instantiateTimes) }
+	};
+
+	return report;
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::CompareSimdKernels(uint32_t count, uint32_t iterations)
+{
+	if (count == 0)
+	{
+		throw std::invalid_argument("the SIMD benchmark needs at least one element!");
+	}
+
+	// random affine transforms, boxes and spheres around the origin, the same for every instruction set
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	const auto randomTransform = [&]()
+	{
+		const glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+
+		return glm::translate(glm::mat4(1.0f), glm::vec3(unit(random), unit(random), unit(random)) * 10.0f)
+			* glm::mat4_cast(glm::angleAxis(unit(random) * 3.14159265f, axis))
+			* glm::scale(glm::mat4(1.0f), glm::vec3(1.5f + unit(random), 1.5f + unit(random), 1.5f + unit(random)));
+	};
+
+	std::vector<glm::mat4> leftMatrices(count);
+	std::vector<glm::mat4> rightMatrices(count);
+	std::vector<glm::vec3> boxMinimums(count);
+	std::vector<glm::vec3> boxMaximums(count);
+	std::vector<glm::vec4> spheres(count);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		leftMatrices[i] = randomTransform();
+		rightMatrices[i] = randomTransform();
+
+		const glm::vec3 center(unit(random), unit(random), unit(random));
+		const glm::vec3 extent(unit(random) + 1.0f, unit(random) + 1.0f, unit(random) + 1.0f);
+		boxMinimums[i] = center - extent;
+		boxMaximums[i] = center + extent;
+
+		spheres[i] = glm::vec4(unit(random) * 100.0f, unit(random) * 100.0f, unit(random) * 100.0f, unit(random) * 5.0f + 5.0f);
+	}
+
+	// an axis aligned box around the origin keeps roughly half of the spheres
+	const float planes[6][4] = {
+		{ 1.0f, 0.0f, 0.0f, 50.0f }, { -1.0f, 0.0f, 0.0f, 50.0f },
+		{ 0.0f, 1.0f, 0.0f, 80.0f }, { 0.0f, -1.0f, 0.0f, 80.0f },
+		{ 0.0f, 0.0f, 1.0f, 90.0f }, { 0.0f, 0.0f, -1.0f, 90.0f }
+	};
+
+	// one object at a time through glm, the way the rest of the renderer does its math
+	std::vector<glm::mat4> glmProducts(count);
+	std::vector<glm::vec3> glmBoxMinimums(count);
+	std::vector<glm::vec3> glmBoxMaximums(count);
+	std::vector<uint8_t> glmVisible(count);
+	std::vector<double> glmMatrixTimes;
+	std::vector<double> glmBoxTimes;
+	std::vector<double> glmSphereTimes;
+
+	for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		const auto matrixStart = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			glmProducts[i] = leftMatrices[i] * rightMatrices[i];
+		}
+		const auto matrixEnd = std::chrono::high_resolution_clock::now();
+
+		const auto boxStart = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			glm::vec3 minimum(FLT_MAX);
+			glm::vec3 maximum(-FLT_MAX);
+
+			for (int corner = 0; corner < 8; ++corner)
+			{
+				const glm::vec4 point(
+					(corner & 1) ? boxMaximums[i].x : boxMinimums[i].x,
+					(corner & 2) ? boxMaximums[i].y : boxMinimums[i].y,
+					(corner & 4) ? boxMaximums[i].z : boxMinimums[i].z,
+					1.0f);
+				const glm::vec3 transformed(leftMatrices[i] * point);
+
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					minimum[axis] = std::min(minimum[axis], transformed[axis]);
+					maximum[axis] = std::max(maximum[axis], transformed[axis]);
+				}
+			}
+
+			glmBoxMinimums[i] = minimum;
+			glmBoxMaximums[i] = maximum;
+		}
+		const auto boxEnd = std::chrono::high_resolution_clock::now();
+
+		const auto sphereStart = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			bool inside = true;
+
+			for (int plane = 0; plane < 6; ++plane)
+			{
+				const glm::vec3 normal(planes[plane][0], planes[plane][1], planes[plane][2]);
+				inside = inside && glm::dot(normal, glm::vec3(spheres[i])) + planes[plane][3] >= -spheres[i].w;
+			}
+
+			glmVisible[i] = inside ? 1 : 0;
+		}
+		const auto sphereEnd = std::chrono::high_resolution_clock::now();
+
+		glmMatrixTimes.push_back(std::chrono::duration<double, std::milli>(matrixEnd - matrixStart).count());
+		glmBoxTimes.push_back(std::chrono::duration<double, std::milli>(boxEnd - boxStart).count());
+		glmSphereTimes.push_back(std::chrono::duration<double, std::milli>(sphereEnd - sphereStart).count());
+	}
+
+	// the same data as planes of count floats for the kernels
+	std::vector<float> leftPlanes(16 * static_cast<size_t>(count));
+	std::vector<float> rightPlanes(16 * static_cast<size_t>(count));
+	std::vector<float> boxPlanes(6 * static_cast<size_t>(count));
+	std::vector<float> spherePlanes(4 * static_cast<size_t>(count));
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		for (int element = 0; element < 16; ++element)
+		{
+			leftPlanes[element * count + i] = leftMatrices[i][element / 4][element % 4];
+			rightPlanes[element * count + i] = rightMatrices[i][element / 4][element % 4];
+		}
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			boxPlanes[axis * count + i] = boxMinimums[i][axis];
+			boxPlanes[(axis + 3) * count + i] = boxMaximums[i][axis];
+		}
+
+		for (int component = 0; component < 4; ++component)
+		{
+			spherePlanes[component * count + i] = spheres[i][component];
+		}
+	}
+
+	// elements per second of one thread from the median time
+	const auto getThroughput = [count](const std::vector<double>& times)
+	{
+		std::vector<double> sorted = times;
+		std::sort(sorted.begin(), sorted.end());
+		const double median = sorted.empty() ? 0.0 : Percentile(sorted, 50.0);
+
+		return median > 0.0 ? static_cast<double>(count) / (median / 1000.0) : 0.0;
+	};
+
+	nlohmann::json kernelReports;
+
+	for (const auto instructionSet : { SimdInstructionSet::Scalar, SimdInstructionSet::Sse2, SimdInstructionSet::Avx2 })
+	{
+		if (!SimdKernels::IsSupported(instructionSet))
+		{
+			continue;
+		}
+
+		const SimdKernelTable& kernels = SimdKernels::GetKernels(instructionSet);
+
+		std::vector<float> products(16 * static_cast<size_t>(count));
+		std::vector<float> transformedBoxes(6 * static_cast<size_t>(count));
+		std::vector<uint8_t> visible(count);
+		std::vector<double> matrixTimes;
+		std::vector<double> boxTimes;
+		std::vector<double> sphereTimes;
+		uint32_t visibleCount = 0;
+
+		for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+		{
+			const auto matrixStart = std::chrono::high_resolution_clock::now();
+			kernels.multiplyMatrices(leftPlanes.data(), rightPlanes.data(), products.data(), count);
+			const auto matrixEnd = std::chrono::high_resolution_clock::now();
+
+			const auto boxStart = std::chrono::high_resolution_clock::now();
+			kernels.transformBoxes(leftPlanes.data(), boxPlanes.data(), transformedBoxes.data(), count);
+			const auto boxEnd = std::chrono::high_resolution_clock::now();
+
+			const auto sphereStart = std::chrono::high_resolution_clock::now();
+			visibleCount = kernels.cullSpheres(planes, spherePlanes.data(), visible.data(), count);
+			const auto sphereEnd = std::chrono::high_resolution_clock::now();
+
+			matrixTimes.push_back(std::chrono::duration<double, std::milli>(matrixEnd - matrixStart).count());
+			boxTimes.push_back(std::chrono::duration<double, std::milli>(boxEnd - boxStart).count());
+			sphereTimes.push_back(std::chrono::duration<double, std::milli>(sphereEnd - sphereStart).count());
+		}
+
+		// every kernel against glm, fused multiply adds round differently so matrices and boxes are compared with a tolerance
+		float maxMatrixDifference = 0.0f;
+		float maxBoxDifference = 0.0f;
+		uint32_t sphereMismatches = 0;
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			for (int element = 0; element < 16; ++element)
+			{
+				maxMatrixDifference = std::max(maxMatrixDifference, std::abs(products[element * count + i] - glmProducts[i][element / 4][element % 4]));
+			}
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				maxBoxDifference = std::max(maxBoxDifference, std::abs(transformedBoxes[axis * count + i] - glmBoxMinimums[i][axis]));
+				maxBoxDifference = std::max(maxBoxDifference, std::abs(transformedBoxes[(axis + 3) * count + i] - glmBoxMaximums[i][axis]));
+			}
+
+			sphereMismatches += visible[i] != glmVisible[i] ? 1 : 0;
+		}
+
+		kernelReports[SimdKernels::GetName(instructionSet)] = {
+			{ "multiplyMatricesMs", Summarize(matrixTimes) },
+			{ "matricesPerSecond", getThroughput(matrixTimes) },
+			{ "maxMatrixDifference", maxMatrixDifference },
+			{ "transformBoxesMs", Summarize(boxTimes) },
+			{ "boxesPerSecond", getThroughput(boxTimes) },
+			{ "maxBoxDifference", maxBoxDifference },
+			{ "cullSpheresMs", Summarize(sphereTimes) },
+			{ "spheresPerSecond", getThroughput(sphereTimes) },
+			{ "visibleSpheres", visibleCount },
+			{ "sphereMismatches", sphereMismatches }
+		};
+	}
+
+	nlohmann::json report;
+	report["settings"] = {
+		{ "elements", count },
+		{ "iterations", iterations },
+		{ "selected", SimdKernels::GetName(SimdKernels::GetKernels().instructionSet) }
+	};
+	report["glm"] = {
+		{ "multiplyMatricesMs", Summarize(glmMatrixTimes) },
+		{ "matricesPerSecond", getThroughput(glmMatrixTimes) },
+		{ "transformBoxesMs", Summarize(glmBoxTimes) },
+		{ "boxesPerSecond", getThroughput(glmBoxTimes) },
+		{ "cullSpheresMs", Summarize(glmSphereTimes) },
+		{ "spheresPerSecond", getThroughput(glmSphereTimes) }
+	};
+	report["kernels"] = kernelReports;
+
+	return report;
+}
+
+nlohmann::json VulkanCore::BenchmarkHarness::CompareJobSystem(uint32_t jobCount, uint32_t iterations)
+{
+	if (jobCount == 0)
+	{
+		throw std::invalid_argument("the job system benchmark needs at least one job!");
+	}
+
+	JobSystem& jobs = JobSystem::GetShared();
+
+	// empty jobs, so the times are the cost of queueing, taking and finishing a job
+	std::vector<double> injectedTimes;
+	std::vector<double> spawnedTimes;
+	std::vector<double> continuationTimes;
+	const uint32_t chainLength = std::min<uint32_t>(jobCount, 4096);
+
+	for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		// queued from outside the system into the shared injection queue
+		const auto injectedStart = std::chrono::high_resolution_clock::now();
+		{
+			JobCounter counter;
+
+			for (uint32_t job = 0; job < jobCount; ++job)
+			{
+				jobs.Run("empty", []() {}, &counter);
+			}
+
+			jobs.Wait(counter);
+		}
+		const auto injectedEnd = std::chrono::high_resolution_clock::now();
+
+		// queued by a worker into its own deque, the other workers steal
+		const auto spawnedStart = std::chrono::high_resolution_clock::now();
+		{
+			JobCounter spawner;
+
+			jobs.Run("spawn", [&jobs, jobCount]() {
+				JobCounter counter;
+
+				for (uint32_t job = 0; job < jobCount; ++job)
+				{
+					jobs.Run("empty", []() {}, &counter);
+				}
+
+				jobs.Wait(counter);
+			}, &spawner);
+
+			jobs.Wait(spawner);
+		}
+		const auto spawnedEnd = std::chrono::high_resolution_clock::now();
+
+		// every job a continuation of the one before, nothing runs in parallel
+		const auto continuationStart = std::chrono::high_resolution_clock::now();
+		{
+			std::vector<JobCounter> counters(chainLength);
+			jobs.Run("empty", []() {}, &counters[0]);
+
+			for (uint32_t link = 1; link < chainLength; ++link)
+			{
+				jobs.RunAfter(counters[link - 1], "empty", []() {}, &counters[link]);
+			}
+
+			jobs.Wait(counters[chainLength - 1]);
+		}
+		const auto continuationEnd = std::chrono::high_resolution_clock::now();
+
+		injectedTimes.push_back(std::chrono::duration<double, std::nano>(injectedEnd - injectedStart).count() / jobCount);
+		spawnedTimes.push_back(std::chrono::duration<double, std::nano>(spawnedEnd - spawnedStart).count() / jobCount);
+		continuationTimes.push_back(std::chrono::duration<double, std::nano>(continuationEnd - continuationStart).count() / chainLength);
+	}
+
+	// a compute bound parallel for on growing worker counts, every element iterates a small map
+	const auto iterateElement = [](size_t element)
+	{
+		float value = static_cast<float>(element % 1024) / 1024.0f;
+
+		for (int step = 0; step < 256; ++step)
+		{
+			value = std::sqrt(value * value + 0.5f) * 0.7f;
+		}
+
+		return value;
+	};
+
+	std::vector<float> results(jobCount);
+	std::vector<uint32_t> workerCounts = { 0 };
+
+	for (uint32_t workerCount = 1; workerCount < JobSystem::GetDefaultWorkerCount(); workerCount *= 2)
+	{
+		workerCounts.push_back(workerCount);
+	}
+
+	if (JobSystem::GetDefaultWorkerCount() > 0)
+	{
+		workerCounts.push_back(JobSystem::GetDefaultWorkerCount());
+	}
+
+	nlohmann::json scaling = nlohmann::json::array();
+	double singleThreadMedian = 0.0;
+
+	for (const uint32_t workerCount : workerCounts)
+	{
+		JobSystem scalingJobs(workerCount);
+		std::vector<double> times;
+
+		for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			scalingJobs.ParallelFor("iterate", 0, jobCount, 64, [&](size_t begin, size_t end) {
+				for (size_t element = begin; element < end; ++element)
+				{
+					results[element] = iterateElement(element);
+				}
+			});
+			const auto end = std::chrono::high_resolution_clock::now();
+
+			times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		std::sort(times.begin(), times.end());
+		const double median = Percentile(times, 50.0);
+
+		if (workerCount == 0)
+		{
+			singleThreadMedian = median;
+		}
+
+		scaling.push_back({
+			{ "threads", workerCount + 1 },
+			{ "parallelForMs", Summarize(times) },
+			{ "speedup", median > 0.0 ? singleThreadMedian / median : 0.0 }
+		});
+	}
+
+	nlohmann::json report;
+	report["settings"] = {
+		{ "jobs", jobCount },
+		{ "iterations", iterations },
+		{ "workers", jobs.GetWorkerCount() }
+	};
+	report["scheduling"] = {
+		{ "injectedNsPerJob", Summarize(injectedTimes) },
+		{ "spawnedNsPerJob", Summarize(spawnedTimes) },
+		{ "continuationNsPerJob", Summarize(continuationTimes) }
+	};
+	report["scaling"] = scaling;
+
+	return report;
+}
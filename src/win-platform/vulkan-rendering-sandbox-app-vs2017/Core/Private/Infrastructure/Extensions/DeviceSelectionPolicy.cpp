@@ -0,0 +1,127 @@
+#include "../../../Public/Infrastructure/Extensions/DeviceSelectionPolicy.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+const char* DeviceSelectionPolicy::OVERRIDE_VARIABLE = "VK_RENDER_DEVICE";
+
+static std::string ToLower(std::string text)
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {
+		return static_cast<char>(std::tolower(c));
+	});
+
+	return text;
+}
+
+DeviceSelectionPolicy DeviceSelectionPolicy::FromEnvironment()
+{
+	DeviceSelectionPolicy policy;
+
+	const char* value = std::getenv(OVERRIDE_VARIABLE);
+
+	if (value == nullptr || *value == '\0')
+	{
+		return policy;
+	}
+
+	const std::string overrideValue(value);
+
+	if (std::all_of(overrideValue.begin(), overrideValue.end(), [](unsigned char c) { return std::isdigit(c) != 0; }))
+	{
+		policy.preferredDeviceIndex = std::atoi(value);
+	}
+	else
+	{
+		policy.preferredDeviceName = overrideValue;
+	}
+
+	return policy;
+}
+
+bool DeviceSelectionPolicy::HasOverride() const
+{
+	return this->preferredDeviceIndex >= 0 || !this->preferredDeviceName.empty();
+}
+
+bool DeviceSelectionPolicy::MatchesOverride(uint32_t deviceIndex, const VkPhysicalDeviceProperties& properties) const
+{
+	if (this->preferredDeviceIndex >= 0)
+	{
+		return static_cast<uint32_t>(this->preferredDeviceIndex) == deviceIndex;
+	}
+
+	return ToLower(properties.deviceName).find(ToLower(this->preferredDeviceName)) != std::string::npos;
+}
+
+// only capabilities the renderer benefits from are scored, required ones are checked by the engine
+int64_t DeviceSelectionPolicy::ScoreDevice(VkPhysicalDevice device)
+{
+	VkPhysicalDeviceProperties deviceProperties;
+	VkPhysicalDeviceFeatures deviceFeatures;
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceProperties(device, &deviceProperties);
+	vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+	vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+
+	int64_t score = 0;
+
+	switch (deviceProperties.deviceType)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+		score += 100000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+		score += 50000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+		score += 20000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_CPU:
+		score += 1000;
+		break;
+	default:
+		break;
+	}
+
+	// among devices of one type the largest local heap is the best hint for the faster part
+	VkDeviceSize deviceLocalBytes = 0;
+
+	for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i)
+	{
+		if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			deviceLocalBytes = std::max(deviceLocalBytes, memoryProperties.memoryHeaps[i].size);
+		}
+	}
+
+	score += static_cast<int64_t>(std::min<VkDeviceSize>(deviceLocalBytes / (64 * 1024 * 1024), 10000));
+
+	// texture quality
+	if (deviceFeatures.samplerAnisotropy)
+	{
+		score += 500;
+	}
+
+	score += deviceProperties.limits.maxImageDimension2D / 1024;
+
+	return score;
+}
+
+const char* DeviceSelectionPolicy::GetDeviceTypeName(VkPhysicalDeviceType deviceType)
+{
+	switch (deviceType)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+		return "discrete";
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+		return "integrated";
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+		return "virtual";
+	case VK_PHYSICAL_DEVICE_TYPE_CPU:
+		return "cpu";
+	default:
+		return "other";
+	}
+}
@@ -0,0 +1,353 @@
+#include "../../../Public/Infrastructure/Math/SimdKernels.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#ifdef SIMD_KERNELS_X86
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+const char* VulkanCore::SimdKernels::INSTRUCTION_SET_VARIABLE = "VK_RENDER_SIMD";
+
+void VulkanCore::SimdKernels::MultiplyMatrices(const float* left, const float* right, float* results, size_t count)
+{
+	GetKernels().multiplyMatrices(left, right, results, count);
+}
+
+void VulkanCore::SimdKernels::TransformBoxes(const float* matrices, const float* boxes, float* results, size_t count)
+{
+	GetKernels().transformBoxes(matrices, boxes, results, count);
+}
+
+uint32_t VulkanCore::SimdKernels::CullSpheres(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count)
+{
+	return GetKernels().cullSpheres(planes, spheres, visible, count);
+}
+
+const VulkanCore::SimdKernelTable& VulkanCore::SimdKernels::GetKernels()
+{
+	static const SimdKernelTable& kernels = []() -> const SimdKernelTable&
+	{
+		SimdInstructionSet instructionSet = DetectInstructionSet();
+		const char* value = std::getenv(INSTRUCTION_SET_VARIABLE);
+
+		if (value != nullptr)
+		{
+			for (const auto candidate : { SimdInstructionSet::Scalar, SimdInstructionSet::Sse2, SimdInstructionSet::Avx2 })
+			{
+				if (strcmp(value, GetName(candidate)) == 0 && IsSupported(candidate))
+				{
+					instructionSet = candidate;
+				}
+			}
+		}
+
+		return GetKernels(instructionSet);
+	}();
+
+	return kernels;
+}
+
+const VulkanCore::SimdKernelTable& VulkanCore::SimdKernels::GetKernels(SimdInstructionSet instructionSet)
+{
+	static const SimdKernelTable scalarKernels = {
+		SimdInstructionSet::Scalar,
+		[](const float* left, const float* right, float* results, size_t count) { MultiplyMatricesScalar(left, right, results, count, 0, count); },
+		[](const float* matrices, const float* boxes, float* results, size_t count) { TransformBoxesScalar(matrices, boxes, results, count, 0, count); },
+		[](const float planes[6][4], const float* spheres, uint8_t* visible, size_t count) { return CullSpheresScalar(planes, spheres, visible, count, 0, count); }
+	};
+
+#ifdef SIMD_KERNELS_X86
+	static const SimdKernelTable sse2Kernels = { SimdInstructionSet::Sse2, MultiplyMatricesSse2, TransformBoxesSse2, CullSpheresSse2 };
+	static const SimdKernelTable avx2Kernels = { SimdInstructionSet::Avx2, MultiplyMatricesAvx2, TransformBoxesAvx2, CullSpheresAvx2 };
+
+	switch (instructionSet)
+	{
+	case SimdInstructionSet::Avx2:
+		return avx2Kernels;
+	case SimdInstructionSet::Sse2:
+		return sse2Kernels;
+	default:
+		return scalarKernels;
+	}
+#else
+	(void)instructionSet;
+	return scalarKernels;
+#endif
+}
+
+bool VulkanCore::SimdKernels::IsSupported(SimdInstructionSet instructionSet)
+{
+	static const SimdInstructionSet detected = DetectInstructionSet();
+
+	return static_cast<int>(instructionSet) <= static_cast<int>(detected);
+}
+
+const char* VulkanCore::SimdKernels::GetName(SimdInstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+	case SimdInstructionSet::Avx2:
+		return "avx2";
+	case SimdInstructionSet::Sse2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
+
+VulkanCore::SimdInstructionSet VulkanCore::SimdKernels::DetectInstructionSet()
+{
+#ifdef SIMD_KERNELS_X86
+	unsigned int registers[4] = {};
+
+#ifdef _MSC_VER
+	const auto cpuid = [&](unsigned int leaf)
+	{
+		int values[4];
+		__cpuidex(values, static_cast<int>(leaf), 0);
+		memcpy(registers, values, sizeof(registers));
+	};
+#else
+	const auto cpuid = [&](unsigned int leaf)
+	{
+		__cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+	};
+#endif
+
+	cpuid(0);
+	const unsigned int maximumLeaf = registers[0];
+
+	cpuid(1);
+	const bool sse2 = (registers[3] & (1u << 26)) != 0;
+	const bool fma = (registers[2] & (1u << 12)) != 0;
+	const bool osxsave = (registers[2] & (1u << 27)) != 0;
+
+	if (!sse2)
+	{
+		return SimdInstructionSet::Scalar;
+	}
+
+	// the CPU supporting AVX2 is not enough, the OS also has to save the upper halves of the YMM registers
+	bool avx2 = false;
+
+	if (fma && osxsave && maximumLeaf >= 7)
+	{
+#ifdef _MSC_VER
+		const unsigned long long enabledState = _xgetbv(0);
+#else
+		unsigned int enabledLow;
+		unsigned int enabledHigh;
+		__asm__("xgetbv" : "=a"(enabledLow), "=d"(enabledHigh) : "c"(0));
+		const unsigned long long enabledState = enabledLow | (static_cast<unsigned long long>(enabledHigh) << 32);
+#endif
+
+		cpuid(7);
+		avx2 = (enabledState & 0x6) == 0x6 && (registers[1] & (1u << 5)) != 0;
+	}
+
+	return avx2 ? SimdInstructionSet::Avx2 : SimdInstructionSet::Sse2;
+#else
+	return SimdInstructionSet::Scalar;
+#endif
+}
+
+void VulkanCore::SimdKernels::MultiplyMatricesScalar(const float* left, const float* right, float* results, size_t count, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				float sum = 0.0f;
+
+				for (int k = 0; k < 4; k++)
+				{
+					sum += left[(k * 4 + row) * count + i] * right[(column * 4 + k) * count + i];
+				}
+
+				results[(column * 4 + row) * count + i] = sum;
+			}
+		}
+	}
+}
+
+void VulkanCore::SimdKernels::TransformBoxesScalar(const float* matrices, const float* boxes, float* results, size_t count, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		float center[3];
+		float extent[3];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center[axis] = (boxes[axis * count + i] + boxes[(axis + 3) * count + i]) * 0.5f;
+			extent[axis] = (boxes[(axis + 3) * count + i] - boxes[axis * count + i]) * 0.5f;
+		}
+
+		// the transformed center plus the extent projected onto every world axis
+		for (int row = 0; row < 3; row++)
+		{
+			float transformedCenter = matrices[(12 + row) * count + i];
+			float transformedExtent = 0.0f;
+
+			for (int column = 0; column < 3; column++)
+			{
+				const float element = matrices[(column * 4 + row) * count + i];
+				transformedCenter += element * center[column];
+				transformedExtent += std::abs(element) * extent[column];
+			}
+
+			results[row * count + i] = transformedCenter - transformedExtent;
+			results[(row + 3) * count + i] = transformedCenter + transformedExtent;
+		}
+	}
+}
+
+uint32_t VulkanCore::SimdKernels::CullSpheresScalar(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count, size_t begin, size_t end)
+{
+	uint32_t visibleCount = 0;
+
+	for (size_t i = begin; i < end; i++)
+	{
+		bool inside = true;
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			const float distance =
+				planes[plane][0] * spheres[i] +
+				planes[plane][1] * spheres[count + i] +
+				planes[plane][2] * spheres[2 * count + i] +
+				planes[plane][3];
+
+			inside = inside && distance >= -spheres[3 * count + i];
+		}
+
+		visible[i] = inside ? 1 : 0;
+		visibleCount += inside ? 1 : 0;
+	}
+
+	return visibleCount;
+}
+
+#ifdef SIMD_KERNELS_X86
+
+void VulkanCore::SimdKernels::MultiplyMatricesSse2(const float* left, const float* right, float* results, size_t count)
+{
+	const size_t vectorEnd = count - count % 4;
+
+	// four products at once, one per lane, so no shuffles are needed
+	for (size_t i = 0; i < vectorEnd; i += 4)
+	{
+		__m128 a[16];
+
+		for (int element = 0; element < 16; element++)
+		{
+			a[element] = _mm_loadu_ps(left + element * count + i);
+		}
+
+		for (int column = 0; column < 4; column++)
+		{
+			const __m128 b0 = _mm_loadu_ps(right + (column * 4 + 0) * count + i);
+			const __m128 b1 = _mm_loadu_ps(right + (column * 4 + 1) * count + i);
+			const __m128 b2 = _mm_loadu_ps(right + (column * 4 + 2) * count + i);
+			const __m128 b3 = _mm_loadu_ps(right + (column * 4 + 3) * count + i);
+
+			for (int row = 0; row < 4; row++)
+			{
+				const __m128 sum = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(a[row], b0), _mm_mul_ps(a[4 + row], b1)),
+					_mm_add_ps(_mm_mul_ps(a[8 + row], b2), _mm_mul_ps(a[12 + row], b3)));
+
+				_mm_storeu_ps(results + (column * 4 + row) * count + i, sum);
+			}
+		}
+	}
+
+	MultiplyMatricesScalar(left, right, results, count, vectorEnd, count);
+}
+
+void VulkanCore::SimdKernels::TransformBoxesSse2(const float* matrices, const float* boxes, float* results, size_t count)
+{
+	const size_t vectorEnd = count - count % 4;
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	for (size_t i = 0; i < vectorEnd; i += 4)
+	{
+		__m128 center[3];
+		__m128 extent[3];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const __m128 minimum = _mm_loadu_ps(boxes + axis * count + i);
+			const __m128 maximum = _mm_loadu_ps(boxes + (axis + 3) * count + i);
+			center[axis] = _mm_mul_ps(_mm_add_ps(minimum, maximum), half);
+			extent[axis] = _mm_mul_ps(_mm_sub_ps(maximum, minimum), half);
+		}
+
+		for (int row = 0; row < 3; row++)
+		{
+			__m128 transformedCenter = _mm_loadu_ps(matrices + (12 + row) * count + i);
+			__m128 transformedExtent = _mm_setzero_ps();
+
+			for (int column = 0; column < 3; column++)
+			{
+				const __m128 element = _mm_loadu_ps(matrices + (column * 4 + row) * count + i);
+				transformedCenter = _mm_add_ps(transformedCenter, _mm_mul_ps(element, center[column]));
+				transformedExtent = _mm_add_ps(transformedExtent, _mm_mul_ps(_mm_andnot_ps(signMask, element), extent[column]));
+			}
+
+			_mm_storeu_ps(results + row * count + i, _mm_sub_ps(transformedCenter, transformedExtent));
+			_mm_storeu_ps(results + (row + 3) * count + i, _mm_add_ps(transformedCenter, transformedExtent));
+		}
+	}
+
+	TransformBoxesScalar(matrices, boxes, results, count, vectorEnd, count);
+}
+
+uint32_t VulkanCore::SimdKernels::CullSpheresSse2(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count)
+{
+	const size_t vectorEnd = count - count % 4;
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	uint32_t visibleCount = 0;
+
+	for (size_t i = 0; i < vectorEnd; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(spheres + i);
+		const __m128 y = _mm_loadu_ps(spheres + count + i);
+		const __m128 z = _mm_loadu_ps(spheres + 2 * count + i);
+		const __m128 negativeRadius = _mm_xor_ps(_mm_loadu_ps(spheres + 3 * count + i), signMask);
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			const __m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[plane][0]), x), _mm_mul_ps(_mm_set1_ps(planes[plane][1]), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[plane][2]), z), _mm_set1_ps(planes[plane][3])));
+
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		const int mask = _mm_movemask_ps(inside);
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+
+	return visibleCount + CullSpheresScalar(planes, spheres, visible, count, vectorEnd, count);
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "../../../Public/Infrastructure/Math/SimdKernels.hpp"
+
+#ifdef SIMD_KERNELS_X86
+
+#include <immintrin.h>
+
+// the project builds this file alone with AVX2 code generation, nothing here may run before detection
+
+void VulkanCore::SimdKernels::MultiplyMatricesAvx2(const float* left, const float* right, float* results, size_t count)
+{
+	const size_t vectorEnd = count - count % 8;
+
+	for (size_t i = 0; i < vectorEnd; i += 8)
+	{
+		__m256 a[16];
+
+		for (int element = 0; element < 16; element++)
+		{
+			a[element] = _mm256_loadu_ps(left + element * count + i);
+		}
+
+		for (int column = 0; column < 4; column++)
+		{
+			const __m256 b0 = _mm256_loadu_ps(right + (column * 4 + 0) * count + i);
+			const __m256 b1 = _mm256_loadu_ps(right + (column * 4 + 1) * count + i);
+			const __m256 b2 = _mm256_loadu_ps(right + (column * 4 + 2) * count + i);
+			const __m256 b3 = _mm256_loadu_ps(right + (column * 4 + 3) * count + i);
+
+			for (int row = 0; row < 4; row++)
+			{
+				__m256 sum = _mm256_mul_ps(a[row], b0);
+				sum = _mm256_fmadd_ps(a[4 + row], b1, sum);
+				sum = _mm256_fmadd_ps(a[8 + row], b2, sum);
+				sum = _mm256_fmadd_ps(a[12 + row], b3, sum);
+
+				_mm256_storeu_ps(results + (column * 4 + row) * count + i, sum);
+			}
+		}
+	}
+
+	MultiplyMatricesScalar(left, right, results, count, vectorEnd, count);
+}
+
+void VulkanCore::SimdKernels::TransformBoxesAvx2(const float* matrices, const float* boxes, float* results, size_t count)
+{
+	const size_t vectorEnd = count - count % 8;
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+	for (size_t i = 0; i < vectorEnd; i += 8)
+	{
+		__m256 center[3];
+		__m256 extent[3];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const __m256 minimum = _mm256_loadu_ps(boxes + axis * count + i);
+			const __m256 maximum = _mm256_loadu_ps(boxes + (axis + 3) * count + i);
+			center[axis] = _mm256_mul_ps(_mm256_add_ps(minimum, maximum), half);
+			extent[axis] = _mm256_mul_ps(_mm256_sub_ps(maximum, minimum), half);
+		}
+
+		for (int row = 0; row < 3; row++)
+		{
+			__m256 transformedCenter = _mm256_loadu_ps(matrices + (12 + row) * count + i);
+			__m256 transformedExtent = _mm256_setzero_ps();
+
+			for (int column = 0; column < 3; column++)
+			{
+				const __m256 element = _mm256_loadu_ps(matrices + (column * 4 + row) * count + i);
+				transformedCenter = _mm256_fmadd_ps(element, center[column], transformedCenter);
+				transformedExtent = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, element), extent[column], transformedExtent);
+			}
+
+			_mm256_storeu_ps(results + row * count + i, _mm256_sub_ps(transformedCenter, transformedExtent));
+			_mm256_storeu_ps(results + (row + 3) * count + i, _mm256_add_ps(transformedCenter, transformedExtent));
+		}
+	}
+
+	TransformBoxesScalar(matrices, boxes, results, count, vectorEnd, count);
+}
+
+uint32_t VulkanCore::SimdKernels::CullSpheresAvx2(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count)
+{
+	const size_t vectorEnd = count - count % 8;
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	uint32_t visibleCount = 0;
+
+	for (size_t i = 0; i < vectorEnd; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(spheres + i);
+		const __m256 y = _mm256_loadu_ps(spheres + count + i);
+		const __m256 z = _mm256_loadu_ps(spheres + 2 * count + i);
+		const __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(spheres + 3 * count + i), signMask);
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			__m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[plane][0]), x, _mm256_set1_ps(planes[plane][3]));
+			distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[plane][1]), y, distance);
+			distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[plane][2]), z, distance);
+
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+
+		const int mask = _mm256_movemask_ps(inside);
+
+		for (int lane = 0; lane < 8; lane++)
+		{
+			visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+
+	return visibleCount + CullSpheresScalar(planes, spheres, visible, count, vectorEnd, count);
+}
+
+#endif
@@ -0,0 +1,298 @@
+#include "../../../Public/Infrastructure/Meshes/CookedMesh.hpp"
+#include "../../../Public/Infrastructure/Meshes/GltfModel.hpp"
+#include "../../../Public/Infrastructure/Meshes/MeshSimplifier.hpp"
+#include "../../../Public/Utils/IOUtils.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+static const uint32_t NO_VERTEX = 0xFFFFFFFF;
+
+void VulkanCore::MeshCooker::Cook(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, CookedMesh& mesh)
+{
+	mesh = CookedMesh();
+
+	if (indices.empty())
+	{
+		return;
+	}
+
+	float minimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	for (const auto index : indices)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			minimum[axis] = std::min(minimum[axis], vertices[index].position[axis]);
+			maximum[axis] = std::max(maximum[axis], vertices[index].position[axis]);
+		}
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		mesh.boundsCenter[axis] = (minimum[axis] + maximum[axis]) * 0.5f;
+	}
+
+	for (const auto index : indices)
+	{
+		const glm::vec3 offset = vertices[index].position - glm::vec3(mesh.boundsCenter[0], mesh.boundsCenter[1], mesh.boundsCenter[2]);
+		mesh.boundsRadius = std::max(mesh.boundsRadius, glm::length(offset));
+	}
+
+	const float diameter = std::max(mesh.boundsRadius * 2.0f, FLT_MIN);
+
+	std::vector<std::vector<uint32_t>> levels = { indices };
+	std::vector<float> errors = { 0.0f };
+
+	// every level is simplified from the source mesh to half the triangles of the one before it
+	while (levels.size() < MAX_LODS && levels.back().size() / 3 > MIN_LOD_TRIANGLES)
+	{
+		const size_t previousCount = levels.back().size();
+		const size_t targetCount = std::max<size_t>(previousCount / 6, MIN_LOD_TRIANGLES) * 3;
+
+		std::vector<uint32_t> level;
+		const float error = MeshSimplifier::Simplify(
+			indices,
+			&vertices[0].position.x,
+			vertices.size(),
+			sizeof(Vertex),
+			targetCount,
+			FLT_MAX,
+			level);
+
+		// seams and borders are kept intact, on heavily seamed meshes there is little left to collapse
+		if (level.size() > previousCount * 3 / 4)
+		{
+			break;
+		}
+
+		levels.push_back(std::move(level));
+		errors.push_back(error / diameter);
+	}
+
+	// vertices are ordered by first use starting from the coarsest level, so coarse levels fetch from
+	// a compact range at the front of the buffer; vertices no level references are dropped
+	std::vector<uint32_t> remap(vertices.size(), NO_VERTEX);
+
+	for (size_t level = levels.size(); level-- > 0;)
+	{
+		for (const auto index : levels[level])
+		{
+			if (remap[index] == NO_VERTEX)
+			{
+				remap[index] = static_cast<uint32_t>(mesh.vertices.size());
+				mesh.vertices.push_back(vertices[index]);
+			}
+		}
+	}
+
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		MeshLod lod;
+		lod.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+		lod.indexCount = static_cast<uint32_t>(levels[level].size());
+		lod.error = errors[level];
+		mesh.lods.push_back(lod);
+
+		for (const auto index : levels[level])
+		{
+			mesh.indices.push_back(remap[index]);
+		}
+	}
+
+	for (size_t level = 0; level < mesh.lods.size(); level++)
+	{
+		MeshLod& lod = mesh.lods[level];
+		lod.firstMeshlet = static_cast<uint32_t>(mesh.meshlets.size());
+
+		MeshletBuilder::Build(mesh.vertices, mesh.indices, lod.firstIndex, lod.indexCount, mesh.meshlets);
+
+		lod.meshletCount = static_cast<uint32_t>(mesh.meshlets.size()) - lod.firstMeshlet;
+
+		std::string error;
+		if (!MeshletBuilder::Validate(mesh.vertices, mesh.indices, lod.firstIndex, lod.indexCount, mesh.meshlets, lod.firstMeshlet, lod.meshletCount, error))
+		{
+			throw std::runtime_error("invalid meshlets in level " + std::to_string(level) + ": " + error);
+		}
+	}
+}
+
+void VulkanCore::MeshCooker::LoadOrCook(const std::string& modelPath, CookedMesh& mesh)
+{
+	const std::string cookedPath = GetCookedPath(modelPath);
+
+	if (Load(cookedPath, modelPath, mesh))
+	{
+		return;
+	}
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+
+	// glTF node transforms are baked into the one mesh, only the .gltf file itself is stamped so
+	// an edited external .bin needs the cooked file removed
+	if (GltfModel::IsGltfPath(modelPath))
+	{
+		GltfModel(modelPath).Flatten(vertices, indices);
+	}
+	else
+	{
+		MeshExtensions::LoadModel(modelPath.c_str(), vertices, indices);
+	}
+
+	Cook(vertices, indices, mesh);
+
+	// the cooked mesh is still usable, it is just rebuilt on the next run
+	if (!Save(cookedPath, modelPath, mesh))
+	{
+		std::cerr << "failed to write cooked mesh " << cookedPath << std::endl;
+	}
+}
+
+bool VulkanCore::MeshCooker::Load(const std::string& cookedPath, const std::string& sourcePath, CookedMesh& mesh)
+{
+	std::ifstream cookedFile(cookedPath, std::ios::binary);
+
+	if (!cookedFile.is_open())
+	{
+		return false;
+	}
+
+	FileHeader header = {};
+	cookedFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	uint64_t sourceSize;
+	int64_t sourceWriteTime;
+
+	if (!cookedFile ||
+		header.magic != FILE_MAGIC ||
+		header.version != FILE_VERSION ||
+		header.vertexSize != sizeof(Vertex) ||
+		!GetSourceStamp(sourcePath, sourceSize, sourceWriteTime) ||
+		header.sourceSize != sourceSize ||
+		header.sourceWriteTime != sourceWriteTime)
+	{
+		return false;
+	}
+
+	CookedMesh loaded;
+	loaded.lods.resize(header.lodCount);
+	loaded.meshlets.resize(header.meshletCount);
+	loaded.vertices.resize(header.vertexCount);
+	loaded.indices.resize(header.indexCount);
+	std::copy(header.boundsCenter, header.boundsCenter + 3, loaded.boundsCenter);
+	loaded.boundsRadius = header.boundsRadius;
+
+	cookedFile.read(reinterpret_cast<char*>(loaded.lods.data()), loaded.lods.size() * sizeof(MeshLod));
+	cookedFile.read(reinterpret_cast<char*>(loaded.meshlets.data()), loaded.meshlets.size() * sizeof(Meshlet));
+	cookedFile.read(reinterpret_cast<char*>(loaded.vertices.data()), loaded.vertices.size() * sizeof(Vertex));
+	cookedFile.read(reinterpret_cast<char*>(loaded.indices.data()), loaded.indices.size() * sizeof(uint32_t));
+
+	if (!cookedFile || loaded.lods.empty())
+	{
+		return false;
+	}
+
+	for (const auto& lod : loaded.lods)
+	{
+		if (static_cast<uint64_t>(lod.firstIndex) + lod.indexCount > loaded.indices.size() ||
+			static_cast<uint64_t>(lod.firstMeshlet) + lod.meshletCount > loaded.meshlets.size())
+		{
+			return false;
+		}
+	}
+
+	for (const auto& meshlet : loaded.meshlets)
+	{
+		if (static_cast<uint64_t>(meshlet.firstIndex) + meshlet.triangleCount * 3 > loaded.indices.size())
+		{
+			return false;
+		}
+	}
+
+	mesh = std::move(loaded);
+	return true;
+}
+
+bool VulkanCore::MeshCooker::Save(const std::string& cookedPath, const std::string& sourcePath, const CookedMesh& mesh)
+{
+	FileHeader header = {};
+	header.magic = FILE_MAGIC;
+	header.version = FILE_VERSION;
+	header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+	header.lodCount = static_cast<uint32_t>(mesh.lods.size());
+	header.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+	header.vertexSize = sizeof(Vertex);
+	std::copy(mesh.boundsCenter, mesh.boundsCenter + 3, header.boundsCenter);
+	header.boundsRadius = mesh.boundsRadius;
+
+	if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceWriteTime))
+	{
+		return false;
+	}
+
+	// written next to the destination first, a reader never sees a partial file
+	const std::string temporaryPath = cookedPath + ".new";
+
+	{
+		std::ofstream cookedFile(temporaryPath, std::ios::binary | std::ios::trunc);
+
+		if (!cookedFile.is_open())
+		{
+			return false;
+		}
+
+		cookedFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		cookedFile.write(reinterpret_cast<const char*>(mesh.lods.data()), mesh.lods.size() * sizeof(MeshLod));
+		cookedFile.write(reinterpret_cast<const char*>(mesh.meshlets.data()), mesh.meshlets.size() * sizeof(Meshlet));
+		cookedFile.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+		cookedFile.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+
+		if (!cookedFile)
+		{
+			cookedFile.close();
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, cookedPath, error);
+
+	if (error)
+	{
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+std::string VulkanCore::MeshCooker::GetCookedPath(const std::string& modelPath)
+{
+	return modelPath + ".lod";
+}
+
+bool VulkanCore::MeshCooker::GetSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& writeTime)
+{
+	std::error_code error;
+
+	size = static_cast<uint64_t>(std::filesystem::file_size(sourcePath, error));
+
+	if (error)
+	{
+		return false;
+	}
+
+	writeTime = static_cast<int64_t>(std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count());
+
+	return !error;
+}
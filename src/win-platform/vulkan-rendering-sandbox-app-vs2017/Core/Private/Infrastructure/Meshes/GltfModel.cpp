@@ -0,0 +1,608 @@
+#include "../../../Public/Infrastructure/Meshes/GltfModel.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+// the image decoder and writer come from stb in main.cpp and JSON from the single_include header the scene compiler uses,
+// textures are decoded by the texture streamer so tinygltf only records where they live
+#define TINYGLTF_IMPLEMENTATION
+#define TINYGLTF_NO_STB_IMAGE
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#define TINYGLTF_NO_EXTERNAL_IMAGE
+#define TINYGLTF_NO_INCLUDE_JSON
+#include <nlohmann/json.hpp>
+#include <tiny_gltf.h>
+
+namespace
+{
+	bool SkipImageData(tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*)
+	{
+		return true;
+	}
+
+	size_t GetComponentSize(uint32_t componentType)
+	{
+		switch (componentType)
+		{
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			return 1;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+			return 2;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	// the accessor as a strided range of its buffer, checked against the buffer size so later reads need no checks
+	VulkanCore::GltfStream GetStream(
+		const tinygltf::Model& model,
+		int accessorIndex,
+		const std::vector<uint32_t>& componentTypes,
+		const std::vector<int>& types,
+		bool requireNormalized,
+		size_t& count,
+		const std::string& name)
+	{
+		if (accessorIndex < 0 || static_cast<size_t>(accessorIndex) >= model.accessors.size())
+		{
+			throw std::runtime_error(name + " has no valid accessor");
+		}
+
+		const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+
+		if (accessor.sparse.isSparse || accessor.bufferView < 0 || static_cast<size_t>(accessor.bufferView) >= model.bufferViews.size())
+		{
+			throw std::runtime_error(name + " is sparse or has no buffer view");
+		}
+
+		if (std::find(types.begin(), types.end(), accessor.type) == types.end() ||
+			std::find(componentTypes.begin(), componentTypes.end(), static_cast<uint32_t>(accessor.componentType)) == componentTypes.end() ||
+			(requireNormalized && accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT && !accessor.normalized))
+		{
+			throw std::runtime_error(name + " has an unsupported layout");
+		}
+
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+		const int stride = accessor.ByteStride(view);
+
+		if (stride <= 0 || view.buffer < 0 || static_cast<size_t>(view.buffer) >= model.buffers.size())
+		{
+			throw std::runtime_error(name + " has an invalid buffer view");
+		}
+
+		VulkanCore::GltfStream stream;
+		stream.buffer = static_cast<uint32_t>(view.buffer);
+		stream.offset = view.byteOffset + accessor.byteOffset;
+		stream.stride = static_cast<uint32_t>(stride);
+		stream.componentType = static_cast<uint32_t>(accessor.componentType);
+		stream.componentCount = static_cast<uint32_t>(tinygltf::GetNumComponentsInType(accessor.type));
+		stream.normalized = accessor.normalized;
+
+		const size_t elementSize = GetComponentSize(stream.componentType) * stream.componentCount;
+		const size_t bufferSize = model.buffers[view.buffer].data.size();
+
+		if (accessor.count > 0 &&
+			(stream.offset > bufferSize || (accessor.count - 1) * stream.stride + elementSize > bufferSize - stream.offset))
+		{
+			throw std::runtime_error(name + " reads past the end of its buffer");
+		}
+
+		count = accessor.count;
+		return stream;
+	}
+
+	float ReadComponent(const uint8_t* data, uint32_t componentType)
+	{
+		switch (componentType)
+		{
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			return data[0] / 255.0f;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		{
+			uint16_t value;
+			memcpy(&value, data, sizeof(value));
+			return value / 65535.0f;
+		}
+		default:
+		{
+			float value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+		}
+	}
+
+	uint32_t ReadIndex(const uint8_t* data, uint32_t componentType)
+	{
+		switch (componentType)
+		{
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			return data[0];
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		{
+			uint16_t value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+		default:
+		{
+			uint32_t value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+		}
+	}
+
+	bool AreIndicesInRange(const std::vector<std::vector<uint8_t>>& buffers, const VulkanCore::GltfPrimitive& primitive)
+	{
+		const uint8_t* data = buffers[primitive.indices.buffer].data() + primitive.indices.offset;
+
+		for (uint32_t index = 0; index < primitive.indexCount; index++)
+		{
+			if (ReadIndex(data + static_cast<size_t>(index) * primitive.indices.stride, primitive.indices.componentType) >= primitive.vertexCount)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void ReadVector(const std::vector<std::vector<uint8_t>>& buffers, const VulkanCore::GltfStream& stream, uint32_t element, float* values)
+	{
+		const uint8_t* data = buffers[stream.buffer].data() + stream.offset + static_cast<size_t>(element) * stream.stride;
+		const size_t componentSize = GetComponentSize(stream.componentType);
+
+		for (uint32_t component = 0; component < stream.componentCount; component++)
+		{
+			values[component] = ReadComponent(data + component * componentSize, stream.componentType);
+		}
+	}
+
+	Vertex ReadVertex(const std::vector<std::vector<uint8_t>>& buffers, const VulkanCore::GltfPrimitive& primitive, uint32_t vertex)
+	{
+		float position[3];
+		float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float textureCoords[2] = { 0.0f, 0.0f };
+
+		ReadVector(buffers, primitive.position, vertex, position);
+
+		if (primitive.color.componentType != 0)
+		{
+			ReadVector(buffers, primitive.color, vertex, color);
+		}
+
+		if (primitive.textureCoords.componentType != 0)
+		{
+			ReadVector(buffers, primitive.textureCoords, vertex, textureCoords);
+		}
+
+		// glTF already puts the texture origin at the top left, unlike OBJ
+		Vertex result;
+		result.position = glm::vec3(position[0], position[1], position[2]);
+		result.color = glm::vec3(color[0], color[1], color[2]);
+		result.textureCoords = glm::vec2(textureCoords[0], textureCoords[1]);
+
+		return result;
+	}
+}
+
+VulkanCore::GltfModel::GltfModel(const std::string& path)
+{
+	tinygltf::TinyGLTF loader;
+	loader.SetImageLoader(SkipImageData, nullptr);
+
+	tinygltf::Model model;
+	std::string error;
+	std::string warning;
+
+	const bool binary = std::filesystem::path(path).extension() == ".glb";
+	const bool loaded = binary ?
+		loader.LoadBinaryFromFile(&model, &error, &warning, path) :
+		loader.LoadASCIIFromFile(&model, &error, &warning, path);
+
+	if (!loaded)
+	{
+		throw std::runtime_error("failed to load " + path + ": " + error);
+	}
+
+	const std::string directory = std::filesystem::path(path).parent_path().string();
+
+	for (const auto& source : model.materials)
+	{
+		GltfMaterial material;
+		material.name = source.name;
+
+		const std::vector<double>& factor = source.pbrMetallicRoughness.baseColorFactor;
+
+		for (size_t component = 0; component < std::min<size_t>(factor.size(), 4); component++)
+		{
+			material.baseColorFactor[component] = static_cast<float>(factor[component]);
+		}
+
+		const int texture = source.pbrMetallicRoughness.baseColorTexture.index;
+
+		// embedded images have no path of their own, those materials are left untextured
+		if (texture >= 0 && static_cast<size_t>(texture) < model.textures.size())
+		{
+			const int image = model.textures[texture].source;
+
+			if (image >= 0 && static_cast<size_t>(image) < model.images.size() && !model.images[image].uri.empty() &&
+				model.images[image].uri.compare(0, 5, "data:") != 0)
+			{
+				material.baseColorTexturePath = directory.empty() ?
+					model.images[image].uri :
+					(std::filesystem::path(directory) / model.images[image].uri).string();
+			}
+		}
+
+		this->Materials.push_back(material);
+	}
+
+	// primitives without a material get the glTF default one at the end
+	const uint32_t defaultMaterial = static_cast<uint32_t>(this->Materials.size());
+	bool usesDefaultMaterial = false;
+
+	const std::vector<uint32_t> floatTypes = { TINYGLTF_COMPONENT_TYPE_FLOAT };
+	const std::vector<uint32_t> normalizedTypes = {
+		TINYGLTF_COMPONENT_TYPE_FLOAT,
+		TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
+		TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT };
+	const std::vector<uint32_t> indexTypes = {
+		TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
+		TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+		TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT };
+
+	uint64_t vertexCount = 0;
+	uint64_t indexCount = 0;
+
+	for (const auto& source : model.meshes)
+	{
+		GltfMesh mesh;
+		mesh.name = source.name;
+		mesh.firstPrimitive = static_cast<uint32_t>(this->Primitives.size());
+
+		for (size_t i = 0; i < source.primitives.size(); i++)
+		{
+			const tinygltf::Primitive& sourcePrimitive = source.primitives[i];
+			const std::string name = "primitive " + std::to_string(i) + " of mesh " + std::to_string(this->Meshes.size());
+
+			// points and lines have nothing to draw in a triangle list pipeline
+			if (sourcePrimitive.mode != TINYGLTF_MODE_TRIANGLES)
+			{
+				continue;
+			}
+
+			const auto position = sourcePrimitive.attributes.find("POSITION");
+
+			if (position == sourcePrimitive.attributes.end())
+			{
+				throw std::runtime_error(name + " has no positions");
+			}
+
+			GltfPrimitive primitive;
+			size_t count = 0;
+
+			primitive.position = GetStream(model, position->second, floatTypes, { TINYGLTF_TYPE_VEC3 }, false, count, name + " POSITION");
+			primitive.vertexCount = static_cast<uint32_t>(count);
+
+			const auto color = sourcePrimitive.attributes.find("COLOR_0");
+
+			if (color != sourcePrimitive.attributes.end())
+			{
+				primitive.color = GetStream(model, color->second, normalizedTypes, { TINYGLTF_TYPE_VEC3, TINYGLTF_TYPE_VEC4 }, true, count, name + " COLOR_0");
+
+				if (count != primitive.vertexCount)
+				{
+					throw std::runtime_error(name + " COLOR_0 does not match the vertex count");
+				}
+			}
+
+			const auto textureCoords = sourcePrimitive.attributes.find("TEXCOORD_0");
+
+			if (textureCoords != sourcePrimitive.attributes.end())
+			{
+				primitive.textureCoords = GetStream(model, textureCoords->second, normalizedTypes, { TINYGLTF_TYPE_VEC2 }, true, count, name + " TEXCOORD_0");
+
+				if (count != primitive.vertexCount)
+				{
+					throw std::runtime_error(name + " TEXCOORD_0 does not match the vertex count");
+				}
+			}
+
+			if (sourcePrimitive.indices >= 0)
+			{
+				primitive.indices = GetStream(model, sourcePrimitive.indices, indexTypes, { TINYGLTF_TYPE_SCALAR }, false, count, name + " indices");
+				primitive.indexCount = static_cast<uint32_t>(count);
+			}
+			else
+			{
+				primitive.indexCount = primitive.vertexCount;
+			}
+
+			if (primitive.indexCount % 3 != 0)
+			{
+				throw std::runtime_error(name + " is not a triangle list");
+			}
+
+			if (sourcePrimitive.material >= 0 && static_cast<size_t>(sourcePrimitive.material) < model.materials.size())
+			{
+				primitive.material = static_cast<uint32_t>(sourcePrimitive.material);
+			}
+			else
+			{
+				primitive.material = defaultMaterial;
+				usesDefaultMaterial = true;
+			}
+
+			primitive.firstVertex = static_cast<uint32_t>(vertexCount);
+			primitive.firstIndex = static_cast<uint32_t>(indexCount);
+			vertexCount += primitive.vertexCount;
+			indexCount += primitive.indexCount;
+
+			if (vertexCount > UINT32_MAX || indexCount > UINT32_MAX)
+			{
+				throw std::runtime_error(path + " has too many vertices for 32 bit indices");
+			}
+
+			this->Primitives.push_back(primitive);
+		}
+
+		mesh.primitiveCount = static_cast<uint32_t>(this->Primitives.size()) - mesh.firstPrimitive;
+		this->Meshes.push_back(mesh);
+	}
+
+	// the buffers are kept as loaded, streams only hold offsets into them
+	this->Buffers.reserve(model.buffers.size());
+
+	for (auto& buffer : model.buffers)
+	{
+		this->Buffers.push_back(std::move(buffer.data));
+	}
+
+	for (const auto& primitive : this->Primitives)
+	{
+		if (primitive.indices.componentType != 0 && !AreIndicesInRange(this->Buffers, primitive))
+		{
+			throw std::runtime_error(path + " has an index out of range");
+		}
+	}
+
+	if (usesDefaultMaterial)
+	{
+		this->Materials.push_back(GltfMaterial());
+	}
+
+	this->VertexCount = static_cast<uint32_t>(vertexCount);
+	this->IndexCount = static_cast<uint32_t>(indexCount);
+
+	// glTF lists children per node, the nodes are reordered so every parent precedes its children
+	const SceneNodeId noParent = SceneGraph::NO_PARENT;
+	const uint32_t noIndex = GltfNode::NO_INDEX;
+	std::vector<SceneNodeId> parents(model.nodes.size(), noParent);
+
+	for (size_t node = 0; node < model.nodes.size(); node++)
+	{
+		for (const auto child : model.nodes[node].children)
+		{
+			if (child < 0 || static_cast<size_t>(child) >= model.nodes.size() || parents[child] != SceneGraph::NO_PARENT)
+			{
+				throw std::runtime_error("node " + std::to_string(node) + " has an invalid child");
+			}
+
+			parents[child] = static_cast<SceneNodeId>(node);
+		}
+	}
+
+	std::vector<SceneNodeId> order;
+
+	try
+	{
+		order = SceneGraph::SortParentsFirst(parents);
+	}
+	catch (const std::invalid_argument& e)
+	{
+		throw std::runtime_error(path + ": " + e.what());
+	}
+
+	std::vector<uint32_t> remap(order.size());
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		remap[order[i]] = static_cast<uint32_t>(i);
+	}
+
+	for (const auto index : order)
+	{
+		const tinygltf::Node& source = model.nodes[index];
+
+		GltfNode node;
+		node.name = source.name;
+		node.parent = parents[index] != SceneGraph::NO_PARENT ? remap[parents[index]] : noIndex;
+
+		if (source.mesh >= 0 && static_cast<size_t>(source.mesh) < this->Meshes.size())
+		{
+			node.mesh = static_cast<uint32_t>(source.mesh);
+		}
+
+		if (source.matrix.size() == 16)
+		{
+			// glTF matrices are column major and may not shear, so they split into translation, rotation and scale
+			glm::mat4 matrix;
+
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					matrix[column][row] = static_cast<float>(source.matrix[column * 4 + row]);
+				}
+			}
+
+			glm::vec3 axes[3] = { glm::vec3(matrix[0]), glm::vec3(matrix[1]), glm::vec3(matrix[2]) };
+			node.translation = glm::vec3(matrix[3]);
+			node.scale = glm::vec3(glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2]));
+
+			if (glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.0f)
+			{
+				node.scale.x = -node.scale.x;
+			}
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				axes[axis] = node.scale[axis] != 0.0f ? axes[axis] / node.scale[axis] : glm::vec3(0.0f);
+			}
+
+			node.rotation = glm::quat_cast(glm::mat3(axes[0], axes[1], axes[2]));
+		}
+		else
+		{
+			if (source.translation.size() == 3)
+			{
+				node.translation = glm::vec3(source.translation[0], source.translation[1], source.translation[2]);
+			}
+
+			if (source.rotation.size() == 4)
+			{
+				node.rotation = glm::quat(
+					static_cast<float>(source.rotation[3]),
+					static_cast<float>(source.rotation[0]),
+					static_cast<float>(source.rotation[1]),
+					static_cast<float>(source.rotation[2]));
+			}
+
+			if (source.scale.size() == 3)
+			{
+				node.scale = glm::vec3(source.scale[0], source.scale[1], source.scale[2]);
+			}
+		}
+
+		this->Nodes.push_back(node);
+	}
+}
+
+const std::vector<VulkanCore::GltfMesh>& VulkanCore::GltfModel::GetMeshes() const
+{
+	return this->Meshes;
+}
+
+const std::vector<VulkanCore::GltfPrimitive>& VulkanCore::GltfModel::GetPrimitives() const
+{
+	return this->Primitives;
+}
+
+const std::vector<VulkanCore::GltfMaterial>& VulkanCore::GltfModel::GetMaterials() const
+{
+	return this->Materials;
+}
+
+const std::vector<VulkanCore::GltfNode>& VulkanCore::GltfModel::GetNodes() const
+{
+	return this->Nodes;
+}
+
+uint32_t VulkanCore::GltfModel::GetVertexCount() const
+{
+	return this->VertexCount;
+}
+
+uint32_t VulkanCore::GltfModel::GetIndexCount() const
+{
+	return this->IndexCount;
+}
+
+void VulkanCore::GltfModel::Flatten(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) const
+{
+	SceneGraph scene;
+	this->AppendTo(scene);
+	scene.UpdateWorldTransforms();
+
+	vertices.clear();
+	indices.clear();
+
+	// every vertex is read from its strided accessor straight into place, transformed on the way
+	const auto appendMesh = [&](uint32_t mesh, const glm::mat4& transform)
+	{
+		for (uint32_t i = 0; i < this->Meshes[mesh].primitiveCount; i++)
+		{
+			const GltfPrimitive& primitive = this->Primitives[this->Meshes[mesh].firstPrimitive + i];
+			const uint32_t firstVertex = static_cast<uint32_t>(vertices.size());
+
+			for (uint32_t vertex = 0; vertex < primitive.vertexCount; vertex++)
+			{
+				Vertex transformed = ReadVertex(this->Buffers, primitive, vertex);
+				transformed.position = glm::vec3(transform * glm::vec4(transformed.position, 1.0f));
+				vertices.push_back(transformed);
+			}
+
+			if (primitive.indices.componentType == 0)
+			{
+				for (uint32_t index = 0; index < primitive.indexCount; index++)
+				{
+					indices.push_back(firstVertex + index);
+				}
+
+				continue;
+			}
+
+			const uint8_t* data = this->Buffers[primitive.indices.buffer].data() + primitive.indices.offset;
+
+			for (uint32_t index = 0; index < primitive.indexCount; index++)
+			{
+				indices.push_back(firstVertex + ReadIndex(data + static_cast<size_t>(index) * primitive.indices.stride, primitive.indices.componentType));
+			}
+		}
+	};
+
+	bool instanced = false;
+
+	for (size_t node = 0; node < this->Nodes.size(); node++)
+	{
+		if (this->Nodes[node].mesh != GltfNode::NO_INDEX)
+		{
+			appendMesh(this->Nodes[node].mesh, scene.GetWorldTransform(static_cast<SceneNodeId>(node)));
+			instanced = true;
+		}
+	}
+
+	// a file of bare meshes without nodes still has something to show
+	if (!instanced)
+	{
+		for (uint32_t mesh = 0; mesh < this->Meshes.size(); mesh++)
+		{
+			appendMesh(mesh, glm::mat4(1.0f));
+		}
+	}
+}
+
+VulkanCore::SceneNodeId VulkanCore::GltfModel::AppendTo(SceneGraph& scene) const
+{
+	const SceneNodeId firstNode = static_cast<SceneNodeId>(scene.GetNodeCount());
+
+	scene.Reserve(firstNode + this->Nodes.size());
+
+	for (const auto& node : this->Nodes)
+	{
+		scene.AddNode(
+			node.parent != GltfNode::NO_INDEX ? firstNode + node.parent : SceneGraph::NO_PARENT,
+			node.translation,
+			node.rotation,
+			node.scale);
+	}
+
+	return firstNode;
+}
+
+bool VulkanCore::GltfModel::IsGltfPath(const std::string& path)
+{
+	std::string extension = std::filesystem::path(path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+	return extension == ".gltf" || extension == ".glb";
+}
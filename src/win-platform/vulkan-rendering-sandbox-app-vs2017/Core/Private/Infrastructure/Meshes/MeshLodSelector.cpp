@@ -0,0 +1,39 @@
+#include "../../../Public/Infrastructure/Meshes/MeshLodSelector.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+float VulkanCore::MeshLodSelector::GetScreenSize(float boundsRadius, float distance, float verticalFieldOfView, uint32_t viewportHeight)
+{
+	// the camera is inside the bounds, nothing but the full mesh will do
+	if (distance <= boundsRadius)
+	{
+		return FLT_MAX;
+	}
+
+	return boundsRadius / (distance * std::tan(verticalFieldOfView * 0.5f)) * static_cast<float>(viewportHeight);
+}
+
+uint32_t VulkanCore::MeshLodSelector::SelectLod(const std::vector<MeshLod>& lods, float screenSize, uint32_t currentLod, const MeshLodSettings& settings)
+{
+	if (lods.empty())
+	{
+		return 0;
+	}
+
+	uint32_t lod = std::min(currentLod, static_cast<uint32_t>(lods.size() - 1));
+
+	// errors are relative to the bounds diameter, so screenSize * error is the error in pixels
+	while (lod > 0 && screenSize * lods[lod].error > settings.pixelError)
+	{
+		lod--;
+	}
+
+	while (lod + 1 < lods.size() && screenSize * lods[lod + 1].error <= settings.pixelError * (1.0f - settings.hysteresis))
+	{
+		lod++;
+	}
+
+	return lod;
+}
@@ -0,0 +1,424 @@
+#include "../../../Public/Infrastructure/Meshes/MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+static const uint32_t NO_VERTEX = 0xFFFFFFFF;
+
+static const float* GetPosition(const float* positions, size_t positionStride, uint32_t vertex)
+{
+	return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + vertex * positionStride);
+}
+
+static uint64_t GetEdgeKey(uint32_t from, uint32_t to)
+{
+	return (static_cast<uint64_t>(from) << 32) | to;
+}
+
+float VulkanCore::MeshSimplifier::Simplify(
+	const std::vector<uint32_t>& indices,
+	const float* positions,
+	size_t vertexCount,
+	size_t positionStride,
+	size_t targetIndexCount,
+	float targetError,
+	std::vector<uint32_t>& destination)
+{
+	std::vector<uint32_t> result(indices);
+
+	if (result.size() <= targetIndexCount || vertexCount == 0)
+	{
+		destination.swap(result);
+		return 0.0f;
+	}
+
+	std::vector<uint32_t> positionIds;
+	WeldPositions(positions, vertexCount, positionStride, positionIds);
+
+	// collapsing a vertex that has several attribute variants (a UV seam) or lies on an open border would tear
+	// the mesh, those positions can only be collapsed onto
+	std::vector<uint32_t> wedges(vertexCount, NO_VERTEX);
+	std::vector<uint8_t> locked(vertexCount, 0);
+
+	for (const auto vertex : result)
+	{
+		const uint32_t position = positionIds[vertex];
+
+		if (wedges[position] == NO_VERTEX)
+		{
+			wedges[position] = vertex;
+		}
+		else if (wedges[position] != vertex)
+		{
+			locked[position] = 1;
+		}
+	}
+
+	std::unordered_map<uint64_t, uint32_t> halfEdges;
+
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			halfEdges[GetEdgeKey(positionIds[result[i + corner]], positionIds[result[i + (corner + 1) % 3]])]++;
+		}
+	}
+
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			const uint32_t from = positionIds[result[i + corner]];
+			const uint32_t to = positionIds[result[i + (corner + 1) % 3]];
+			const auto opposite = halfEdges.find(GetEdgeKey(to, from));
+
+			// open and non-manifold edges
+			if (opposite == halfEdges.end() || opposite->second != 1 || halfEdges[GetEdgeKey(from, to)] != 1)
+			{
+				locked[from] = 1;
+				locked[to] = 1;
+			}
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		const float* p0 = GetPosition(positions, positionStride, result[i + 0]);
+		const float* p1 = GetPosition(positions, positionStride, result[i + 1]);
+		const float* p2 = GetPosition(positions, positionStride, result[i + 2]);
+
+		const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		double normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+		if (length == 0.0)
+		{
+			continue;
+		}
+
+		normal[0] /= length;
+		normal[1] /= length;
+		normal[2] /= length;
+
+		const double distance = -(normal[0] * p0[0] + normal[1] * p0[1] + normal[2] * p0[2]);
+
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			quadrics[positionIds[result[i + corner]]].AddPlane(normal[0], normal[1], normal[2], distance, length * 0.5);
+		}
+	}
+
+	const double errorLimit = static_cast<double>(targetError) * static_cast<double>(targetError);
+	const size_t targetTriangleCount = targetIndexCount / 3;
+	double resultError = 0.0;
+
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+	std::vector<uint32_t> triangleLists;
+	std::vector<uint32_t> collapseTargets(vertexCount);
+	std::vector<uint8_t> touched(vertexCount);
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> fromRing;
+	std::vector<uint32_t> toRing;
+
+	// every pass collapses the cheapest edges that do not share a neighbourhood, then rebuilds the triangle list
+	while (result.size() / 3 > targetTriangleCount)
+	{
+		const size_t triangleCount = result.size() / 3;
+
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+
+		for (const auto vertex : result)
+		{
+			triangleOffsets[positionIds[vertex] + 1]++;
+		}
+
+		std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+		triangleLists.resize(result.size());
+
+		std::vector<uint32_t> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			triangleLists[cursors[positionIds[result[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		collapses.clear();
+
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t a = positionIds[result[i + corner]];
+				const uint32_t b = positionIds[result[i + (corner + 1) % 3]];
+
+				// interior edges show up once in each direction
+				if (a >= b)
+				{
+					continue;
+				}
+
+				Collapse collapse = { a, b, std::numeric_limits<double>::max() };
+
+				if (!locked[a])
+				{
+					collapse.error = quadrics[a].Evaluate(GetPosition(positions, positionStride, b));
+				}
+
+				if (!locked[b])
+				{
+					const double error = quadrics[b].Evaluate(GetPosition(positions, positionStride, a));
+
+					if (error < collapse.error)
+					{
+						collapse = { b, a, error };
+					}
+				}
+
+				if (collapse.error != std::numeric_limits<double>::max())
+				{
+					collapses.push_back(collapse);
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right) {
+			return left.error < right.error;
+		});
+
+		std::iota(collapseTargets.begin(), collapseTargets.end(), 0);
+		std::fill(touched.begin(), touched.end(), 0);
+
+		// a collapse of an interior edge removes two triangles
+		const size_t collapseLimit = (triangleCount - targetTriangleCount + 1) / 2;
+		size_t collapseCount = 0;
+
+		for (const auto& collapse : collapses)
+		{
+			if (collapseCount >= collapseLimit || collapse.error > errorLimit)
+			{
+				break;
+			}
+
+			if (touched[collapse.from] || touched[collapse.to])
+			{
+				continue;
+			}
+
+			fromRing.clear();
+			toRing.clear();
+
+			uint32_t toWedge = NO_VERTEX;
+			bool flips = false;
+
+			for (uint32_t t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && !flips; t++)
+			{
+				const uint32_t* triangle = &result[triangleLists[t] * 3];
+				const uint32_t corner = positionIds[triangle[0]] == collapse.from ? 0 : positionIds[triangle[1]] == collapse.from ? 1 : 2;
+
+				const uint32_t next = triangle[(corner + 1) % 3];
+				const uint32_t previous = triangle[(corner + 2) % 3];
+
+				fromRing.push_back(positionIds[next]);
+				fromRing.push_back(positionIds[previous]);
+
+				if (positionIds[next] == collapse.to || positionIds[previous] == collapse.to)
+				{
+					// this triangle disappears, it tells which attribute variant of the target the others switch to
+					toWedge = positionIds[next] == collapse.to ? next : previous;
+					continue;
+				}
+
+				flips = FlipsTriangle(
+					GetPosition(positions, positionStride, triangle[corner]),
+					GetPosition(positions, positionStride, collapse.to),
+					GetPosition(positions, positionStride, next),
+					GetPosition(positions, positionStride, previous));
+			}
+
+			if (flips || toWedge == NO_VERTEX)
+			{
+				continue;
+			}
+
+			for (uint32_t t = triangleOffsets[collapse.to]; t < triangleOffsets[collapse.to + 1]; t++)
+			{
+				const uint32_t* triangle = &result[triangleLists[t] * 3];
+
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					toRing.push_back(positionIds[triangle[corner]]);
+				}
+			}
+
+			std::sort(fromRing.begin(), fromRing.end());
+			fromRing.erase(std::unique(fromRing.begin(), fromRing.end()), fromRing.end());
+			std::sort(toRing.begin(), toRing.end());
+			toRing.erase(std::unique(toRing.begin(), toRing.end()), toRing.end());
+
+			// the end points of an interior edge share exactly the two vertices opposite to it,
+			// more would pinch the surface into a non-manifold one
+			size_t sharedCount = 0;
+			for (const auto position : fromRing)
+			{
+				if (position != collapse.to && std::binary_search(toRing.begin(), toRing.end(), position))
+				{
+					sharedCount++;
+				}
+			}
+
+			if (sharedCount != 2)
+			{
+				continue;
+			}
+
+			collapseTargets[wedges[collapse.from]] = toWedge;
+			quadrics[collapse.to].Add(quadrics[collapse.from]);
+			resultError = std::max(resultError, collapse.error);
+			collapseCount++;
+
+			// the neighbourhood is stale until the triangle list is rebuilt
+			touched[collapse.from] = 1;
+			for (const auto position : fromRing)
+			{
+				touched[position] = 1;
+			}
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		size_t writeIndex = 0;
+
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			const uint32_t v0 = collapseTargets[result[i + 0]];
+			const uint32_t v1 = collapseTargets[result[i + 1]];
+			const uint32_t v2 = collapseTargets[result[i + 2]];
+
+			if (positionIds[v0] == positionIds[v1] || positionIds[v1] == positionIds[v2] || positionIds[v0] == positionIds[v2])
+			{
+				continue;
+			}
+
+			result[writeIndex++] = v0;
+			result[writeIndex++] = v1;
+			result[writeIndex++] = v2;
+		}
+
+		result.resize(writeIndex);
+	}
+
+	destination.swap(result);
+
+	return static_cast<float>(std::sqrt(resultError));
+}
+
+void VulkanCore::MeshSimplifier::WeldPositions(const float* positions, size_t vertexCount, size_t positionStride, std::vector<uint32_t>& positionIds)
+{
+	std::vector<uint32_t> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0);
+
+	std::sort(order.begin(), order.end(), [positions, positionStride](uint32_t left, uint32_t right) {
+		const float* a = GetPosition(positions, positionStride, left);
+		const float* b = GetPosition(positions, positionStride, right);
+		return std::lexicographical_compare(a, a + 3, b, b + 3);
+	});
+
+	positionIds.resize(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float* position = GetPosition(positions, positionStride, order[i]);
+		const float* previous = i > 0 ? GetPosition(positions, positionStride, order[i - 1]) : nullptr;
+
+		if (previous != nullptr && std::equal(position, position + 3, previous))
+		{
+			positionIds[order[i]] = positionIds[order[i - 1]];
+		}
+		else
+		{
+			positionIds[order[i]] = order[i];
+		}
+	}
+}
+
+bool VulkanCore::MeshSimplifier::FlipsTriangle(const float* from, const float* to, const float* a, const float* b)
+{
+	double before[3];
+	double after[3];
+
+	const double fa[3] = { a[0] - from[0], a[1] - from[1], a[2] - from[2] };
+	const double fb[3] = { b[0] - from[0], b[1] - from[1], b[2] - from[2] };
+	const double ta[3] = { a[0] - to[0], a[1] - to[1], a[2] - to[2] };
+	const double tb[3] = { b[0] - to[0], b[1] - to[1], b[2] - to[2] };
+
+	before[0] = fa[1] * fb[2] - fa[2] * fb[1];
+	before[1] = fa[2] * fb[0] - fa[0] * fb[2];
+	before[2] = fa[0] * fb[1] - fa[1] * fb[0];
+
+	after[0] = ta[1] * tb[2] - ta[2] * tb[1];
+	after[1] = ta[2] * tb[0] - ta[0] * tb[2];
+	after[2] = ta[0] * tb[1] - ta[1] * tb[0];
+
+	// degenerate results count as flipped
+	return before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0;
+}
+
+void VulkanCore::MeshSimplifier::Quadric::AddPlane(double nx, double ny, double nz, double d, double planeWeight)
+{
+	this->a00 += planeWeight * nx * nx;
+	this->a11 += planeWeight * ny * ny;
+	this->a22 += planeWeight * nz * nz;
+	this->a01 += planeWeight * nx * ny;
+	this->a02 += planeWeight * nx * nz;
+	this->a12 += planeWeight * ny * nz;
+	this->b0 += planeWeight * nx * d;
+	this->b1 += planeWeight * ny * d;
+	this->b2 += planeWeight * nz * d;
+	this->c += planeWeight * d * d;
+	this->weight += planeWeight;
+}
+
+void VulkanCore::MeshSimplifier::Quadric::Add(const Quadric& other)
+{
+	this->a00 += other.a00;
+	this->a11 += other.a11;
+	this->a22 += other.a22;
+	this->a01 += other.a01;
+	this->a02 += other.a02;
+	this->a12 += other.a12;
+	this->b0 += other.b0;
+	this->b1 += other.b1;
+	this->b2 += other.b2;
+	this->c += other.c;
+	this->weight += other.weight;
+}
+
+double VulkanCore::MeshSimplifier::Quadric::Evaluate(const float* point) const
+{
+	if (this->weight == 0.0)
+	{
+		return 0.0;
+	}
+
+	const double x = point[0];
+	const double y = point[1];
+	const double z = point[2];
+
+	const double error =
+		this->a00 * x * x + this->a11 * y * y + this->a22 * z * z +
+		2.0 * (this->a01 * x * y + this->a02 * x * z + this->a12 * y * z) +
+		2.0 * (this->b0 * x + this->b1 * y + this->b2 * z) +
+		this->c;
+
+	return std::max(error, 0.0) / this->weight;
+}
@@ -0,0 +1,414 @@
+#include "../../../Public/Infrastructure/Meshes/Meshlets.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static const uint32_t NO_MESHLET = 0xFFFFFFFF;
+
+// cones whose normals come this close to perpendicular to the axis are not worth testing
+static const float MIN_CONE_DOT = 0.1f;
+
+static bool GetTriangleNormal(const std::vector<Vertex>& vertices, const uint32_t* triangle, glm::vec3& normal)
+{
+	normal = glm::cross(
+		vertices[triangle[1]].position - vertices[triangle[0]].position,
+		vertices[triangle[2]].position - vertices[triangle[0]].position);
+
+	const float length = glm::length(normal);
+
+	if (length == 0.0f)
+	{
+		return false;
+	}
+
+	normal = normal / length;
+	return true;
+}
+
+static glm::vec3 GetCentroid(const std::vector<Vertex>& vertices, const uint32_t* triangle)
+{
+	return (vertices[triangle[0]].position + vertices[triangle[1]].position + vertices[triangle[2]].position) / 3.0f;
+}
+
+static void ComputeBounds(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, VulkanCore::Meshlet& meshlet)
+{
+	const uint32_t indexEnd = meshlet.firstIndex + meshlet.triangleCount * 3;
+
+	glm::vec3 minimum(FLT_MAX);
+	glm::vec3 maximum(-FLT_MAX);
+
+	for (uint32_t i = meshlet.firstIndex; i < indexEnd; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			minimum[axis] = std::min(minimum[axis], vertices[indices[i]].position[axis]);
+			maximum[axis] = std::max(maximum[axis], vertices[indices[i]].position[axis]);
+		}
+	}
+
+	const glm::vec3 center = (minimum + maximum) * 0.5f;
+	float radius = 0.0f;
+	glm::vec3 normalSum(0.0f);
+
+	for (uint32_t i = meshlet.firstIndex; i < indexEnd; i++)
+	{
+		radius = std::max(radius, glm::length(vertices[indices[i]].position - center));
+	}
+
+	for (uint32_t i = meshlet.firstIndex; i < indexEnd; i += 3)
+	{
+		glm::vec3 normal;
+
+		if (GetTriangleNormal(vertices, &indices[i], normal))
+		{
+			normalSum += normal;
+		}
+	}
+
+	meshlet.center[0] = center.x;
+	meshlet.center[1] = center.y;
+	meshlet.center[2] = center.z;
+	meshlet.radius = radius;
+
+	meshlet.coneAxis[0] = 0.0f;
+	meshlet.coneAxis[1] = 0.0f;
+	meshlet.coneAxis[2] = 1.0f;
+	meshlet.coneCutoff = 1.0f;
+
+	if (glm::length(normalSum) == 0.0f)
+	{
+		return;
+	}
+
+	const glm::vec3 axis = glm::normalize(normalSum);
+	float minimumDot = 1.0f;
+
+	for (uint32_t i = meshlet.firstIndex; i < indexEnd; i += 3)
+	{
+		glm::vec3 normal;
+
+		if (GetTriangleNormal(vertices, &indices[i], normal))
+		{
+			minimumDot = std::min(minimumDot, glm::dot(normal, axis));
+		}
+	}
+
+	meshlet.coneAxis[0] = axis.x;
+	meshlet.coneAxis[1] = axis.y;
+	meshlet.coneAxis[2] = axis.z;
+
+	// sine of the cone's half angle, the culling test widens the cone by the bounding sphere
+	if (minimumDot > MIN_CONE_DOT)
+	{
+		meshlet.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+	}
+}
+
+void VulkanCore::MeshletBuilder::Build(
+	const std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	uint32_t firstIndex,
+	uint32_t indexCount,
+	std::vector<Meshlet>& meshlets)
+{
+	const uint32_t triangleCount = indexCount / 3;
+	const uint32_t* triangles = &indices[firstIndex];
+	const size_t firstMeshlet = meshlets.size();
+
+	// triangles around every vertex
+	std::vector<uint32_t> triangleOffsets(vertices.size() + 1, 0);
+
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		triangleOffsets[triangles[i] + 1]++;
+	}
+
+	for (size_t i = 1; i < triangleOffsets.size(); i++)
+	{
+		triangleOffsets[i] += triangleOffsets[i - 1];
+	}
+
+	std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+	std::vector<uint32_t> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		vertexTriangles[cursors[triangles[i]]++] = i / 3;
+	}
+
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<uint32_t> vertexMeshlet(vertices.size(), NO_MESHLET);
+	std::vector<uint32_t> ordered;
+	ordered.reserve(triangleCount * 3);
+
+	std::vector<uint32_t> meshletVertices;
+	uint32_t meshletTriangleCount = 0;
+	glm::vec3 centroidSum(0.0f);
+	uint32_t seedCursor = 0;
+
+	const auto closeMeshlet = [&]() {
+		Meshlet meshlet = {};
+		meshlet.firstIndex = firstIndex + static_cast<uint32_t>(ordered.size()) - meshletTriangleCount * 3;
+		meshlet.triangleCount = meshletTriangleCount;
+		meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+		meshlets.push_back(meshlet);
+
+		meshletVertices.clear();
+		meshletTriangleCount = 0;
+		centroidSum = glm::vec3(0.0f);
+	};
+
+	for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		const uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+		uint32_t next = NO_MESHLET;
+
+		if (meshletTriangleCount > 0)
+		{
+			// prefer triangles that add the fewest vertices, then the ones closest to the cluster
+			const glm::vec3 center = centroidSum / static_cast<float>(meshletTriangleCount);
+			uint32_t bestNewVertices = 4;
+			float bestDistance = FLT_MAX;
+
+			for (const auto vertex : meshletVertices)
+			{
+				for (uint32_t t = triangleOffsets[vertex]; t < triangleOffsets[vertex + 1]; t++)
+				{
+					const uint32_t triangle = vertexTriangles[t];
+
+					if (emitted[triangle])
+					{
+						continue;
+					}
+
+					uint32_t newVertices = 0;
+					for (uint32_t corner = 0; corner < 3; corner++)
+					{
+						newVertices += vertexMeshlet[triangles[triangle * 3 + corner]] != meshletId ? 1 : 0;
+					}
+
+					if (meshletVertices.size() + newVertices > MAX_VERTICES || newVertices > bestNewVertices)
+					{
+						continue;
+					}
+
+					const float distance = glm::length(GetCentroid(vertices, &triangles[triangle * 3]) - center);
+
+					if (newVertices < bestNewVertices || distance < bestDistance)
+					{
+						next = triangle;
+						bestNewVertices = newVertices;
+						bestDistance = distance;
+					}
+				}
+			}
+		}
+
+		if (next == NO_MESHLET)
+		{
+			// nothing connected fits, the cluster is done and the next one starts at the first free triangle
+			if (meshletTriangleCount > 0)
+			{
+				closeMeshlet();
+			}
+
+			while (emitted[seedCursor])
+			{
+				seedCursor++;
+			}
+
+			next = seedCursor;
+		}
+
+		// differs from meshletId when the cluster was just closed
+		const uint32_t currentId = static_cast<uint32_t>(meshlets.size());
+
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			const uint32_t vertex = triangles[next * 3 + corner];
+
+			if (vertexMeshlet[vertex] != currentId)
+			{
+				vertexMeshlet[vertex] = currentId;
+				meshletVertices.push_back(vertex);
+			}
+
+			ordered.push_back(vertex);
+		}
+
+		emitted[next] = 1;
+		meshletTriangleCount++;
+		centroidSum += GetCentroid(vertices, &triangles[next * 3]);
+
+		if (meshletTriangleCount == MAX_TRIANGLES)
+		{
+			closeMeshlet();
+		}
+	}
+
+	if (meshletTriangleCount > 0)
+	{
+		closeMeshlet();
+	}
+
+	std::copy(ordered.begin(), ordered.end(), indices.begin() + firstIndex);
+
+	// bounds are computed once the index range holds the reordered triangles
+	for (size_t i = firstMeshlet; i < meshlets.size(); i++)
+	{
+		ComputeBounds(vertices, indices, meshlets[i]);
+	}
+}
+
+bool VulkanCore::MeshletBuilder::Validate(
+	const std::vector<Vertex>& vertices,
+	const std::vector<uint32_t>& indices,
+	uint32_t firstIndex,
+	uint32_t indexCount,
+	const std::vector<Meshlet>& meshlets,
+	uint32_t firstMeshlet,
+	uint32_t meshletCount,
+	std::string& error)
+{
+	if (static_cast<uint64_t>(firstMeshlet) + meshletCount > meshlets.size())
+	{
+		error = "meshlet range exceeds the meshlet count";
+		return false;
+	}
+
+	std::vector<uint32_t> meshletVertices;
+	uint32_t nextIndex = firstIndex;
+
+	for (uint32_t m = firstMeshlet; m < firstMeshlet + meshletCount; m++)
+	{
+		const Meshlet& meshlet = meshlets[m];
+		const std::string name = "meshlet " + std::to_string(m);
+
+		// meshlets tile the index range in order, with no gaps or overlaps
+		if (meshlet.firstIndex != nextIndex || meshlet.triangleCount == 0)
+		{
+			error = name + " does not continue the index range";
+			return false;
+		}
+
+		if (meshlet.triangleCount > MAX_TRIANGLES)
+		{
+			error = name + " has " + std::to_string(meshlet.triangleCount) + " triangles";
+			return false;
+		}
+
+		nextIndex += meshlet.triangleCount * 3;
+
+		if (nextIndex > firstIndex + indexCount || nextIndex > indices.size())
+		{
+			error = name + " runs past the index range";
+			return false;
+		}
+
+		meshletVertices.assign(indices.begin() + meshlet.firstIndex, indices.begin() + nextIndex);
+		std::sort(meshletVertices.begin(), meshletVertices.end());
+		meshletVertices.erase(std::unique(meshletVertices.begin(), meshletVertices.end()), meshletVertices.end());
+
+		if (meshletVertices.size() > MAX_VERTICES || meshletVertices.size() != meshlet.vertexCount)
+		{
+			error = name + " has " + std::to_string(meshletVertices.size()) + " vertices, " + std::to_string(meshlet.vertexCount) + " recorded";
+			return false;
+		}
+
+		const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+		const glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+		const float tolerance = 1e-4f * std::max(meshlet.radius, 1.0f);
+
+		for (const auto vertex : meshletVertices)
+		{
+			if (vertex >= vertices.size())
+			{
+				error = name + " references a vertex past the vertex buffer";
+				return false;
+			}
+
+			if (glm::length(vertices[vertex].position - center) > meshlet.radius + tolerance)
+			{
+				error = name + " has a vertex outside its bounding sphere";
+				return false;
+			}
+		}
+
+		if (meshlet.coneCutoff < 1.0f)
+		{
+			// the cone's half angle, every normal has to be within it
+			const float minimumDot = std::sqrt(1.0f - meshlet.coneCutoff * meshlet.coneCutoff);
+
+			for (uint32_t i = meshlet.firstIndex; i < nextIndex; i += 3)
+			{
+				glm::vec3 normal;
+
+				if (GetTriangleNormal(vertices, &indices[i], normal) && glm::dot(normal, axis) < minimumDot - 1e-3f)
+				{
+					error = name + " has a triangle facing outside its normal cone";
+					return false;
+				}
+			}
+		}
+	}
+
+	if (nextIndex != firstIndex + indexCount)
+	{
+		error = "meshlets cover " + std::to_string(nextIndex - firstIndex) + " of " + std::to_string(indexCount) + " indices";
+		return false;
+	}
+
+	return true;
+}
+
+void VulkanCore::MeshletBuilder::GetFrustumPlanes(const glm::mat4& modelViewProjection, float planes[6][4])
+{
+	// Gribb and Hartmann, every plane is a sum or difference of the w row and one other row of the matrix
+	const float signs[6] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+
+	for (int plane = 0; plane < 6; plane++)
+	{
+		// near is z > -w, looser than the z > 0 of a zero to one depth range but correct for both
+		const int row = plane / 2;
+
+		for (int column = 0; column < 4; column++)
+		{
+			planes[plane][column] = modelViewProjection[column][3] + signs[plane] * modelViewProjection[column][row];
+		}
+
+		const float length = std::sqrt(planes[plane][0] * planes[plane][0] + planes[plane][1] * planes[plane][1] + planes[plane][2] * planes[plane][2]);
+
+		for (int column = 0; column < 4; column++)
+		{
+			planes[plane][column] /= length;
+		}
+	}
+}
+
+bool VulkanCore::MeshletBuilder::IsVisible(const Meshlet& meshlet, const float cameraPosition[3], const float planes[6][4])
+{
+	for (int plane = 0; plane < 6; plane++)
+	{
+		const float distance =
+			planes[plane][0] * meshlet.center[0] +
+			planes[plane][1] * meshlet.center[1] +
+			planes[plane][2] * meshlet.center[2] +
+			planes[plane][3];
+
+		if (distance < -meshlet.radius)
+		{
+			return false;
+		}
+	}
+
+	const glm::vec3 view(
+		meshlet.center[0] - cameraPosition[0],
+		meshlet.center[1] - cameraPosition[1],
+		meshlet.center[2] - cameraPosition[2]);
+
+	// every triangle faces away from the camera
+	const float facing = view.x * meshlet.coneAxis[0] + view.y * meshlet.coneAxis[1] + view.z * meshlet.coneAxis[2];
+
+	return facing < meshlet.coneCutoff * glm::length(view) + meshlet.radius;
+}
@@ -0,0 +1,153 @@
+#include "../../../Public/Infrastructure/Profiling/CpuTrace.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+const char* VulkanCore::CpuTrace::OUTPUT_VARIABLE = "VK_RENDER_TRACE";
+
+std::atomic<bool> VulkanCore::CpuTrace::Enabled{ false };
+std::mutex VulkanCore::CpuTrace::RegistryLock;
+std::vector<std::shared_ptr<VulkanCore::CpuTrace::ThreadBuffer>> VulkanCore::CpuTrace::Registry;
+
+// every timestamp is relative to the first use, trace viewers expect small values
+static const std::chrono::steady_clock::time_point TraceEpoch = std::chrono::steady_clock::now();
+
+std::string VulkanCore::CpuTrace::EnableFromEnvironment()
+{
+	const char* value = std::getenv(OUTPUT_VARIABLE);
+
+	if (value == nullptr || *value == '\0')
+	{
+		return std::string();
+	}
+
+	SetEnabled(true);
+
+	return value;
+}
+
+void VulkanCore::CpuTrace::SetEnabled(bool enabled)
+{
+	// registers the calling thread up front so its first zone does not pay for the buffer
+	if (enabled)
+	{
+		GetThreadBuffer();
+	}
+
+	Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool VulkanCore::CpuTrace::IsEnabled()
+{
+	return Enabled.load(std::memory_order_relaxed);
+}
+
+int64_t VulkanCore::CpuTrace::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - TraceEpoch).count();
+}
+
+void VulkanCore::CpuTrace::Record(const char* name, int64_t startNanoseconds, int64_t endNanoseconds)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+
+	// only the owning thread appends, the count is published after the event is written
+	const size_t index = buffer.eventCount.load(std::memory_order_relaxed);
+
+	if (index >= buffer.events.size())
+	{
+		buffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	buffer.events[index] = { name, startNanoseconds, endNanoseconds - startNanoseconds };
+	buffer.eventCount.store(index + 1, std::memory_order_release);
+}
+
+VulkanCore::CpuTrace::ThreadBuffer& VulkanCore::CpuTrace::GetThreadBuffer()
+{
+	// the registry keeps buffers of finished threads alive until export
+	thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+	if (!buffer)
+	{
+		buffer = std::make_shared<ThreadBuffer>();
+		buffer->events.resize(EVENTS_PER_THREAD);
+
+		std::lock_guard<std::mutex> lock(RegistryLock);
+		buffer->threadId = static_cast<uint32_t>(Registry.size());
+		Registry.push_back(buffer);
+	}
+
+	return *buffer;
+}
+
+void VulkanCore::CpuTrace::WriteChromeTrace(const std::string& outputPath)
+{
+	nlohmann::json traceEvents = nlohmann::json::array();
+	uint64_t droppedCount = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(RegistryLock);
+
+		for (const auto& buffer : Registry)
+		{
+			const size_t eventCount = buffer->eventCount.load(std::memory_order_acquire);
+
+			traceEvents.push_back({
+				{ "name", "thread_name" },
+				{ "ph", "M" },
+				{ "pid", 0 },
+				{ "tid", buffer->threadId },
+				{ "args", { { "name", buffer->threadId == 0 ? "main" : "worker " + std::to_string(buffer->threadId) } } }
+			});
+
+			for (size_t i = 0; i < eventCount; ++i)
+			{
+				const CpuTraceEvent& event = buffer->events[i];
+
+				traceEvents.push_back({
+					{ "name", event.name },
+					{ "ph", "X" },
+					{ "pid", 0 },
+					{ "tid", buffer->threadId },
+					{ "ts", static_cast<double>(event.startNanoseconds) / 1000.0 },
+					{ "dur", static_cast<double>(event.durationNanoseconds) / 1000.0 }
+				});
+			}
+
+			droppedCount += buffer->droppedCount.load(std::memory_order_relaxed);
+		}
+	}
+
+	nlohmann::json trace;
+	trace["traceEvents"] = traceEvents;
+	trace["displayTimeUnit"] = "ms";
+	trace["otherData"] = { { "droppedEvents", droppedCount } };
+
+	std::ofstream traceFile(outputPath);
+
+	if (!traceFile.is_open())
+	{
+		throw std::runtime_error("failed to open trace file " + outputPath);
+	}
+
+	traceFile << trace.dump();
+}
+
+VulkanCore::CpuTraceZone::CpuTraceZone(const char* name) :
+	Name(name),
+	StartNanoseconds(CpuTrace::IsEnabled() ? CpuTrace::Now() : -1)
+{
+}
+
+VulkanCore::CpuTraceZone::~CpuTraceZone()
+{
+	if (this->StartNanoseconds >= 0)
+	{
+		CpuTrace::Record(this->Name, this->StartNanoseconds, CpuTrace::Now());
+	}
+}
@@ -0,0 +1,217 @@
+#include "../../../Public/Infrastructure/Profiling/GpuProfiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+VulkanCore::GpuProfiler::GpuProfiler(
+	VkDevice device,
+	VkPhysicalDevice physicalDevice,
+	uint32_t queueFamilyIndex,
+	uint32_t framesInFlight,
+	uint32_t maxScopesPerFrame,
+	size_t statisticsWindow) :
+	vkDevice(device),
+	MaxScopesPerFrame(maxScopesPerFrame),
+	StatisticsWindow(statisticsWindow),
+	Slots(framesInFlight)
+{
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	const uint32_t validBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+
+	// profiling is optional, an unsupported queue just reports nothing
+	if (validBits == 0)
+	{
+		return;
+	}
+
+	this->TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	this->TimestampPeriod = deviceProperties.limits.timestampPeriod;
+
+	VkQueryPoolCreateInfo queryPoolInfo = {};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = 2 * maxScopesPerFrame * framesInFlight;
+
+	if (vkCreateQueryPool(this->vkDevice, &queryPoolInfo, nullptr, &this->vkQueryPool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create timestamp query pool!");
+	}
+}
+
+VulkanCore::GpuProfiler::~GpuProfiler()
+{
+	if (this->vkQueryPool != VK_NULL_HANDLE)
+	{
+		vkDestroyQueryPool(this->vkDevice, this->vkQueryPool, nullptr);
+	}
+}
+
+bool VulkanCore::GpuProfiler::IsSupported() const
+{
+	return this->vkQueryPool != VK_NULL_HANDLE;
+}
+
+void VulkanCore::GpuProfiler::BeginFrame(uint32_t frameSlot, uint64_t frameIndex)
+{
+	FrameSlot& slot = this->Slots[frameSlot];
+	slot.frameIndex = frameIndex;
+	slot.scopeNames.clear();
+	slot.scopeEnded.clear();
+
+	this->CurrentSlot = frameSlot;
+}
+
+void VulkanCore::GpuProfiler::CollectResults(uint32_t frameSlot)
+{
+	FrameSlot& slot = this->Slots[frameSlot];
+
+	if (!this->IsSupported() || slot.scopeNames.empty())
+	{
+		return;
+	}
+
+	const uint32_t scopeCount = static_cast<uint32_t>(slot.scopeNames.size());
+	std::vector<uint64_t> timestamps(2 * scopeCount);
+
+	// no wait flag, the fence of this slot has already signaled
+	const VkResult result = vkGetQueryPoolResults(
+		this->vkDevice,
+		this->vkQueryPool,
+		frameSlot * 2 * this->MaxScopesPerFrame,
+		2 * scopeCount,
+		timestamps.size() * sizeof(uint64_t),
+		timestamps.data(),
+		sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT);
+
+	if (result == VK_SUCCESS)
+	{
+		// a name used several times in one frame is reported as the sum of its scopes
+		std::map<std::string, double> frameTimes;
+
+		for (uint32_t i = 0; i < scopeCount; ++i)
+		{
+			if (!slot.scopeEnded[i])
+			{
+				continue;
+			}
+
+			const uint64_t ticks = (timestamps[2 * i + 1] - timestamps[2 * i]) & this->TimestampMask;
+			frameTimes[slot.scopeNames[i]] += static_cast<double>(ticks) * this->TimestampPeriod / 1000000.0;
+		}
+
+		for (const auto& frameTime : frameTimes)
+		{
+			this->AddSample(frameTime.first, slot.frameIndex, frameTime.second);
+		}
+	}
+
+	slot.scopeNames.clear();
+	slot.scopeEnded.clear();
+}
+
+uint32_t VulkanCore::GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const std::string& name)
+{
+	FrameSlot& slot = this->Slots[this->CurrentSlot];
+
+	if (!this->IsSupported() || slot.scopeNames.size() >= this->MaxScopesPerFrame)
+	{
+		return INVALID_SCOPE;
+	}
+
+	const uint32_t scope = static_cast<uint32_t>(slot.scopeNames.size());
+	const uint32_t query = (this->CurrentSlot * this->MaxScopesPerFrame + scope) * 2;
+
+	slot.scopeNames.push_back(name);
+	slot.scopeEnded.push_back(false);
+
+	vkCmdResetQueryPool(commandBuffer, this->vkQueryPool, query, 2);
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, this->vkQueryPool, query);
+
+	return scope;
+}
+
+void VulkanCore::GpuProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scope)
+{
+	if (scope == INVALID_SCOPE)
+	{
+		return;
+	}
+
+	const uint32_t query = (this->CurrentSlot * this->MaxScopesPerFrame + scope) * 2 + 1;
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->vkQueryPool, query);
+
+	this->Slots[this->CurrentSlot].scopeEnded[scope] = true;
+}
+
+const std::map<std::string, VulkanCore::GpuScopeStatistics>& VulkanCore::GpuProfiler::GetStatistics() const
+{
+	return this->Statistics;
+}
+
+bool VulkanCore::GpuProfiler::GetLastScopeTime(const std::string& name, uint64_t& frameIndex, double& milliseconds) const
+{
+	const auto statistics = this->Statistics.find(name);
+
+	if (statistics == this->Statistics.end())
+	{
+		return false;
+	}
+
+	frameIndex = statistics->second.lastFrameIndex;
+	milliseconds = statistics->second.lastMilliseconds;
+
+	return true;
+}
+
+std::string VulkanCore::GpuProfiler::FormatStatistics() const
+{
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(3) << "gpu:";
+
+	for (const auto& entry : this->Statistics)
+	{
+		line << " " << entry.first << " " << entry.second.averageMilliseconds << "ms"
+			<< " [" << entry.second.minMilliseconds << ", " << entry.second.maxMilliseconds << "]";
+	}
+
+	return line.str();
+}
+
+void VulkanCore::GpuProfiler::AddSample(const std::string& name, uint64_t frameIndex, double milliseconds)
+{
+	GpuScopeStatistics& statistics = this->Statistics[name];
+
+	if (statistics.window.size() < this->StatisticsWindow)
+	{
+		statistics.window.push_back(milliseconds);
+	}
+	else
+	{
+		statistics.window[statistics.windowPosition] = milliseconds;
+	}
+
+	statistics.windowPosition = (statistics.windowPosition + 1) % this->StatisticsWindow;
+
+	statistics.lastMilliseconds = milliseconds;
+	statistics.lastFrameIndex = frameIndex;
+	statistics.sampleCount++;
+
+	const auto range = std::minmax_element(statistics.window.begin(), statistics.window.end());
+	statistics.minMilliseconds = *range.first;
+	statistics.maxMilliseconds = *range.second;
+	statistics.averageMilliseconds =
+		std::accumulate(statistics.window.begin(), statistics.window.end(), 0.0) / static_cast<double>(statistics.window.size());
+}
@@ -0,0 +1,266 @@
+#include "../../../Public/Infrastructure/Rendering/MeshletCullingPass.hpp"
+#include "../../../Public/Infrastructure/Shaders/ShaderReflection.hpp"
+#include "../../../Public/Utils/IOUtils.hpp"
+#include "../../../Public/Utils/MemoryUtils.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+VulkanCore::MeshletCullingPass::MeshletCullingPass(
+	VkDevice device,
+	VkPhysicalDevice physicalDevice,
+	VkCommandPool commandPool,
+	VkQueue graphicsQueue,
+	const std::string& shaderPath,
+	const std::vector<Meshlet>& meshlets,
+	uint32_t frameCount,
+	bool multiDrawIndirect) :
+	vkDevice(device),
+	MultiDrawIndirect(multiDrawIndirect)
+{
+	if (meshlets.empty())
+	{
+		throw std::invalid_argument("meshlet culling needs at least one meshlet!");
+	}
+
+	const std::vector<uint32_t> shaderCode = ShaderExtensions::ReadSpirvFile(shaderPath);
+	const ShaderReflectionData layout = ShaderReflection::Reflect(shaderCode, shaderPath);
+
+	if (layout.stageFlags != VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		throw std::runtime_error(shaderPath + " is not a compute shader!");
+	}
+
+	const std::vector<VkDescriptorSetLayoutBinding> bindings = layout.GetDescriptorSetLayoutBindings(0);
+
+	if (bindings.size() != 2 ||
+		bindings[0].descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+		bindings[1].descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+	{
+		throw std::runtime_error(shaderPath + " has to declare exactly two storage buffers!");
+	}
+
+	// meshlets never change after loading, they live in device local memory
+	const VkDeviceSize meshletBufferSize = sizeof(Meshlet) * meshlets.size();
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+
+	MemoryUtils::CreateBuffer(
+		meshletBufferSize,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		this->vkDevice,
+		physicalDevice,
+		stagingBuffer,
+		stagingBufferMemory);
+
+	void* data;
+	vkMapMemory(this->vkDevice, stagingBufferMemory, 0, meshletBufferSize, 0, &data);
+	memcpy(data, meshlets.data(), static_cast<size_t>(meshletBufferSize));
+	vkUnmapMemory(this->vkDevice, stagingBufferMemory);
+
+	MemoryUtils::CreateBuffer(
+		meshletBufferSize,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		this->vkDevice,
+		physicalDevice,
+		this->vkMeshletBuffer,
+		this->vkMeshletBufferMemory);
+
+	MemoryUtils::CopyBuffer(
+		stagingBuffer,
+		this->vkMeshletBuffer,
+		meshletBufferSize,
+		commandPool,
+		this->vkDevice,
+		graphicsQueue);
+
+	vkDestroyBuffer(this->vkDevice, stagingBuffer, nullptr);
+	vkFreeMemory(this->vkDevice, stagingBufferMemory, nullptr);
+
+	// the draws of a frame are read while the next frame is culled
+	const VkDeviceSize drawBufferSize = sizeof(VkDrawIndexedIndirectCommand) * meshlets.size();
+
+	this->vkDrawBuffers.resize(frameCount);
+	this->vkDrawBuffersMemory.resize(frameCount);
+
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		MemoryUtils::CreateBuffer(
+			drawBufferSize,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			this->vkDevice,
+			physicalDevice,
+			this->vkDrawBuffers[i],
+			this->vkDrawBuffersMemory[i]);
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(this->vkDevice, &layoutInfo, nullptr, &this->vkDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create meshlet culling descriptor set layout!");
+	}
+
+	VkDescriptorPoolSize poolSize = {};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 2 * frameCount;
+
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = frameCount;
+
+	if (vkCreateDescriptorPool(this->vkDevice, &poolInfo, nullptr, &this->vkDescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create meshlet culling descriptor pool!");
+	}
+
+	const std::vector<VkDescriptorSetLayout> setLayouts(frameCount, this->vkDescriptorSetLayout);
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = this->vkDescriptorPool;
+	allocInfo.descriptorSetCount = frameCount;
+	allocInfo.pSetLayouts = setLayouts.data();
+
+	this->vkDescriptorSets.resize(frameCount);
+
+	if (vkAllocateDescriptorSets(this->vkDevice, &allocInfo, this->vkDescriptorSets.data()) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate meshlet culling descriptor sets!");
+	}
+
+	for (uint32_t i = 0; i < frameCount; i++)
+	{
+		VkDescriptorBufferInfo meshletBufferInfo = {};
+		meshletBufferInfo.buffer = this->vkMeshletBuffer;
+		meshletBufferInfo.offset = 0;
+		meshletBufferInfo.range = meshletBufferSize;
+
+		VkDescriptorBufferInfo drawBufferInfo = {};
+		drawBufferInfo.buffer = this->vkDrawBuffers[i];
+		drawBufferInfo.offset = 0;
+		drawBufferInfo.range = drawBufferSize;
+
+		VkWriteDescriptorSet descriptorWrites[2] = {};
+
+		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[0].dstSet = this->vkDescriptorSets[i];
+		descriptorWrites[0].dstBinding = 0;
+		descriptorWrites[0].descriptorCount = 1;
+		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[0].pBufferInfo = &meshletBufferInfo;
+
+		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[1].dstSet = this->vkDescriptorSets[i];
+		descriptorWrites[1].dstBinding = 1;
+		descriptorWrites[1].descriptorCount = 1;
+		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[1].pBufferInfo = &drawBufferInfo;
+
+		vkUpdateDescriptorSets(this->vkDevice, 2, descriptorWrites, 0, nullptr);
+	}
+
+	const std::vector<VkPushConstantRange> pushConstantRanges = layout.GetPushConstantRanges();
+
+	if (pushConstantRanges.size() != 1 || pushConstantRanges[0].size != sizeof(MeshletCullingConstants))
+	{
+		throw std::runtime_error(shaderPath + " push constants do not match MeshletCullingConstants!");
+	}
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &this->vkDescriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+	if (vkCreatePipelineLayout(this->vkDevice, &pipelineLayoutInfo, nullptr, &this->vkPipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create meshlet culling pipeline layout!");
+	}
+
+	VkShaderModule shaderModule = ShaderExtensions::CreateShaderModule(this->vkDevice, shaderCode);
+
+	VkComputePipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shaderModule;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = this->vkPipelineLayout;
+
+	const VkResult result = vkCreateComputePipelines(this->vkDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->vkPipeline);
+
+	vkDestroyShaderModule(this->vkDevice, shaderModule, nullptr);
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to create meshlet culling pipeline!");
+	}
+}
+
+VulkanCore::MeshletCullingPass::~MeshletCullingPass()
+{
+	vkDestroyPipeline(this->vkDevice, this->vkPipeline, nullptr);
+	vkDestroyPipelineLayout(this->vkDevice, this->vkPipelineLayout, nullptr);
+	vkDestroyDescriptorPool(this->vkDevice, this->vkDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(this->vkDevice, this->vkDescriptorSetLayout, nullptr);
+
+	for (size_t i = 0; i < this->vkDrawBuffers.size(); i++)
+	{
+		vkDestroyBuffer(this->vkDevice, this->vkDrawBuffers[i], nullptr);
+		vkFreeMemory(this->vkDevice, this->vkDrawBuffersMemory[i], nullptr);
+	}
+
+	vkDestroyBuffer(this->vkDevice, this->vkMeshletBuffer, nullptr);
+	vkFreeMemory(this->vkDevice, this->vkMeshletBufferMemory, nullptr);
+}
+
+void VulkanCore::MeshletCullingPass::Record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const MeshletCullingConstants& constants) const
+{
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, this->vkPipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, this->vkPipelineLayout, 0, 1, &this->vkDescriptorSets[frameIndex], 0, nullptr);
+	vkCmdPushConstants(commandBuffer, this->vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+
+	vkCmdDispatch(commandBuffer, (constants.meshletCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = this->vkDrawBuffers[frameIndex];
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+		0,
+		0, nullptr,
+		1, &barrier,
+		0, nullptr);
+}
+
+void VulkanCore::MeshletCullingPass::Draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t firstMeshlet, uint32_t meshletCount) const
+{
+	const VkDeviceSize stride = sizeof(VkDrawIndexedIndirectCommand);
+
+	if (this->MultiDrawIndirect)
+	{
+		vkCmdDrawIndexedIndirect(commandBuffer, this->vkDrawBuffers[frameIndex], firstMeshlet * stride, meshletCount, static_cast<uint32_t>(stride));
+		return;
+	}
+
+	// without multiDrawIndirect every draw reads a single command, culled ones still cost a draw call
+	for (uint32_t i = 0; i < meshletCount; i++)
+	{
+		vkCmdDrawIndexedIndirect(commandBuffer, this->vkDrawBuffers[frameIndex], (firstMeshlet + i) * stride, 1, static_cast<uint32_t>(stride));
+	}
+}
@@ -0,0 +1,969 @@
+#include "../../../Public/Infrastructure/Rendering/RenderGraph.hpp"
+#include "../../../Public/Utils/MemoryUtils.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+static const VkAccessFlags WRITE_ACCESS_MASK =
+	VK_ACCESS_SHADER_WRITE_BIT |
+	VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+	VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+	VK_ACCESS_TRANSFER_WRITE_BIT;
+
+VulkanCore::RenderGraph::RenderGraph(VkDevice device, VkPhysicalDevice physicalDevice) :
+	vkDevice(device),
+	vkPhysicalDevice(physicalDevice)
+{
+}
+
+VulkanCore::RenderGraph::~RenderGraph()
+{
+	for (auto& pass : this->Passes)
+	{
+		for (const auto& frameBuffer : pass.frameBuffers)
+		{
+			vkDestroyFramebuffer(this->vkDevice, frameBuffer.second, nullptr);
+		}
+
+		if (pass.renderPass != VK_NULL_HANDLE)
+		{
+			vkDestroyRenderPass(this->vkDevice, pass.renderPass, nullptr);
+		}
+	}
+
+	for (auto& resource : this->Resources)
+	{
+		if (resource.imported)
+		{
+			continue;
+		}
+
+		if (resource.imageView != VK_NULL_HANDLE)
+		{
+			vkDestroyImageView(this->vkDevice, resource.imageView, nullptr);
+		}
+
+		if (resource.image != VK_NULL_HANDLE)
+		{
+			vkDestroyImage(this->vkDevice, resource.image, nullptr);
+		}
+	}
+
+	for (auto& block : this->MemoryBlocks)
+	{
+		vkFreeMemory(this->vkDevice, block.memory, nullptr);
+	}
+}
+
+VulkanCore::RenderGraphResource VulkanCore::RenderGraph::ImportImage(
+	const std::string& name,
+	const RenderGraphImageDescription& description,
+	const RenderGraphImageState& initialState,
+	const RenderGraphImageState& finalState)
+{
+	Resource resource;
+	resource.name = name;
+	resource.description = description;
+	resource.aspectMask = MemoryUtils::GetImageAspectFlags(description.format);
+	resource.imported = true;
+	resource.initialState = initialState;
+	resource.finalState = finalState;
+
+	this->Resources.push_back(resource);
+
+	return static_cast<RenderGraphResource>(this->Resources.size() - 1);
+}
+
+void VulkanCore::RenderGraph::SetImportedImage(RenderGraphResource resource, VkImage image, VkImageView imageView)
+{
+	Resource& importedResource = this->Resources.at(resource);
+
+	if (!importedResource.imported)
+	{
+		throw std::runtime_error("render graph image " + importedResource.name + " is not imported!");
+	}
+
+	importedResource.image = image;
+	importedResource.imageView = imageView;
+}
+
+VulkanCore::RenderGraphResource VulkanCore::RenderGraph::CreateImage(const std::string& name, const RenderGraphImageDescription& description)
+{
+	Resource resource;
+	resource.name = name;
+	resource.description = description;
+	resource.aspectMask = MemoryUtils::GetImageAspectFlags(description.format);
+
+	this->Resources.push_back(resource);
+
+	return static_cast<RenderGraphResource>(this->Resources.size() - 1);
+}
+
+uint32_t VulkanCore::RenderGraph::AddPass(const std::string& name, std::function<void(VkCommandBuffer)> execute)
+{
+	Pass pass;
+	pass.name = name;
+	pass.execute = std::move(execute);
+
+	this->Passes.push_back(std::move(pass));
+
+	return static_cast<uint32_t>(this->Passes.size() - 1);
+}
+
+void VulkanCore::RenderGraph::WriteColorAttachment(uint32_t pass, RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_COLOR_ATTACHMENT;
+	usage.write = true;
+	usage.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	usage.stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	usage.accessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	usage.loadOp = loadOp;
+	usage.clearValue.color = clearColor;
+
+	this->AddUsage(pass, usage);
+}
+
+void VulkanCore::RenderGraph::WriteDepthAttachment(uint32_t pass, RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clearDepth)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_DEPTH_ATTACHMENT;
+	usage.write = true;
+	usage.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	usage.stageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	usage.accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	usage.loadOp = loadOp;
+	usage.clearValue.depthStencil = clearDepth;
+
+	this->AddUsage(pass, usage);
+}
+
+void VulkanCore::RenderGraph::ResolveAttachment(uint32_t pass, RenderGraphResource source, RenderGraphResource destination)
+{
+	const auto& usages = this->Passes.at(pass).usages;
+
+	const bool sourceIsColorAttachment = std::any_of(usages.begin(), usages.end(), [source](const ResourceUsage& usage) {
+		return usage.resource == source && usage.type == USAGE_COLOR_ATTACHMENT;
+	});
+
+	if (!sourceIsColorAttachment)
+	{
+		throw std::runtime_error("pass " + this->Passes[pass].name + " resolves an image it does not render to!");
+	}
+
+	const RenderGraphImageDescription& sourceDescription = this->Resources.at(source).description;
+	const RenderGraphImageDescription& destinationDescription = this->Resources.at(destination).description;
+
+	if (sourceDescription.samples == VK_SAMPLE_COUNT_1_BIT
+		|| destinationDescription.samples != VK_SAMPLE_COUNT_1_BIT
+		|| sourceDescription.format != destinationDescription.format)
+	{
+		throw std::runtime_error(
+			"pass " + this->Passes[pass].name + " cannot resolve " + this->Resources[source].name + " into " + this->Resources[destination].name + "!");
+	}
+
+	ResourceUsage usage = {};
+	usage.resource = destination;
+	usage.type = USAGE_RESOLVE_ATTACHMENT;
+	usage.write = true;
+	usage.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	usage.stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	usage.accessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	usage.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	usage.resolveSource = source;
+
+	this->AddUsage(pass, usage);
+}
+
+void VulkanCore::RenderGraph::ReadTexture(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_SAMPLED;
+	usage.write = false;
+	usage.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	usage.stageMask = stageMask;
+	usage.accessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	this->AddUsage(pass, usage);
+}
+
+void VulkanCore::RenderGraph::ReadStorage(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_STORAGE;
+	usage.write = false;
+	usage.layout = VK_IMAGE_LAYOUT_GENERAL;
+	usage.stageMask = stageMask;
+	usage.accessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	this->AddUsage(pass, usage);
+}
+
+void VulkanCore::RenderGraph::WriteStorage(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_STORAGE;
+	usage.write = true;
+	usage.layout = VK_IMAGE_LAYOUT_GENERAL;
+	usage.stageMask = stageMask;
+	usage.accessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+	this->AddUsage(pass, usage);
+}
+
+// in place modification, the earlier contents are kept
+void VulkanCore::RenderGraph::ReadWriteStorage(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_STORAGE;
+	usage.write = true;
+	usage.layout = VK_IMAGE_LAYOUT_GENERAL;
+	usage.stageMask = stageMask;
+	usage.accessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	usage.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+
+	this->AddUsage(pass, usage);
+}
+
+void VulkanCore::RenderGraph::ReadTransfer(uint32_t pass, RenderGraphResource resource)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_TRANSFER_SRC;
+	usage.write = false;
+	usage.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	usage.stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	usage.accessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	this->AddUsage(pass, usage);
+}
+
+void VulkanCore::RenderGraph::WriteTransfer(uint32_t pass, RenderGraphResource resource)
+{
+	ResourceUsage usage = {};
+	usage.resource = resource;
+	usage.type = USAGE_TRANSFER_DST;
+	usage.write = true;
+	usage.layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	usage.stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	usage.accessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	this->AddUsage(pass, usage);
+}
+
+bool VulkanCore::RenderGraph::IsAttachment(const ResourceUsage& usage)
+{
+	return usage.type == USAGE_COLOR_ATTACHMENT || usage.type == USAGE_DEPTH_ATTACHMENT || usage.type == USAGE_RESOLVE_ATTACHMENT;
+}
+
+void VulkanCore::RenderGraph::AddUsage(uint32_t pass, const ResourceUsage& usage)
+{
+	if (this->IsCompiled)
+	{
+		throw std::runtime_error("render graph is already compiled!");
+	}
+
+	if (usage.resource >= this->Resources.size())
+	{
+		throw std::runtime_error("unknown render graph resource used by pass " + this->Passes.at(pass).name);
+	}
+
+	// a pass uses every image once, a single layout has to cover all of its accesses
+	for (const auto& existingUsage : this->Passes.at(pass).usages)
+	{
+		if (existingUsage.resource == usage.resource)
+		{
+			throw std::runtime_error(
+				"pass " + this->Passes[pass].name + " uses " + this->Resources[usage.resource].name + " more than once!");
+		}
+	}
+
+	this->Passes[pass].usages.push_back(usage);
+}
+
+void VulkanCore::RenderGraph::Compile()
+{
+	if (this->IsCompiled)
+	{
+		return;
+	}
+
+	this->CullPasses();
+	this->AllocateTransientImages();
+
+	for (uint32_t passIndex = 0; passIndex < this->Passes.size(); ++passIndex)
+	{
+		if (!this->Passes[passIndex].culled)
+		{
+			this->CreateRenderPass(this->Passes[passIndex], passIndex);
+		}
+	}
+
+	this->IsCompiled = true;
+
+	if (this->GetCulledPassCount() > 0)
+	{
+		std::cout << "render graph: culled " << this->GetCulledPassCount() << " of " << this->Passes.size() << " passes" << std::endl;
+	}
+}
+
+void VulkanCore::RenderGraph::CullPasses()
+{
+	// imported images are the graph outputs, walking backwards keeps only passes they depend on
+	std::vector<bool> required(this->Resources.size(), false);
+
+	for (size_t i = 0; i < this->Resources.size(); ++i)
+	{
+		required[i] = this->Resources[i].imported;
+	}
+
+	for (size_t passIndex = this->Passes.size(); passIndex-- > 0;)
+	{
+		Pass& pass = this->Passes[passIndex];
+
+		pass.culled = std::none_of(pass.usages.begin(), pass.usages.end(), [&required](const ResourceUsage& usage) {
+			return usage.write && required[usage.resource];
+		});
+
+		if (pass.culled)
+		{
+			continue;
+		}
+
+		for (const auto& usage : pass.usages)
+		{
+			if (!usage.write || usage.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+			{
+				required[usage.resource] = true;
+			}
+		}
+	}
+}
+
+void VulkanCore::RenderGraph::AllocateTransientImages()
+{
+	std::vector<VkImageUsageFlags> usageFlags(this->Resources.size(), 0);
+
+	for (uint32_t passIndex = 0; passIndex < this->Passes.size(); ++passIndex)
+	{
+		if (this->Passes[passIndex].culled)
+		{
+			continue;
+		}
+
+		for (const auto& usage : this->Passes[passIndex].usages)
+		{
+			Resource& resource = this->Resources[usage.resource];
+			resource.firstPass = std::min(resource.firstPass, passIndex);
+			resource.lastPass = std::max(resource.lastPass, passIndex);
+
+			switch (usage.type)
+			{
+			case USAGE_COLOR_ATTACHMENT:
+			case USAGE_RESOLVE_ATTACHMENT: usageFlags[usage.resource] |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; break;
+			case USAGE_DEPTH_ATTACHMENT: usageFlags[usage.resource] |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT; break;
+			case USAGE_SAMPLED: usageFlags[usage.resource] |= VK_IMAGE_USAGE_SAMPLED_BIT; break;
+			case USAGE_STORAGE: usageFlags[usage.resource] |= VK_IMAGE_USAGE_STORAGE_BIT; break;
+			case USAGE_TRANSFER_SRC: usageFlags[usage.resource] |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT; break;
+			case USAGE_TRANSFER_DST: usageFlags[usage.resource] |= VK_IMAGE_USAGE_TRANSFER_DST_BIT; break;
+			}
+		}
+	}
+
+	std::vector<RenderGraphResource> transientResources;
+	std::vector<VkMemoryRequirements> requirements(this->Resources.size());
+
+	for (RenderGraphResource i = 0; i < this->Resources.size(); ++i)
+	{
+		Resource& resource = this->Resources[i];
+
+		if (resource.imported || usageFlags[i] == 0)
+		{
+			continue;
+		}
+
+		// images only ever used as attachments never need to leave tile memory
+		const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		if ((usageFlags[i] & ~attachmentUsage) == 0)
+		{
+			usageFlags[i] |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+			resource.transientAttachment = true;
+		}
+
+		VkImageCreateInfo imageInfo = {};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = { resource.description.extent.width, resource.description.extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = resource.description.format;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = usageFlags[i];
+		imageInfo.samples = resource.description.samples;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateImage(this->vkDevice, &imageInfo, nullptr, &resource.image) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create render graph image " + resource.name + "!");
+		}
+
+		vkGetImageMemoryRequirements(this->vkDevice, resource.image, &requirements[i]);
+		transientResources.push_back(i);
+	}
+
+	// largest images are placed first, later ones join a block whose images are never alive at the same time
+	std::sort(transientResources.begin(), transientResources.end(), [&requirements](RenderGraphResource a, RenderGraphResource b) {
+		return requirements[a].size > requirements[b].size;
+	});
+
+	for (const RenderGraphResource i : transientResources)
+	{
+		Resource& resource = this->Resources[i];
+
+		for (uint32_t blockIndex = 0; blockIndex < this->MemoryBlocks.size(); ++blockIndex)
+		{
+			MemoryBlock& block = this->MemoryBlocks[blockIndex];
+
+			// lazily allocated memory can only back transient attachments, the two kinds never share a block
+			if ((block.memoryTypeBits & requirements[i].memoryTypeBits) == 0 || block.transientAttachments != resource.transientAttachment)
+			{
+				continue;
+			}
+
+			const bool overlaps = std::any_of(block.resources.begin(), block.resources.end(), [this, &resource](RenderGraphResource other) {
+				return resource.firstPass <= this->Resources[other].lastPass && this->Resources[other].firstPass <= resource.lastPass;
+			});
+
+			if (!overlaps)
+			{
+				resource.memoryBlock = blockIndex;
+				break;
+			}
+		}
+
+		if (resource.memoryBlock == ~0u)
+		{
+			resource.memoryBlock = static_cast<uint32_t>(this->MemoryBlocks.size());
+			this->MemoryBlocks.emplace_back();
+			this->MemoryBlocks.back().transientAttachments = resource.transientAttachment;
+		}
+
+		MemoryBlock& block = this->MemoryBlocks[resource.memoryBlock];
+		block.size = std::max(block.size, requirements[i].size);
+		block.alignment = std::max(block.alignment, requirements[i].alignment);
+		block.memoryTypeBits &= requirements[i].memoryTypeBits;
+		block.resources.push_back(i);
+	}
+
+	for (auto& block : this->MemoryBlocks)
+	{
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = block.size;
+
+		// tilers back transient attachments with on-chip memory only, desktop drivers expose no such type
+		block.lazilyAllocated = block.transientAttachments && MemoryUtils::TryFindMemoryType(
+			block.memoryTypeBits,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+			this->vkPhysicalDevice,
+			allocInfo.memoryTypeIndex);
+
+		if (!block.lazilyAllocated)
+		{
+			allocInfo.memoryTypeIndex = MemoryUtils::FindMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, this->vkPhysicalDevice);
+		}
+
+		if (vkAllocateMemory(this->vkDevice, &allocInfo, nullptr, &block.memory) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate render graph memory!");
+		}
+
+		for (const RenderGraphResource i : block.resources)
+		{
+			Resource& resource = this->Resources[i];
+
+			vkBindImageMemory(this->vkDevice, resource.image, block.memory, 0);
+
+			resource.imageView = GraphicsPipelineUtils::CreateImageView(
+				resource.image,
+				resource.description.format,
+				resource.aspectMask,
+				this->vkDevice);
+		}
+	}
+}
+
+bool VulkanCore::RenderGraph::IsReadAfter(RenderGraphResource resource, uint32_t passIndex) const
+{
+	for (uint32_t laterPass = passIndex + 1; laterPass < this->Passes.size(); ++laterPass)
+	{
+		if (this->Passes[laterPass].culled)
+		{
+			continue;
+		}
+
+		for (const auto& usage : this->Passes[laterPass].usages)
+		{
+			if (usage.resource != resource)
+			{
+				continue;
+			}
+
+			if (!usage.write || usage.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+			{
+				return true;
+			}
+
+			// overwritten before anyone reads it
+			return false;
+		}
+	}
+
+	return false;
+}
+
+void VulkanCore::RenderGraph::CreateRenderPass(Pass& pass, uint32_t passIndex)
+{
+	std::vector<VkAttachmentDescription> attachments;
+	std::vector<VkAttachmentReference> colorAttachmentRefs;
+	std::vector<RenderGraphResource> colorResources;
+	std::map<RenderGraphResource, VkAttachmentReference> resolveAttachmentRefs;
+	VkAttachmentReference depthAttachmentRef = {};
+	bool hasDepthAttachment = false;
+
+	for (const auto& usage : pass.usages)
+	{
+		if (!IsAttachment(usage))
+		{
+			continue;
+		}
+
+		const Resource& resource = this->Resources[usage.resource];
+
+		// contents only survive the pass when the graph still reads them or they leave the graph
+		const bool storeContents = resource.imported || this->IsReadAfter(usage.resource, passIndex);
+
+		VkAttachmentDescription attachment = {};
+		attachment.format = resource.description.format;
+		attachment.samples = resource.description.samples;
+		attachment.loadOp = usage.loadOp;
+		attachment.storeOp = storeContents ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+		// layouts are transitioned by the graph barriers before the pass begins
+		attachment.initialLayout = usage.layout;
+		attachment.finalLayout = usage.layout;
+
+		VkAttachmentReference attachmentRef = {};
+		attachmentRef.attachment = static_cast<uint32_t>(attachments.size());
+		attachmentRef.layout = usage.layout;
+
+		if (usage.type == USAGE_DEPTH_ATTACHMENT)
+		{
+			depthAttachmentRef = attachmentRef;
+			hasDepthAttachment = true;
+		}
+		else if (usage.type == USAGE_RESOLVE_ATTACHMENT)
+		{
+			resolveAttachmentRefs[usage.resolveSource] = attachmentRef;
+		}
+		else
+		{
+			colorAttachmentRefs.push_back(attachmentRef);
+			colorResources.push_back(usage.resource);
+		}
+
+		attachments.push_back(attachment);
+	}
+
+	if (attachments.empty())
+	{
+		return;
+	}
+
+	// resolve attachments line up with the color attachments, unresolved ones are marked unused
+	std::vector<VkAttachmentReference> resolveRefs;
+
+	if (!resolveAttachmentRefs.empty())
+	{
+		for (const RenderGraphResource colorResource : colorResources)
+		{
+			const auto resolve = resolveAttachmentRefs.find(colorResource);
+			resolveRefs.push_back(resolve != resolveAttachmentRefs.end()
+				? resolve->second
+				: VkAttachmentReference{ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+		}
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentRefs.size());
+	subpass.pColorAttachments = colorAttachmentRefs.empty() ? nullptr : colorAttachmentRefs.data();
+	subpass.pResolveAttachments = resolveRefs.empty() ? nullptr : resolveRefs.data();
+	subpass.pDepthStencilAttachment = hasDepthAttachment ? &depthAttachmentRef : nullptr;
+
+	VkRenderPassCreateInfo renderPassInfo = {};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	renderPassInfo.pAttachments = attachments.data();
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+
+	if (vkCreateRenderPass(this->vkDevice, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create render pass for " + pass.name + "!");
+	}
+}
+
+VkFramebuffer VulkanCore::RenderGraph::GetFrameBuffer(Pass& pass, VkExtent2D& extent)
+{
+	std::vector<VkImageView> attachments;
+
+	for (const auto& usage : pass.usages)
+	{
+		if (IsAttachment(usage))
+		{
+			attachments.push_back(this->Resources[usage.resource].imageView);
+			extent = this->Resources[usage.resource].description.extent;
+		}
+	}
+
+	// imported images change between frames, there is one frame buffer per combination seen
+	const auto cached = pass.frameBuffers.find(attachments);
+
+	if (cached != pass.frameBuffers.end())
+	{
+		return cached->second;
+	}
+
+	VkFramebufferCreateInfo frameBufferCreateInfo = {};
+	frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	frameBufferCreateInfo.renderPass = pass.renderPass;
+	frameBufferCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	frameBufferCreateInfo.pAttachments = attachments.data();
+	frameBufferCreateInfo.width = extent.width;
+	frameBufferCreateInfo.height = extent.height;
+	frameBufferCreateInfo.layers = 1;
+
+	VkFramebuffer frameBuffer;
+
+	if (vkCreateFramebuffer(this->vkDevice, &frameBufferCreateInfo, nullptr, &frameBuffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create frame buffer for " + pass.name + "!");
+	}
+
+	pass.frameBuffers[attachments] = frameBuffer;
+
+	return frameBuffer;
+}
+
+void VulkanCore::RenderGraph::AddBarrier(
+	const ResourceUsage& usage,
+	ResourceState& state,
+	std::vector<VkImageMemoryBarrier>& barriers,
+	VkPipelineStageFlags& srcStageMask,
+	VkPipelineStageFlags& dstStageMask)
+{
+	const Resource& resource = this->Resources[usage.resource];
+
+	bool needsBarrier = false;
+	VkImageLayout oldLayout = state.layout;
+	VkPipelineStageFlags waitStages = 0;
+	VkAccessFlags waitAccess = 0;
+
+	if (!state.initialized)
+	{
+		// first use this frame, the previous contents of an aliased block are discarded
+		MemoryBlock& block = this->MemoryBlocks[resource.memoryBlock];
+
+		needsBarrier = true;
+		oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		waitStages = block.stageMask;
+		waitAccess = block.accessMask;
+
+		block.stageMask = 0;
+		block.accessMask = 0;
+	}
+	else if (state.layout != usage.layout || usage.write)
+	{
+		// layout transitions and writes wait for every earlier access, reads only for the last write
+		waitStages = state.modifyStages | state.readStages;
+		waitAccess = state.modifyAccess;
+		needsBarrier = state.layout != usage.layout || waitStages != 0;
+	}
+	else if ((usage.stageMask & ~state.readStages) != 0 && state.modifyStages != 0)
+	{
+		waitStages = state.modifyStages;
+		waitAccess = state.modifyAccess;
+		needsBarrier = true;
+	}
+
+	if (needsBarrier)
+	{
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = usage.layout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = resource.image;
+		barrier.subresourceRange.aspectMask = resource.aspectMask;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcAccessMask = waitAccess & WRITE_ACCESS_MASK;
+		barrier.dstAccessMask = usage.accessMask;
+
+		barriers.push_back(barrier);
+
+		srcStageMask |= waitStages;
+		dstStageMask |= usage.stageMask;
+	}
+
+	const bool transitioned = needsBarrier && oldLayout != usage.layout;
+
+	if (usage.write)
+	{
+		state.modifyStages = usage.stageMask;
+		state.modifyAccess = usage.accessMask;
+		state.readStages = 0;
+	}
+	else if (transitioned)
+	{
+		// the transition is a write of its own, later reads chain onto the stages it finished before
+		state.modifyStages = usage.stageMask;
+		state.modifyAccess = 0;
+		state.readStages = usage.stageMask;
+	}
+	else
+	{
+		state.readStages |= usage.stageMask;
+	}
+
+	state.layout = usage.layout;
+	state.initialized = true;
+
+	if (!resource.imported)
+	{
+		MemoryBlock& block = this->MemoryBlocks[resource.memoryBlock];
+		block.stageMask |= usage.stageMask;
+		block.accessMask |= usage.accessMask & WRITE_ACCESS_MASK;
+	}
+}
+
+void VulkanCore::RenderGraph::Execute(VkCommandBuffer commandBuffer, GpuProfiler* profiler)
+{
+	if (!this->IsCompiled)
+	{
+		throw std::runtime_error("render graph has to be compiled before it is executed!");
+	}
+
+	std::vector<ResourceState> states(this->Resources.size());
+
+	for (size_t i = 0; i < this->Resources.size(); ++i)
+	{
+		const Resource& resource = this->Resources[i];
+
+		if (!resource.imported)
+		{
+			continue;
+		}
+
+		if (resource.image == VK_NULL_HANDLE)
+		{
+			throw std::runtime_error("render graph image " + resource.name + " is not bound!");
+		}
+
+		states[i].layout = resource.initialState.layout;
+		states[i].modifyStages = resource.initialState.stageMask;
+		states[i].modifyAccess = resource.initialState.accessMask;
+		states[i].initialized = true;
+	}
+
+	std::vector<VkImageMemoryBarrier> barriers;
+
+	for (auto& pass : this->Passes)
+	{
+		if (pass.culled)
+		{
+			continue;
+		}
+
+		const uint32_t scope = profiler != nullptr ? profiler->BeginScope(commandBuffer, pass.name) : GpuProfiler::INVALID_SCOPE;
+
+		VkPipelineStageFlags srcStageMask = 0;
+		VkPipelineStageFlags dstStageMask = 0;
+		barriers.clear();
+
+		for (const auto& usage : pass.usages)
+		{
+			this->AddBarrier(usage, states[usage.resource], barriers, srcStageMask, dstStageMask);
+		}
+
+		if (!barriers.empty())
+		{
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				srcStageMask != 0 ? srcStageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+				dstStageMask,
+				0,
+				0, nullptr,
+				0, nullptr,
+				static_cast<uint32_t>(barriers.size()), barriers.data());
+		}
+
+		if (pass.renderPass != VK_NULL_HANDLE)
+		{
+			VkExtent2D extent = {};
+			std::vector<VkClearValue> clearValues;
+
+			for (const auto& usage : pass.usages)
+			{
+				if (IsAttachment(usage))
+				{
+					clearValues.push_back(usage.clearValue);
+				}
+			}
+
+			VkRenderPassBeginInfo renderPassInfo = {};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = pass.renderPass;
+			renderPassInfo.framebuffer = this->GetFrameBuffer(pass, extent);
+			renderPassInfo.renderArea.offset = { 0, 0 };
+			renderPassInfo.renderArea.extent = extent;
+			renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+			renderPassInfo.pClearValues = clearValues.data();
+
+			vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			pass.execute(commandBuffer);
+
+			vkCmdEndRenderPass(commandBuffer);
+		}
+		else
+		{
+			pass.execute(commandBuffer);
+		}
+
+		if (profiler != nullptr)
+		{
+			profiler->EndScope(commandBuffer, scope);
+		}
+	}
+
+	// imported images leave the graph in the state their owner expects
+	VkPipelineStageFlags srcStageMask = 0;
+	VkPipelineStageFlags dstStageMask = 0;
+	barriers.clear();
+
+	for (size_t i = 0; i < this->Resources.size(); ++i)
+	{
+		const Resource& resource = this->Resources[i];
+		const ResourceState& state = states[i];
+
+		if (!resource.imported)
+		{
+			continue;
+		}
+
+		const VkPipelineStageFlags waitStages = state.modifyStages | state.readStages;
+
+		if (state.layout == resource.finalState.layout && (state.modifyAccess == 0 || resource.finalState.accessMask == 0))
+		{
+			continue;
+		}
+
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = state.layout;
+		barrier.newLayout = resource.finalState.layout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = resource.image;
+		barrier.subresourceRange.aspectMask = resource.aspectMask;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcAccessMask = state.modifyAccess & WRITE_ACCESS_MASK;
+		barrier.dstAccessMask = resource.finalState.accessMask;
+
+		barriers.push_back(barrier);
+
+		srcStageMask |= waitStages;
+		dstStageMask |= resource.finalState.stageMask;
+	}
+
+	if (!barriers.empty())
+	{
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			srcStageMask != 0 ? srcStageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			dstStageMask != 0 ? dstStageMask : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data());
+	}
+}
+
+VkRenderPass VulkanCore::RenderGraph::GetRenderPass(uint32_t pass) const
+{
+	return this->Passes.at(pass).renderPass;
+}
+
+VkImage VulkanCore::RenderGraph::GetImage(RenderGraphResource resource) const
+{
+	return this->Resources.at(resource).image;
+}
+
+VkImageView VulkanCore::RenderGraph::GetImageView(RenderGraphResource resource) const
+{
+	return this->Resources.at(resource).imageView;
+}
+
+bool VulkanCore::RenderGraph::IsPassCulled(uint32_t pass) const
+{
+	return this->Passes.at(pass).culled;
+}
+
+uint32_t VulkanCore::RenderGraph::GetCulledPassCount() const
+{
+	return static_cast<uint32_t>(std::count_if(this->Passes.begin(), this->Passes.end(), [](const Pass& pass) {
+		return pass.culled;
+	}));
+}
+
+VkDeviceSize VulkanCore::RenderGraph::GetTransientMemorySize() const
+{
+	VkDeviceSize size = 0;
+
+	for (const auto& block : this->MemoryBlocks)
+	{
+		size += block.size;
+	}
+
+	return size;
+}
+
+VkDeviceSize VulkanCore::RenderGraph::GetLazilyAllocatedMemorySize() const
+{
+	VkDeviceSize size = 0;
+
+	for (const auto& block : this->MemoryBlocks)
+	{
+		if (block.lazilyAllocated)
+		{
+			size += block.size;
+		}
+	}
+
+	return size;
+}
@@ -0,0 +1,269 @@
+#include "../../../Public/Infrastructure/Rendering/WorleyNoisePass.hpp"
+#include "../../../Public/Infrastructure/Shaders/ShaderReflection.hpp"
+#include "../../../Public/Utils/IOUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	float Fract(float value)
+	{
+		return value - std::floor(value);
+	}
+
+	float Mix(float a, float b, float t)
+	{
+		return a * (1.0f - t) + b * t;
+	}
+
+	void GetFeaturePoint(float cellX, float cellY, const VulkanCore::WorleyNoiseConstants& constants, float& pointX, float& pointY)
+	{
+		const float f1 = VulkanCore::WorleyNoise::Random(cellX, cellY);
+		const float f2 = VulkanCore::WorleyNoise::Random(cellX + 1.0f, cellY + 81.0f);
+
+		pointX = cellX + Mix(f1, f2, constants.phase[0]);
+		pointY = cellY + Mix(f1, f2, constants.phase[1]);
+	}
+}
+
+VulkanCore::WorleyNoiseConstants VulkanCore::WorleyNoise::GetConstants(const WorleyNoiseParameters& parameters, float time)
+{
+	if (parameters.cellSize < static_cast<float>(TILE_SIZE))
+	{
+		throw std::invalid_argument("worley noise cells have to be at least one tile wide!");
+	}
+
+	WorleyNoiseConstants constants;
+	constants.phase[0] = std::sin(time * parameters.timeSpeed);
+	constants.phase[1] = std::cos(time * parameters.timeSpeed);
+	constants.inverseCellSize = 1.0f / parameters.cellSize;
+
+	return constants;
+}
+
+float VulkanCore::WorleyNoise::Random(float x, float y)
+{
+	return Fract(std::sin(Fract(std::sin(x)) + y) * 142.17563f);
+}
+
+void VulkanCore::WorleyNoise::RenderNaive(uint32_t width, uint32_t height, const WorleyNoiseConstants& constants, std::vector<float>& distances)
+{
+	distances.resize(static_cast<size_t>(width) * height);
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const float px = (static_cast<float>(x) + 0.5f) * constants.inverseCellSize;
+			const float py = (static_cast<float>(y) + 0.5f) * constants.inverseCellSize;
+
+			float d = 10.0f;
+
+			for (int yo = -1; yo <= 1; ++yo)
+			{
+				for (int xo = -1; xo <= 1; ++xo)
+				{
+					float pointX, pointY;
+					GetFeaturePoint(std::floor(px) + xo, std::floor(py) + yo, constants, pointX, pointY);
+
+					const float dx = px - pointX;
+					const float dy = py - pointY;
+					d = std::min(d, dx * dx + dy * dy);
+				}
+			}
+
+			distances[static_cast<size_t>(y) * width + x] = d;
+		}
+	}
+}
+
+void VulkanCore::WorleyNoise::RenderTiled(uint32_t width, uint32_t height, const WorleyNoiseConstants& constants, std::vector<float>& distances)
+{
+	distances.resize(static_cast<size_t>(width) * height);
+
+	float pointsX[TILE_CELLS * TILE_CELLS];
+	float pointsY[TILE_CELLS * TILE_CELLS];
+
+	for (uint32_t tileY = 0; tileY < height; tileY += TILE_SIZE)
+	{
+		for (uint32_t tileX = 0; tileX < width; tileX += TILE_SIZE)
+		{
+			// the workgroup prologue, one feature point per cell the tile searches
+			const float firstCellX = std::floor((static_cast<float>(tileX) + 0.5f) * constants.inverseCellSize) - 1.0f;
+			const float firstCellY = std::floor((static_cast<float>(tileY) + 0.5f) * constants.inverseCellSize) - 1.0f;
+
+			for (uint32_t i = 0; i < TILE_CELLS * TILE_CELLS; ++i)
+			{
+				GetFeaturePoint(firstCellX + i % TILE_CELLS, firstCellY + i / TILE_CELLS, constants, pointsX[i], pointsY[i]);
+			}
+
+			const uint32_t endX = std::min(tileX + TILE_SIZE, width);
+			const uint32_t endY = std::min(tileY + TILE_SIZE, height);
+
+			for (uint32_t y = tileY; y < endY; ++y)
+			{
+				for (uint32_t x = tileX; x < endX; ++x)
+				{
+					const float px = (static_cast<float>(x) + 0.5f) * constants.inverseCellSize;
+					const float py = (static_cast<float>(y) + 0.5f) * constants.inverseCellSize;
+					const int localX = static_cast<int>(std::floor(px) - firstCellX);
+					const int localY = static_cast<int>(std::floor(py) - firstCellY);
+
+					float d = 10.0f;
+
+					for (int yo = -1; yo <= 1; ++yo)
+					{
+						for (int xo = -1; xo <= 1; ++xo)
+						{
+							const int point = (localY + yo) * static_cast<int>(TILE_CELLS) + localX + xo;
+
+							const float dx = px - pointsX[point];
+							const float dy = py - pointsY[point];
+							d = std::min(d, dx * dx + dy * dy);
+						}
+					}
+
+					distances[static_cast<size_t>(y) * width + x] = d;
+				}
+			}
+		}
+	}
+}
+
+void VulkanCore::WorleyNoise::GetColor(float distance, float color[3])
+{
+	const float t = std::pow(distance, 7.0f);
+
+	color[0] = std::sqrt(t * 12.0f);
+	color[1] = std::sqrt(t * 25.0f);
+	color[2] = std::sqrt(t * 10.0f);
+}
+
+VulkanCore::WorleyNoisePass::WorleyNoisePass(VkDevice device, const std::string& shaderPath, const WorleyNoiseParameters& parameters) :
+	vkDevice(device),
+	Parameters(parameters)
+{
+	// validates the parameters once instead of every frame
+	WorleyNoise::GetConstants(this->Parameters, 0.0f);
+
+	const std::vector<uint32_t> shaderCode = ShaderExtensions::ReadSpirvFile(shaderPath);
+	const ShaderReflectionData layout = ShaderReflection::Reflect(shaderCode, shaderPath);
+
+	if (layout.stageFlags != VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		throw std::runtime_error(shaderPath + " is not a compute shader!");
+	}
+
+	const std::vector<VkDescriptorSetLayoutBinding> bindings = layout.GetDescriptorSetLayoutBindings(0);
+
+	if (bindings.size() != 1 || bindings[0].descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+	{
+		throw std::runtime_error(shaderPath + " has to declare exactly one storage image!");
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(this->vkDevice, &layoutInfo, nullptr, &this->vkDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create worley noise descriptor set layout!");
+	}
+
+	VkDescriptorPoolSize poolSize = {};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	poolSize.descriptorCount = 1;
+
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = 1;
+
+	if (vkCreateDescriptorPool(this->vkDevice, &poolInfo, nullptr, &this->vkDescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create worley noise descriptor pool!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = this->vkDescriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &this->vkDescriptorSetLayout;
+
+	if (vkAllocateDescriptorSets(this->vkDevice, &allocInfo, &this->vkDescriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate worley noise descriptor set!");
+	}
+
+	const std::vector<VkPushConstantRange> pushConstantRanges = layout.GetPushConstantRanges();
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &this->vkDescriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.empty() ? nullptr : pushConstantRanges.data();
+
+	if (vkCreatePipelineLayout(this->vkDevice, &pipelineLayoutInfo, nullptr, &this->vkPipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create worley noise pipeline layout!");
+	}
+
+	VkShaderModule shaderModule = ShaderExtensions::CreateShaderModule(this->vkDevice, shaderCode);
+
+	VkComputePipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shaderModule;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = this->vkPipelineLayout;
+
+	const VkResult result = vkCreateComputePipelines(this->vkDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->vkPipeline);
+
+	vkDestroyShaderModule(this->vkDevice, shaderModule, nullptr);
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to create worley noise pipeline!");
+	}
+}
+
+VulkanCore::WorleyNoisePass::~WorleyNoisePass()
+{
+	vkDestroyPipeline(this->vkDevice, this->vkPipeline, nullptr);
+	vkDestroyPipelineLayout(this->vkDevice, this->vkPipelineLayout, nullptr);
+	vkDestroyDescriptorPool(this->vkDevice, this->vkDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(this->vkDevice, this->vkDescriptorSetLayout, nullptr);
+}
+
+void VulkanCore::WorleyNoisePass::SetTarget(VkImageView imageView)
+{
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.imageView = imageView;
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+	VkWriteDescriptorSet descriptorWrite = {};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = this->vkDescriptorSet;
+	descriptorWrite.dstBinding = 0;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	descriptorWrite.pImageInfo = &imageInfo;
+
+	vkUpdateDescriptorSets(this->vkDevice, 1, &descriptorWrite, 0, nullptr);
+}
+
+void VulkanCore::WorleyNoisePass::Record(VkCommandBuffer commandBuffer, VkExtent2D extent, float time) const
+{
+	const WorleyNoiseConstants constants = WorleyNoise::GetConstants(this->Parameters, time);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, this->vkPipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, this->vkPipelineLayout, 0, 1, &this->vkDescriptorSet, 0, nullptr);
+	vkCmdPushConstants(commandBuffer, this->vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+
+	vkCmdDispatch(
+		commandBuffer,
+		(extent.width + WorleyNoise::TILE_SIZE - 1) / WorleyNoise::TILE_SIZE,
+		(extent.height + WorleyNoise::TILE_SIZE - 1) / WorleyNoise::TILE_SIZE,
+		1);
+}
@@ -0,0 +1,304 @@
+#include "../../../Public/Infrastructure/Scene/SceneCompiler.hpp"
+#include "../../../Public/Infrastructure/Scene/SceneFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+	// every string is stored once, offset 0 is the empty string
+	class StringTable
+	{
+	public:
+		StringTable()
+		{
+			this->Add("");
+		}
+
+		uint32_t Add(const std::string& value)
+		{
+			const auto existing = this->Offsets.find(value);
+
+			if (existing != this->Offsets.end())
+			{
+				return existing->second;
+			}
+
+			const uint32_t offset = static_cast<uint32_t>(this->Data.size());
+			this->Data.insert(this->Data.end(), value.begin(), value.end());
+			this->Data.push_back('\0');
+			this->Offsets.emplace(value, offset);
+
+			return offset;
+		}
+
+		const std::vector<char>& GetData() const
+		{
+			return this->Data;
+		}
+
+	private:
+		std::vector<char> Data;
+		std::unordered_map<std::string, uint32_t> Offsets;
+	};
+
+	std::unordered_map<std::string, uint32_t> IndexNames(const nlohmann::json& elements, const char* kind)
+	{
+		std::unordered_map<std::string, uint32_t> indices;
+
+		for (size_t i = 0; i < elements.size(); i++)
+		{
+			const std::string name = elements[i].at("name").get<std::string>();
+
+			if (!indices.emplace(name, static_cast<uint32_t>(i)).second)
+			{
+				throw std::runtime_error(std::string("duplicate ") + kind + " name " + name);
+			}
+		}
+
+		return indices;
+	}
+
+	uint32_t FindName(const nlohmann::json& element, const char* key, const std::unordered_map<std::string, uint32_t>& indices)
+	{
+		if (!element.contains(key) || element[key].is_null())
+		{
+			return VulkanCore::SceneFile::NO_INDEX;
+		}
+
+		const std::string name = element[key].get<std::string>();
+		const auto index = indices.find(name);
+
+		if (index == indices.end())
+		{
+			throw std::runtime_error(std::string("unknown ") + key + " " + name);
+		}
+
+		return index->second;
+	}
+
+	template<size_t N>
+	void ReadFloats(const nlohmann::json& element, const char* key, float (&values)[N])
+	{
+		if (!element.contains(key))
+		{
+			return;
+		}
+
+		const nlohmann::json& value = element[key];
+
+		// a single number sets every component, handy for uniform scale
+		if (value.is_number())
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				values[i] = value.get<float>();
+			}
+
+			return;
+		}
+
+		if (!value.is_array() || value.size() != N)
+		{
+			throw std::runtime_error(std::string(key) + " needs " + std::to_string(N) + " components");
+		}
+
+		for (size_t i = 0; i < N; i++)
+		{
+			values[i] = value[i].get<float>();
+		}
+	}
+
+	uint32_t AlignSection(uint32_t offset)
+	{
+		return (offset + VulkanCore::SceneFile::SECTION_ALIGNMENT - 1) / VulkanCore::SceneFile::SECTION_ALIGNMENT * VulkanCore::SceneFile::SECTION_ALIGNMENT;
+	}
+
+	template<typename T>
+	void WriteSection(std::vector<uint8_t>& binary, uint32_t offset, const std::vector<T>& elements)
+	{
+		if (!elements.empty())
+		{
+			std::memcpy(binary.data() + offset, elements.data(), elements.size() * sizeof(T));
+		}
+	}
+}
+
+void VulkanCore::SceneCompiler::Compile(const nlohmann::json& scene, std::vector<uint8_t>& binary)
+{
+	StringTable strings;
+	std::vector<SceneFileTexture> textures;
+	std::vector<SceneFileMaterial> materials;
+	std::vector<SceneFileMesh> meshes;
+	std::vector<SceneFileNode> nodes;
+
+	try
+	{
+		const nlohmann::json textureElements = scene.value("textures", nlohmann::json::array());
+		const nlohmann::json materialElements = scene.value("materials", nlohmann::json::array());
+		const nlohmann::json meshElements = scene.value("meshes", nlohmann::json::array());
+		const nlohmann::json nodeElements = scene.value("nodes", nlohmann::json::array());
+
+		const auto textureIndices = IndexNames(textureElements, "texture");
+		const auto materialIndices = IndexNames(materialElements, "material");
+		const auto meshIndices = IndexNames(meshElements, "mesh");
+		const auto nodeIndices = IndexNames(nodeElements, "node");
+
+		for (const auto& element : textureElements)
+		{
+			SceneFileTexture texture = {};
+			texture.name = strings.Add(element.at("name").get<std::string>());
+			texture.path = strings.Add(element.at("path").get<std::string>());
+			textures.push_back(texture);
+		}
+
+		for (const auto& element : materialElements)
+		{
+			SceneFileMaterial material = {};
+			material.name = strings.Add(element.at("name").get<std::string>());
+			std::fill(material.baseColorFactor, material.baseColorFactor + 4, 1.0f);
+			ReadFloats(element, "baseColor", material.baseColorFactor);
+			material.baseColorTexture = FindName(element, "baseColorTexture", textureIndices);
+			materials.push_back(material);
+		}
+
+		for (const auto& element : meshElements)
+		{
+			SceneFileMesh mesh = {};
+			mesh.name = strings.Add(element.at("name").get<std::string>());
+			mesh.path = strings.Add(element.at("path").get<std::string>());
+			meshes.push_back(mesh);
+		}
+
+		// authoring order is free, the binary keeps parents ahead of children
+		std::vector<SceneNodeId> parents;
+
+		for (const auto& element : nodeElements)
+		{
+			const uint32_t parent = FindName(element, "parent", nodeIndices);
+			const SceneNodeId sceneParent = parent != SceneFile::NO_INDEX ? parent : SceneGraph::NO_PARENT;
+			parents.push_back(sceneParent);
+		}
+
+		const std::vector<SceneNodeId> order = SceneGraph::SortParentsFirst(parents);
+		std::vector<uint32_t> remap(order.size());
+
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			remap[order[i]] = static_cast<uint32_t>(i);
+		}
+
+		for (const auto index : order)
+		{
+			const nlohmann::json& element = nodeElements[index];
+
+			SceneFileNode node = {};
+			node.name = strings.Add(element.at("name").get<std::string>());
+			node.parent = parents[index] != SceneGraph::NO_PARENT ? remap[parents[index]] : SceneFile::NO_INDEX;
+			node.rotation[3] = 1.0f;
+			std::fill(node.scale, node.scale + 3, 1.0f);
+			ReadFloats(element, "translation", node.translation);
+			ReadFloats(element, "rotation", node.rotation);
+			ReadFloats(element, "scale", node.scale);
+			node.mesh = FindName(element, "mesh", meshIndices);
+			node.material = FindName(element, "material", materialIndices);
+			nodes.push_back(node);
+		}
+	}
+	catch (const nlohmann::json::exception& e)
+	{
+		throw std::runtime_error(std::string("invalid scene: ") + e.what());
+	}
+	catch (const std::invalid_argument& e)
+	{
+		throw std::runtime_error(std::string("invalid scene: ") + e.what());
+	}
+
+	SceneFileHeader header = {};
+	header.magic = SceneFile::FILE_MAGIC;
+	header.version = SceneFile::FILE_VERSION;
+	header.nodeCount = static_cast<uint32_t>(nodes.size());
+	header.meshCount = static_cast<uint32_t>(meshes.size());
+	header.materialCount = static_cast<uint32_t>(materials.size());
+	header.textureCount = static_cast<uint32_t>(textures.size());
+	header.stringsSize = static_cast<uint32_t>(strings.GetData().size());
+
+	header.nodesOffset = AlignSection(sizeof(SceneFileHeader));
+	header.meshesOffset = AlignSection(header.nodesOffset + header.nodeCount * static_cast<uint32_t>(sizeof(SceneFileNode)));
+	header.materialsOffset = AlignSection(header.meshesOffset + header.meshCount * static_cast<uint32_t>(sizeof(SceneFileMesh)));
+	header.texturesOffset = AlignSection(header.materialsOffset + header.materialCount * static_cast<uint32_t>(sizeof(SceneFileMaterial)));
+	header.stringsOffset = AlignSection(header.texturesOffset + header.textureCount * static_cast<uint32_t>(sizeof(SceneFileTexture)));
+	header.fileSize = header.stringsOffset + header.stringsSize;
+
+	// padding between sections stays zeroed
+	binary.assign(header.fileSize, 0);
+	std::memcpy(binary.data(), &header, sizeof(header));
+	WriteSection(binary, header.nodesOffset, nodes);
+	WriteSection(binary, header.meshesOffset, meshes);
+	WriteSection(binary, header.materialsOffset, materials);
+	WriteSection(binary, header.texturesOffset, textures);
+	WriteSection(binary, header.stringsOffset, strings.GetData());
+}
+
+void VulkanCore::SceneCompiler::CompileFile(const std::string& scenePath, const std::string& outputPath)
+{
+	std::ifstream sceneFile(scenePath);
+
+	if (!sceneFile.is_open())
+	{
+		throw std::runtime_error("failed to open scene " + scenePath);
+	}
+
+	nlohmann::json scene;
+
+	try
+	{
+		sceneFile >> scene;
+	}
+	catch (const nlohmann::json::exception& e)
+	{
+		throw std::runtime_error(scenePath + ": " + e.what());
+	}
+
+	std::vector<uint8_t> binary;
+	Compile(scene, binary);
+
+	// written next to the destination first, a reader never maps a partial file
+	const std::string temporaryPath = outputPath + ".new";
+
+	{
+		std::ofstream outputFile(temporaryPath, std::ios::binary | std::ios::trunc);
+
+		if (!outputFile.is_open())
+		{
+			throw std::runtime_error("failed to write compiled scene " + outputPath);
+		}
+
+		outputFile.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+
+		if (!outputFile)
+		{
+			outputFile.close();
+			std::remove(temporaryPath.c_str());
+			throw std::runtime_error("failed to write compiled scene " + outputPath);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, outputPath, error);
+
+	if (error)
+	{
+		std::remove(temporaryPath.c_str());
+		throw std::runtime_error("failed to write compiled scene " + outputPath);
+	}
+}
+
+std::string VulkanCore::SceneCompiler::GetCompiledPath(const std::string& scenePath)
+{
+	return std::filesystem::path(scenePath).replace_extension(".scn").string();
+}
@@ -0,0 +1,299 @@
+#include "../../../Public/Infrastructure/Scene/SceneFile.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char* VulkanCore::SceneFile::PATH_VARIABLE = "VK_RENDER_SCENE";
+
+static void ValidateSection(const VulkanCore::SceneFileHeader& header, uint32_t offset, uint32_t count, size_t elementSize, const char* name)
+{
+	if (offset % VulkanCore::SceneFile::SECTION_ALIGNMENT != 0 ||
+		static_cast<uint64_t>(offset) + static_cast<uint64_t>(count) * elementSize > header.fileSize)
+	{
+		throw std::runtime_error(std::string("scene ") + name + " section is out of bounds!");
+	}
+}
+
+static void ValidateReference(uint32_t reference, uint32_t count, bool optional, const char* name, uint32_t element)
+{
+	if (reference >= count && !(optional && reference == VulkanCore::SceneFile::NO_INDEX))
+	{
+		throw std::runtime_error(std::string("scene ") + name + " reference of element " + std::to_string(element) + " is out of range!");
+	}
+}
+
+VulkanCore::SceneFile::SceneFile(const std::string& path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("failed to open scene " + path);
+	}
+
+	this->FileHandle = file;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(SceneFileHeader)))
+	{
+		this->Unmap();
+		throw std::runtime_error(path + " is not a compiled scene!");
+	}
+
+	this->MappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = this->MappingHandle != nullptr ? MapViewOfFile(this->MappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	if (view == nullptr)
+	{
+		this->Unmap();
+		throw std::runtime_error("failed to map scene " + path);
+	}
+
+	this->Data = static_cast<const uint8_t*>(view);
+	this->Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int file = open(path.c_str(), O_RDONLY);
+
+	if (file < 0)
+	{
+		throw std::runtime_error("failed to open scene " + path);
+	}
+
+	struct stat fileStatus;
+
+	if (fstat(file, &fileStatus) != 0 || fileStatus.st_size < static_cast<off_t>(sizeof(SceneFileHeader)))
+	{
+		close(file);
+		throw std::runtime_error(path + " is not a compiled scene!");
+	}
+
+	// the mapping keeps the file alive on its own
+	void* view = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (view == MAP_FAILED)
+	{
+		throw std::runtime_error("failed to map scene " + path);
+	}
+
+	this->Data = static_cast<const uint8_t*>(view);
+	this->Size = static_cast<size_t>(fileStatus.st_size);
+#endif
+
+	try
+	{
+		Validate(this->Data, this->Size);
+	}
+	catch (const std::runtime_error& e)
+	{
+		this->Unmap();
+		throw std::runtime_error(path + ": " + e.what());
+	}
+}
+
+VulkanCore::SceneFile::~SceneFile()
+{
+	this->Unmap();
+}
+
+uint32_t VulkanCore::SceneFile::GetNodeCount() const
+{
+	return this->GetHeader().nodeCount;
+}
+
+uint32_t VulkanCore::SceneFile::GetMeshCount() const
+{
+	return this->GetHeader().meshCount;
+}
+
+uint32_t VulkanCore::SceneFile::GetMaterialCount() const
+{
+	return this->GetHeader().materialCount;
+}
+
+uint32_t VulkanCore::SceneFile::GetTextureCount() const
+{
+	return this->GetHeader().textureCount;
+}
+
+const VulkanCore::SceneFileNode* VulkanCore::SceneFile::GetNodes() const
+{
+	return reinterpret_cast<const SceneFileNode*>(this->Data + this->GetHeader().nodesOffset);
+}
+
+const VulkanCore::SceneFileMesh* VulkanCore::SceneFile::GetMeshes() const
+{
+	return reinterpret_cast<const SceneFileMesh*>(this->Data + this->GetHeader().meshesOffset);
+}
+
+const VulkanCore::SceneFileMaterial* VulkanCore::SceneFile::GetMaterials() const
+{
+	return reinterpret_cast<const SceneFileMaterial*>(this->Data + this->GetHeader().materialsOffset);
+}
+
+const VulkanCore::SceneFileTexture* VulkanCore::SceneFile::GetTextures() const
+{
+	return reinterpret_cast<const SceneFileTexture*>(this->Data + this->GetHeader().texturesOffset);
+}
+
+const char* VulkanCore::SceneFile::GetString(uint32_t offset) const
+{
+	return reinterpret_cast<const char*>(this->Data + this->GetHeader().stringsOffset + offset);
+}
+
+VulkanCore::SceneNodeId VulkanCore::SceneFile::AppendTo(SceneGraph& scene) const
+{
+	const SceneNodeId firstNode = static_cast<SceneNodeId>(scene.GetNodeCount());
+	const SceneFileNode* nodes = this->GetNodes();
+	const uint32_t nodeCount = this->GetNodeCount();
+
+	scene.Reserve(firstNode + nodeCount);
+
+	for (uint32_t i = 0; i < nodeCount; i++)
+	{
+		const SceneFileNode& node = nodes[i];
+
+		scene.AddNode(
+			node.parent != NO_INDEX ? firstNode + node.parent : SceneGraph::NO_PARENT,
+			glm::vec3(node.translation[0], node.translation[1], node.translation[2]),
+			glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]),
+			glm::vec3(node.scale[0], node.scale[1], node.scale[2]));
+	}
+
+	return firstNode;
+}
+
+uint32_t VulkanCore::SceneFile::FindFirstMeshNode() const
+{
+	const SceneFileNode* nodes = this->GetNodes();
+
+	for (uint32_t i = 0; i < this->GetNodeCount(); i++)
+	{
+		if (nodes[i].mesh != NO_INDEX)
+		{
+			return i;
+		}
+	}
+
+	return NO_INDEX;
+}
+
+void VulkanCore::SceneFile::Validate(const uint8_t* data, size_t size)
+{
+	if (size < sizeof(SceneFileHeader))
+	{
+		throw std::runtime_error("scene is smaller than its header!");
+	}
+
+	const SceneFileHeader& header = *reinterpret_cast<const SceneFileHeader*>(data);
+
+	if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+	{
+		throw std::runtime_error("not a compiled scene of version " + std::to_string(FILE_VERSION) + "!");
+	}
+
+	if (header.fileSize != size)
+	{
+		throw std::runtime_error("scene is truncated!");
+	}
+
+	ValidateSection(header, header.nodesOffset, header.nodeCount, sizeof(SceneFileNode), "node");
+	ValidateSection(header, header.meshesOffset, header.meshCount, sizeof(SceneFileMesh), "mesh");
+	ValidateSection(header, header.materialsOffset, header.materialCount, sizeof(SceneFileMaterial), "material");
+	ValidateSection(header, header.texturesOffset, header.textureCount, sizeof(SceneFileTexture), "texture");
+	ValidateSection(header, header.stringsOffset, header.stringsSize, 1, "string");
+
+	// every string offset then ends inside the table
+	if (header.stringsSize == 0 || data[header.stringsOffset + header.stringsSize - 1] != '\0')
+	{
+		throw std::runtime_error("scene string table is not terminated!");
+	}
+
+	const SceneFileNode* nodes = reinterpret_cast<const SceneFileNode*>(data + header.nodesOffset);
+
+	for (uint32_t i = 0; i < header.nodeCount; i++)
+	{
+		ValidateReference(nodes[i].name, header.stringsSize, false, "node name", i);
+		ValidateReference(nodes[i].parent, i, true, "node parent", i);
+		ValidateReference(nodes[i].mesh, header.meshCount, true, "node mesh", i);
+		ValidateReference(nodes[i].material, header.materialCount, true, "node material", i);
+	}
+
+	const SceneFileMesh* meshes = reinterpret_cast<const SceneFileMesh*>(data + header.meshesOffset);
+
+	for (uint32_t i = 0; i < header.meshCount; i++)
+	{
+		ValidateReference(meshes[i].name, header.stringsSize, false, "mesh name", i);
+		ValidateReference(meshes[i].path, header.stringsSize, false, "mesh path", i);
+	}
+
+	const SceneFileMaterial* materials = reinterpret_cast<const SceneFileMaterial*>(data + header.materialsOffset);
+
+	for (uint32_t i = 0; i < header.materialCount; i++)
+	{
+		ValidateReference(materials[i].name, header.stringsSize, false, "material name", i);
+		ValidateReference(materials[i].baseColorTexture, header.textureCount, true, "material texture", i);
+	}
+
+	const SceneFileTexture* textures = reinterpret_cast<const SceneFileTexture*>(data + header.texturesOffset);
+
+	for (uint32_t i = 0; i < header.textureCount; i++)
+	{
+		ValidateReference(textures[i].name, header.stringsSize, false, "texture name", i);
+		ValidateReference(textures[i].path, header.stringsSize, false, "texture path", i);
+	}
+}
+
+std::string VulkanCore::SceneFile::GetPathFromEnvironment()
+{
+	const char* value = std::getenv(PATH_VARIABLE);
+
+	return value != nullptr ? value : "";
+}
+
+const VulkanCore::SceneFileHeader& VulkanCore::SceneFile::GetHeader() const
+{
+	return *reinterpret_cast<const SceneFileHeader*>(this->Data);
+}
+
+void VulkanCore::SceneFile::Unmap()
+{
+#ifdef _WIN32
+	if (this->Data != nullptr)
+	{
+		UnmapViewOfFile(this->Data);
+	}
+
+	if (this->MappingHandle != nullptr)
+	{
+		CloseHandle(this->MappingHandle);
+	}
+
+	if (this->FileHandle != nullptr)
+	{
+		CloseHandle(this->FileHandle);
+	}
+#else
+	if (this->Data != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(this->Data), this->Size);
+	}
+#endif
+
+	this->Data = nullptr;
+	this->Size = 0;
+	this->MappingHandle = nullptr;
+	this->FileHandle = nullptr;
+}
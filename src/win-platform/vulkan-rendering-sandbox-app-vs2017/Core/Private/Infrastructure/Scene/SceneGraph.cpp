@@ -0,0 +1,203 @@
+#include "../../../Public/Infrastructure/Scene/SceneGraph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+void VulkanCore::SceneGraph::Reserve(size_t nodeCount)
+{
+	this->Parents.reserve(nodeCount);
+	this->Translations.reserve(nodeCount);
+	this->Rotations.reserve(nodeCount);
+	this->Scales.reserve(nodeCount);
+	this->WorldTransforms.reserve(nodeCount);
+	this->DirtyFlags.reserve(nodeCount);
+}
+
+void VulkanCore::SceneGraph::Clear()
+{
+	this->Parents.clear();
+	this->Translations.clear();
+	this->Rotations.clear();
+	this->Scales.clear();
+	this->WorldTransforms.clear();
+	this->DirtyFlags.clear();
+	this->FirstDirtyNode = 0;
+}
+
+VulkanCore::SceneNodeId VulkanCore::SceneGraph::AddNode(
+	SceneNodeId parent,
+	const glm::vec3& translation,
+	const glm::quat& rotation,
+	const glm::vec3& scale)
+{
+	const SceneNodeId node = static_cast<SceneNodeId>(this->Parents.size());
+
+	if (parent != NO_PARENT && parent >= node)
+	{
+		throw std::invalid_argument("scene node parent " + std::to_string(parent) + " does not exist yet!");
+	}
+
+	this->Parents.push_back(parent);
+	this->Translations.push_back(translation);
+	this->Rotations.push_back(rotation);
+	this->Scales.push_back(scale);
+	this->WorldTransforms.push_back(glm::mat4(1.0f));
+	this->DirtyFlags.push_back(0);
+
+	this->MarkDirty(node);
+
+	return node;
+}
+
+size_t VulkanCore::SceneGraph::GetNodeCount() const
+{
+	return this->Parents.size();
+}
+
+VulkanCore::SceneNodeId VulkanCore::SceneGraph::GetParent(SceneNodeId node) const
+{
+	return this->Parents[node];
+}
+
+const glm::vec3& VulkanCore::SceneGraph::GetTranslation(SceneNodeId node) const
+{
+	return this->Translations[node];
+}
+
+const glm::quat& VulkanCore::SceneGraph::GetRotation(SceneNodeId node) const
+{
+	return this->Rotations[node];
+}
+
+const glm::vec3& VulkanCore::SceneGraph::GetScale(SceneNodeId node) const
+{
+	return this->Scales[node];
+}
+
+void VulkanCore::SceneGraph::SetTranslation(SceneNodeId node, const glm::vec3& translation)
+{
+	this->Translations[node] = translation;
+	this->MarkDirty(node);
+}
+
+void VulkanCore::SceneGraph::SetRotation(SceneNodeId node, const glm::quat& rotation)
+{
+	this->Rotations[node] = rotation;
+	this->MarkDirty(node);
+}
+
+void VulkanCore::SceneGraph::SetScale(SceneNodeId node, const glm::vec3& scale)
+{
+	this->Scales[node] = scale;
+	this->MarkDirty(node);
+}
+
+const glm::mat4& VulkanCore::SceneGraph::GetWorldTransform(SceneNodeId node) const
+{
+	return this->WorldTransforms[node];
+}
+
+const std::vector<glm::mat4>& VulkanCore::SceneGraph::GetWorldTransforms() const
+{
+	return this->WorldTransforms;
+}
+
+uint32_t VulkanCore::SceneGraph::UpdateWorldTransforms()
+{
+	const size_t nodeCount = this->Parents.size();
+	uint32_t updatedCount = 0;
+
+	for (size_t node = this->FirstDirtyNode; node < nodeCount; node++)
+	{
+		const SceneNodeId parent = this->Parents[node];
+
+		// the parent was visited first, its flag already carries any change above it
+		if (parent != NO_PARENT)
+		{
+			this->DirtyFlags[node] |= this->DirtyFlags[parent];
+		}
+
+		if (!this->DirtyFlags[node])
+		{
+			continue;
+		}
+
+		// translation * rotation * scale without going through three full matrix products
+		glm::mat4 local = glm::mat4_cast(this->Rotations[node]);
+		local[0] *= this->Scales[node].x;
+		local[1] *= this->Scales[node].y;
+		local[2] *= this->Scales[node].z;
+		local[3] = glm::vec4(this->Translations[node], 1.0f);
+
+		this->WorldTransforms[node] = parent != NO_PARENT ? this->WorldTransforms[parent] * local : local;
+		updatedCount++;
+	}
+
+	if (this->FirstDirtyNode < nodeCount)
+	{
+		std::fill(this->DirtyFlags.begin() + this->FirstDirtyNode, this->DirtyFlags.end(), static_cast<uint8_t>(0));
+	}
+
+	this->FirstDirtyNode = nodeCount;
+
+	return updatedCount;
+}
+
+std::vector<VulkanCore::SceneNodeId> VulkanCore::SceneGraph::SortParentsFirst(const std::vector<SceneNodeId>& parents)
+{
+	const size_t nodeCount = parents.size();
+
+	// children of every node as ranges of one array, roots are the children of the virtual node nodeCount
+	std::vector<uint32_t> childOffsets(nodeCount + 2, 0);
+
+	for (size_t node = 0; node < nodeCount; node++)
+	{
+		const SceneNodeId parent = parents[node];
+
+		if (parent != NO_PARENT && parent >= nodeCount)
+		{
+			throw std::invalid_argument("scene node " + std::to_string(node) + " has parent " + std::to_string(parent) + " out of range!");
+		}
+
+		childOffsets[(parent != NO_PARENT ? parent : nodeCount) + 1]++;
+	}
+
+	for (size_t i = 1; i < childOffsets.size(); i++)
+	{
+		childOffsets[i] += childOffsets[i - 1];
+	}
+
+	std::vector<SceneNodeId> children(nodeCount);
+	std::vector<uint32_t> childCursors(childOffsets.begin(), childOffsets.end() - 1);
+
+	for (size_t node = 0; node < nodeCount; node++)
+	{
+		const size_t parent = parents[node] != NO_PARENT ? parents[node] : nodeCount;
+		children[childCursors[parent]++] = static_cast<SceneNodeId>(node);
+	}
+
+	// breadth first from the roots, the order doubles as the queue
+	std::vector<SceneNodeId> order(children.begin() + childOffsets[nodeCount], children.end());
+	order.reserve(nodeCount);
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const SceneNodeId node = order[i];
+		order.insert(order.end(), children.begin() + childOffsets[node], children.begin() + childOffsets[node + 1]);
+	}
+
+	// nodes on a cycle are never reached from a root
+	if (order.size() != nodeCount)
+	{
+		throw std::invalid_argument("scene hierarchy has a cycle!");
+	}
+
+	return order;
+}
+
+void VulkanCore::SceneGraph::MarkDirty(SceneNodeId node)
+{
+	this->DirtyFlags[node] = 1;
+	this->FirstDirtyNode = std::min<size_t>(this->FirstDirtyNode, node);
+}
@@ -0,0 +1,99 @@
+#include "../../../Public/Infrastructure/Shaders/PipelineVariantCache.hpp"
+
+#include <stdexcept>
+#include <string>
+
+VulkanCore::ShaderVariantSpecialization::ShaderVariantSpecialization(uint32_t features) :
+	constants(),
+	mapEntries(),
+	info()
+{
+	for (uint32_t i = 0; i < FEATURE_COUNT; ++i)
+	{
+		this->constants[i] = (features & (1u << i)) != 0 ? VK_TRUE : VK_FALSE;
+
+		this->mapEntries[i].constantID = i;
+		this->mapEntries[i].offset = i * sizeof(VkBool32);
+		this->mapEntries[i].size = sizeof(VkBool32);
+	}
+
+	this->info.mapEntryCount = FEATURE_COUNT;
+	this->info.pMapEntries = this->mapEntries.data();
+	this->info.dataSize = sizeof(this->constants);
+	this->info.pData = this->constants.data();
+}
+
+VulkanCore::PipelineVariantCache::PipelineVariantCache(VkDevice device, PipelineBuilder builder) :
+	vkDevice(device),
+	Builder(builder)
+{
+}
+
+VulkanCore::PipelineVariantCache::~PipelineVariantCache()
+{
+	this->Clear();
+}
+
+VkPipeline VulkanCore::PipelineVariantCache::GetPipeline(uint32_t features)
+{
+	const auto cached = this->Pipelines.find(features);
+
+	if (cached != this->Pipelines.end())
+	{
+		return cached->second;
+	}
+
+	const ShaderVariantSpecialization specialization(features);
+	const VkPipeline pipeline = this->Builder(specialization.info);
+
+	if (pipeline == VK_NULL_HANDLE)
+	{
+		throw std::runtime_error("failed to create pipeline variant " + std::to_string(features) + "!");
+	}
+
+	this->Pipelines.emplace(features, pipeline);
+
+	return pipeline;
+}
+
+void VulkanCore::PipelineVariantCache::AddPipeline(uint32_t features, VkPipeline pipeline)
+{
+	const auto cached = this->Pipelines.find(features);
+
+	if (cached != this->Pipelines.end())
+	{
+		vkDestroyPipeline(this->vkDevice, cached->second, nullptr);
+	}
+
+	this->Pipelines[features] = pipeline;
+}
+
+void VulkanCore::PipelineVariantCache::Clear()
+{
+	for (const auto& entry : this->Pipelines)
+	{
+		vkDestroyPipeline(this->vkDevice, entry.second, nullptr);
+	}
+
+	this->Pipelines.clear();
+}
+
+// hands the pipelines over to the caller, who destroys them once no frame in flight uses them
+std::vector<VkPipeline> VulkanCore::PipelineVariantCache::Release()
+{
+	std::vector<VkPipeline> pipelines;
+
+	for (const auto& entry : this->Pipelines)
+	{
+		pipelines.push_back(entry.second);
+	}
+
+	this->Pipelines.clear();
+
+	return pipelines;
+}
+
+size_t VulkanCore::PipelineVariantCache::GetPipelineCount() const
+{
+	return this->Pipelines.size();
+}
@@ -0,0 +1,103 @@
+#include "../../../Public/Infrastructure/Shaders/ShaderCompiler.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+bool VulkanCore::ShaderCompiler::IsShaderSource(const std::string& fileName)
+{
+	const std::filesystem::path path(fileName);
+	const std::string extension = path.extension().string();
+	const std::string name = path.filename().string();
+
+	// test_* shaders are experiments and are skipped by the build stage as well
+	if (name.compare(0, 5, "test_") == 0)
+	{
+		return false;
+	}
+
+	return extension == ".vert" || extension == ".frag" || extension == ".comp";
+}
+
+bool VulkanCore::ShaderCompiler::CompileToSpirv(const std::string& sourcePath, const std::string& outputPath, std::string& log)
+{
+	// same tool chain as Shaders/build_shaders, the result replaces the output only when both steps succeed
+	const std::string unoptimizedPath = outputPath + ".unopt";
+	const std::string optimizedPath = outputPath + ".new";
+	const std::string logPath = outputPath + ".log";
+
+	const std::string compileCommand =
+		"\"" + GetToolPath("glslangValidator") + "\" -V \"" + sourcePath + "\" -o \"" + unoptimizedPath + "\" > \"" + logPath + "\" 2>&1";
+
+	if (RunCommand(compileCommand) != 0)
+	{
+		log = ReadLog(logPath);
+		std::remove(unoptimizedPath.c_str());
+		std::remove(logPath.c_str());
+		return false;
+	}
+
+	const std::string optimizeCommand =
+		"\"" + GetToolPath("spirv-opt") + "\" -O \"" + unoptimizedPath + "\" -o \"" + optimizedPath + "\" > \"" + logPath + "\" 2>&1";
+
+	const bool optimized = RunCommand(optimizeCommand) == 0;
+
+	log = ReadLog(logPath);
+	std::remove(unoptimizedPath.c_str());
+	std::remove(logPath.c_str());
+
+	if (!optimized)
+	{
+		std::remove(optimizedPath.c_str());
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(optimizedPath, outputPath, error);
+
+	if (error)
+	{
+		log += "failed to replace " + outputPath + ": " + error.message();
+		return false;
+	}
+
+	return true;
+}
+
+std::string VulkanCore::ShaderCompiler::GetToolPath(const std::string& toolName)
+{
+	const char* sdkPath = std::getenv("VULKAN_SDK");
+
+	if (sdkPath == nullptr)
+	{
+		return toolName;
+	}
+
+#ifdef _WIN32
+	return std::string(sdkPath) + "\\Bin\\" + toolName + ".exe";
+#else
+	return std::string(sdkPath) + "/bin/" + toolName;
+#endif
+}
+
+int VulkanCore::ShaderCompiler::RunCommand(const std::string& command)
+{
+#ifdef _WIN32
+	// cmd.exe strips the outer quotes of a command line starting with a quoted path
+	return std::system(("\"" + command + "\"").c_str());
+#else
+	return std::system(command.c_str());
+#endif
+}
+
+std::string VulkanCore::ShaderCompiler::ReadLog(const std::string& logPath)
+{
+	std::ifstream logFile(logPath);
+	std::stringstream buffer;
+
+	buffer << logFile.rdbuf();
+
+	return buffer.str();
+}
@@ -0,0 +1,646 @@
+#include "../../../Public/Infrastructure/Shaders/ShaderReflection.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+// subset of the SPIR-V 1.0 grammar needed to recover the resource interface of a module
+enum SpirvOp : uint32_t
+{
+	SpirvOpName = 5,
+	SpirvOpMemberName = 6,
+	SpirvOpEntryPoint = 15,
+	SpirvOpTypeBool = 20,
+	SpirvOpTypeInt = 21,
+	SpirvOpTypeFloat = 22,
+	SpirvOpTypeVector = 23,
+	SpirvOpTypeMatrix = 24,
+	SpirvOpTypeImage = 25,
+	SpirvOpTypeSampler = 26,
+	SpirvOpTypeSampledImage = 27,
+	SpirvOpTypeArray = 28,
+	SpirvOpTypeRuntimeArray = 29,
+	SpirvOpTypeStruct = 30,
+	SpirvOpTypePointer = 32,
+	SpirvOpConstant = 43,
+	SpirvOpSpecConstantTrue = 48,
+	SpirvOpSpecConstantFalse = 49,
+	SpirvOpSpecConstant = 50,
+	SpirvOpVariable = 59,
+	SpirvOpDecorate = 71,
+	SpirvOpMemberDecorate = 72
+};
+
+enum SpirvDecoration : uint32_t
+{
+	SpirvDecorationSpecId = 1,
+	SpirvDecorationBlock = 2,
+	SpirvDecorationBufferBlock = 3,
+	SpirvDecorationArrayStride = 6,
+	SpirvDecorationMatrixStride = 7,
+	SpirvDecorationBuiltIn = 11,
+	SpirvDecorationLocation = 30,
+	SpirvDecorationBinding = 33,
+	SpirvDecorationDescriptorSet = 34,
+	SpirvDecorationOffset = 35
+};
+
+enum SpirvStorageClass : uint32_t
+{
+	SpirvStorageClassUniformConstant = 0,
+	SpirvStorageClassInput = 1,
+	SpirvStorageClassUniform = 2,
+	SpirvStorageClassPushConstant = 9,
+	SpirvStorageClassStorageBuffer = 12
+};
+
+static const uint32_t SPIRV_UNSET = 0xFFFFFFFF;
+static const uint32_t SPIRV_DIM_BUFFER = 5;
+static const uint32_t SPIRV_DIM_SUBPASS_DATA = 6;
+
+struct SpirvId
+{
+	uint32_t opcode = 0;
+	uint32_t typeId = 0;
+	uint32_t storageClass = SPIRV_UNSET;
+	uint32_t width = 0;
+	bool isSigned = false;
+	uint32_t componentCount = 0;
+	uint32_t imageDim = 0;
+	uint32_t imageSampled = 0;
+	uint32_t constantValue = 0;
+	uint32_t lengthId = 0;
+	std::vector<uint32_t> members;
+	std::vector<uint32_t> memberOffsets;
+	std::vector<uint32_t> memberMatrixStrides;
+	uint32_t set = SPIRV_UNSET;
+	uint32_t binding = SPIRV_UNSET;
+	uint32_t location = SPIRV_UNSET;
+	uint32_t specId = SPIRV_UNSET;
+	uint32_t arrayStride = 0;
+	bool isBlock = false;
+	bool isBufferBlock = false;
+	bool isBuiltIn = false;
+	std::string name;
+};
+
+static std::string ReadSpirvString(const uint32_t* words, uint32_t wordCount)
+{
+	std::string result;
+
+	for (uint32_t i = 0; i < wordCount; ++i)
+	{
+		for (uint32_t byte = 0; byte < 4; ++byte)
+		{
+			const char c = static_cast<char>((words[i] >> (byte * 8)) & 0xFF);
+			if (c == '\0')
+			{
+				return result;
+			}
+			result.push_back(c);
+		}
+	}
+
+	return result;
+}
+
+static uint32_t GetSpirvTypeSize(const std::vector<SpirvId>& ids, uint32_t typeId, uint32_t matrixStride)
+{
+	const SpirvId& type = ids[typeId];
+
+	switch (type.opcode)
+	{
+	case SpirvOpTypeBool:
+		return 4;
+	case SpirvOpTypeInt:
+	case SpirvOpTypeFloat:
+		return type.width / 8;
+	case SpirvOpTypeVector:
+		return type.componentCount * GetSpirvTypeSize(ids, type.typeId, 0);
+	case SpirvOpTypeMatrix:
+		return type.componentCount * (matrixStride != 0 ? matrixStride : GetSpirvTypeSize(ids, type.typeId, 0));
+	case SpirvOpTypeArray:
+	{
+		const uint32_t elementSize = type.arrayStride != 0 ? type.arrayStride : GetSpirvTypeSize(ids, type.typeId, matrixStride);
+		return ids[type.lengthId].constantValue * elementSize;
+	}
+	case SpirvOpTypeStruct:
+	{
+		uint32_t size = 0;
+		for (size_t i = 0; i < type.members.size(); ++i)
+		{
+			const uint32_t offset = i < type.memberOffsets.size() ? type.memberOffsets[i] : 0;
+			const uint32_t stride = i < type.memberMatrixStrides.size() ? type.memberMatrixStrides[i] : 0;
+			size = std::max(size, offset + GetSpirvTypeSize(ids, type.members[i], stride));
+		}
+		return size;
+	}
+	default:
+		return 0;
+	}
+}
+
+static VkFormat GetSpirvVertexFormat(const std::vector<SpirvId>& ids, uint32_t typeId)
+{
+	const SpirvId& type = ids[typeId];
+	const SpirvId& scalar = type.opcode == SpirvOpTypeVector ? ids[type.typeId] : type;
+	const uint32_t components = type.opcode == SpirvOpTypeVector ? type.componentCount : 1;
+
+	if (scalar.width != 32 || components < 1 || components > 4)
+	{
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	static const VkFormat floatFormats[] = {
+		VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT
+	};
+	static const VkFormat signedFormats[] = {
+		VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT
+	};
+	static const VkFormat unsignedFormats[] = {
+		VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT
+	};
+
+	if (scalar.opcode == SpirvOpTypeFloat)
+	{
+		return floatFormats[components - 1];
+	}
+
+	if (scalar.opcode == SpirvOpTypeInt)
+	{
+		return scalar.isSigned ? signedFormats[components - 1] : unsignedFormats[components - 1];
+	}
+
+	return VK_FORMAT_UNDEFINED;
+}
+
+static VkShaderStageFlags GetSpirvStage(uint32_t executionModel)
+{
+	switch (executionModel)
+	{
+	case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+	case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+	case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+	case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+	case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+	case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+	default: return 0;
+	}
+}
+
+void VulkanCore::ShaderReflectionData::Merge(const ShaderReflectionData& other)
+{
+	this->stageFlags |= other.stageFlags;
+
+	for (const auto& binding : other.descriptorBindings)
+	{
+		const auto existing = std::find_if(
+			this->descriptorBindings.begin(),
+			this->descriptorBindings.end(),
+			[&binding](const ShaderDescriptorBinding& candidate) {
+				return candidate.set == binding.set && candidate.binding == binding.binding;
+			});
+
+		if (existing == this->descriptorBindings.end())
+		{
+			this->descriptorBindings.push_back(binding);
+			continue;
+		}
+
+		if (existing->descriptorType != binding.descriptorType || existing->descriptorCount != binding.descriptorCount)
+		{
+			throw std::runtime_error("shader stages disagree on descriptor " + binding.name);
+		}
+
+		existing->stageFlags |= binding.stageFlags;
+	}
+
+	for (const auto& range : other.pushConstantRanges)
+	{
+		const auto existing = std::find_if(
+			this->pushConstantRanges.begin(),
+			this->pushConstantRanges.end(),
+			[&range](const ShaderPushConstantRange& candidate) {
+				return candidate.offset == range.offset && candidate.size == range.size;
+			});
+
+		if (existing == this->pushConstantRanges.end())
+		{
+			this->pushConstantRanges.push_back(range);
+		}
+		else
+		{
+			existing->stageFlags |= range.stageFlags;
+		}
+	}
+
+	this->vertexInputs.insert(this->vertexInputs.end(), other.vertexInputs.begin(), other.vertexInputs.end());
+
+	for (const auto& constant : other.specializationConstants)
+	{
+		const auto existing = std::find_if(
+			this->specializationConstants.begin(),
+			this->specializationConstants.end(),
+			[&constant](const ShaderSpecializationConstant& candidate) {
+				return candidate.constantId == constant.constantId;
+			});
+
+		if (existing == this->specializationConstants.end())
+		{
+			this->specializationConstants.push_back(constant);
+		}
+	}
+}
+
+std::vector<VkDescriptorSetLayoutBinding> VulkanCore::ShaderReflectionData::GetDescriptorSetLayoutBindings(uint32_t set) const
+{
+	std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+
+	for (const auto& binding : this->descriptorBindings)
+	{
+		if (binding.set != set)
+		{
+			continue;
+		}
+
+		VkDescriptorSetLayoutBinding layoutBinding = {};
+		layoutBinding.binding = binding.binding;
+		layoutBinding.descriptorType = binding.descriptorType;
+		layoutBinding.descriptorCount = binding.descriptorCount;
+		layoutBinding.stageFlags = binding.stageFlags;
+		layoutBinding.pImmutableSamplers = nullptr;
+
+		layoutBindings.push_back(layoutBinding);
+	}
+
+	std::sort(layoutBindings.begin(), layoutBindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+		return a.binding < b.binding;
+	});
+
+	return layoutBindings;
+}
+
+std::vector<VkPushConstantRange> VulkanCore::ShaderReflectionData::GetPushConstantRanges() const
+{
+	std::vector<VkPushConstantRange> ranges;
+
+	for (const auto& range : this->pushConstantRanges)
+	{
+		VkPushConstantRange pushConstantRange = {};
+		pushConstantRange.stageFlags = range.stageFlags;
+		pushConstantRange.offset = range.offset;
+		pushConstantRange.size = range.size;
+
+		ranges.push_back(pushConstantRange);
+	}
+
+	return ranges;
+}
+
+void VulkanCore::ShaderReflectionData::ValidateVertexInputs(const VkVertexInputAttributeDescription* attributes, size_t attributeCount) const
+{
+	for (const auto& input : this->vertexInputs)
+	{
+		const VkVertexInputAttributeDescription* match = std::find_if(
+			attributes,
+			attributes + attributeCount,
+			[&input](const VkVertexInputAttributeDescription& attribute) {
+				return attribute.location == input.location;
+			});
+
+		if (match == attributes + attributeCount)
+		{
+			throw std::runtime_error("vertex shader input " + input.name + " has no matching vertex attribute!");
+		}
+
+		if (match->format != input.format)
+		{
+			throw std::runtime_error("vertex shader input " + input.name + " does not match the vertex attribute format!");
+		}
+	}
+}
+
+// a recompiled stage can reuse the existing pipeline layout only if everything it declares is already part of it
+bool VulkanCore::ShaderReflectionData::IsLayoutCompatible(const ShaderReflectionData& stage) const
+{
+	for (const auto& binding : stage.descriptorBindings)
+	{
+		const auto match = std::find_if(
+			this->descriptorBindings.begin(),
+			this->descriptorBindings.end(),
+			[&binding](const ShaderDescriptorBinding& existing) {
+				return existing.set == binding.set && existing.binding == binding.binding;
+			});
+
+		if (match == this->descriptorBindings.end()
+			|| match->descriptorType != binding.descriptorType
+			|| match->descriptorCount != binding.descriptorCount
+			|| (match->stageFlags & stage.stageFlags) != stage.stageFlags
+			|| (match->blockSize != 0 && binding.blockSize > match->blockSize))
+		{
+			return false;
+		}
+	}
+
+	for (const auto& range : stage.pushConstantRanges)
+	{
+		const bool isCovered = std::any_of(
+			this->pushConstantRanges.begin(),
+			this->pushConstantRanges.end(),
+			[&range, &stage](const ShaderPushConstantRange& existing) {
+				return existing.offset <= range.offset
+					&& existing.offset + existing.size >= range.offset + range.size
+					&& (existing.stageFlags & stage.stageFlags) == stage.stageFlags;
+			});
+
+		if (!isCovered)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void VulkanCore::ShaderReflection::ValidateSpirv(const std::vector<uint32_t>& code, const std::string& sourceName)
+{
+	if (code.size() < 5 || code[0] != SPIRV_MAGIC)
+	{
+		throw std::runtime_error("shader file " + sourceName + " is not a valid SPIR-V module");
+	}
+}
+
+VulkanCore::ShaderReflectionData VulkanCore::ShaderReflection::Reflect(const std::vector<uint32_t>& code, const std::string& sourceName)
+{
+	ValidateSpirv(code, sourceName);
+
+	const uint32_t bound = code[3];
+	std::vector<SpirvId> ids(bound);
+	ShaderReflectionData reflection;
+
+	std::vector<uint32_t> variables;
+	std::vector<uint32_t> specializationConstants;
+
+	size_t offset = 5;
+
+	while (offset < code.size())
+	{
+		const uint32_t opcode = code[offset] & 0xFFFF;
+		const uint32_t wordCount = code[offset] >> 16;
+
+		if (wordCount == 0 || offset + wordCount > code.size())
+		{
+			throw std::runtime_error("shader file " + sourceName + " contains a truncated SPIR-V instruction");
+		}
+
+		const uint32_t* operands = &code[offset + 1];
+
+		switch (opcode)
+		{
+		case SpirvOpName:
+			ids[operands[0]].name = ReadSpirvString(operands + 1, wordCount - 2);
+			break;
+		case SpirvOpEntryPoint:
+			if (reflection.stageFlags == 0)
+			{
+				reflection.stageFlags = GetSpirvStage(operands[0]);
+			}
+			break;
+		case SpirvOpDecorate:
+		{
+			SpirvId& target = ids[operands[0]];
+			switch (operands[1])
+			{
+			case SpirvDecorationSpecId: target.specId = operands[2]; break;
+			case SpirvDecorationBlock: target.isBlock = true; break;
+			case SpirvDecorationBufferBlock: target.isBufferBlock = true; break;
+			case SpirvDecorationArrayStride: target.arrayStride = operands[2]; break;
+			case SpirvDecorationBuiltIn: target.isBuiltIn = true; break;
+			case SpirvDecorationLocation: target.location = operands[2]; break;
+			case SpirvDecorationBinding: target.binding = operands[2]; break;
+			case SpirvDecorationDescriptorSet: target.set = operands[2]; break;
+			default: break;
+			}
+			break;
+		}
+		case SpirvOpMemberDecorate:
+		{
+			SpirvId& target = ids[operands[0]];
+			const uint32_t member = operands[1];
+
+			if (operands[2] == SpirvDecorationOffset)
+			{
+				target.memberOffsets.resize(std::max<size_t>(target.memberOffsets.size(), member + 1), 0);
+				target.memberOffsets[member] = operands[3];
+			}
+			else if (operands[2] == SpirvDecorationMatrixStride)
+			{
+				target.memberMatrixStrides.resize(std::max<size_t>(target.memberMatrixStrides.size(), member + 1), 0);
+				target.memberMatrixStrides[member] = operands[3];
+			}
+			else if (operands[2] == SpirvDecorationBuiltIn)
+			{
+				target.isBuiltIn = true;
+			}
+			break;
+		}
+		case SpirvOpTypeBool:
+			ids[operands[0]].opcode = opcode;
+			break;
+		case SpirvOpTypeInt:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].width = operands[1];
+			ids[operands[0]].isSigned = operands[2] != 0;
+			break;
+		case SpirvOpTypeFloat:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].width = operands[1];
+			break;
+		case SpirvOpTypeVector:
+		case SpirvOpTypeMatrix:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].typeId = operands[1];
+			ids[operands[0]].componentCount = operands[2];
+			break;
+		case SpirvOpTypeImage:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].typeId = operands[1];
+			ids[operands[0]].imageDim = operands[2];
+			ids[operands[0]].imageSampled = operands[6];
+			break;
+		case SpirvOpTypeSampler:
+			ids[operands[0]].opcode = opcode;
+			break;
+		case SpirvOpTypeSampledImage:
+		case SpirvOpTypeRuntimeArray:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].typeId = operands[1];
+			break;
+		case SpirvOpTypeArray:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].typeId = operands[1];
+			ids[operands[0]].lengthId = operands[2];
+			break;
+		case SpirvOpTypeStruct:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].members.assign(operands + 1, operands + wordCount - 1);
+			break;
+		case SpirvOpTypePointer:
+			ids[operands[0]].opcode = opcode;
+			ids[operands[0]].storageClass = operands[1];
+			ids[operands[0]].typeId = operands[2];
+			break;
+		case SpirvOpConstant:
+		case SpirvOpSpecConstant:
+			ids[operands[1]].opcode = opcode;
+			ids[operands[1]].typeId = operands[0];
+			ids[operands[1]].constantValue = operands[2];
+			if (opcode == SpirvOpSpecConstant)
+			{
+				specializationConstants.push_back(operands[1]);
+			}
+			break;
+		case SpirvOpSpecConstantTrue:
+		case SpirvOpSpecConstantFalse:
+			ids[operands[1]].opcode = opcode;
+			ids[operands[1]].typeId = operands[0];
+			specializationConstants.push_back(operands[1]);
+			break;
+		case SpirvOpVariable:
+			ids[operands[1]].opcode = opcode;
+			ids[operands[1]].typeId = operands[0];
+			ids[operands[1]].storageClass = operands[2];
+			variables.push_back(operands[1]);
+			break;
+		default:
+			break;
+		}
+
+		offset += wordCount;
+	}
+
+	for (const uint32_t variableId : variables)
+	{
+		const SpirvId& variable = ids[variableId];
+		uint32_t typeId = ids[variable.typeId].typeId;
+
+		if (variable.storageClass == SpirvStorageClassInput)
+		{
+			if (reflection.stageFlags != VK_SHADER_STAGE_VERTEX_BIT
+				|| variable.isBuiltIn
+				|| ids[typeId].isBuiltIn
+				|| variable.location == SPIRV_UNSET)
+			{
+				continue;
+			}
+
+			ShaderVertexInput input;
+			input.location = variable.location;
+			input.format = GetSpirvVertexFormat(ids, typeId);
+			input.name = variable.name;
+
+			reflection.vertexInputs.push_back(input);
+		}
+		else if (variable.storageClass == SpirvStorageClassPushConstant)
+		{
+			const SpirvId& block = ids[typeId];
+
+			uint32_t rangeOffset = GetSpirvTypeSize(ids, typeId, 0);
+			for (const uint32_t memberOffset : block.memberOffsets)
+			{
+				rangeOffset = std::min(rangeOffset, memberOffset);
+			}
+
+			ShaderPushConstantRange range;
+			range.offset = rangeOffset;
+			range.size = GetSpirvTypeSize(ids, typeId, 0) - rangeOffset;
+			range.stageFlags = reflection.stageFlags;
+
+			reflection.pushConstantRanges.push_back(range);
+		}
+		else if (variable.storageClass == SpirvStorageClassUniformConstant
+			|| variable.storageClass == SpirvStorageClassUniform
+			|| variable.storageClass == SpirvStorageClassStorageBuffer)
+		{
+			ShaderDescriptorBinding binding;
+			binding.set = variable.set == SPIRV_UNSET ? 0 : variable.set;
+			binding.binding = variable.binding;
+			binding.stageFlags = reflection.stageFlags;
+			binding.name = variable.name;
+
+			if (variable.binding == SPIRV_UNSET)
+			{
+				throw std::runtime_error("shader resource " + variable.name + " in " + sourceName + " has no binding decoration");
+			}
+
+			while (ids[typeId].opcode == SpirvOpTypeArray || ids[typeId].opcode == SpirvOpTypeRuntimeArray)
+			{
+				if (ids[typeId].opcode == SpirvOpTypeArray)
+				{
+					binding.descriptorCount *= ids[ids[typeId].lengthId].constantValue;
+				}
+				typeId = ids[typeId].typeId;
+			}
+
+			const SpirvId& type = ids[typeId];
+
+			switch (type.opcode)
+			{
+			case SpirvOpTypeStruct:
+				binding.descriptorType = (variable.storageClass == SpirvStorageClassStorageBuffer || type.isBufferBlock)
+					? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+					: VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				binding.blockSize = GetSpirvTypeSize(ids, typeId, 0);
+				break;
+			case SpirvOpTypeSampledImage:
+				binding.descriptorType = ids[type.typeId].imageDim == SPIRV_DIM_BUFFER
+					? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER
+					: VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				break;
+			case SpirvOpTypeSampler:
+				binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+				break;
+			case SpirvOpTypeImage:
+				if (type.imageDim == SPIRV_DIM_SUBPASS_DATA)
+				{
+					binding.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				}
+				else if (type.imageDim == SPIRV_DIM_BUFFER)
+				{
+					binding.descriptorType = type.imageSampled == 2
+						? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+						: VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+				}
+				else
+				{
+					binding.descriptorType = type.imageSampled == 2
+						? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+						: VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				}
+				break;
+			default:
+				throw std::runtime_error("shader resource " + variable.name + " in " + sourceName + " has an unsupported type");
+			}
+
+			reflection.descriptorBindings.push_back(binding);
+		}
+	}
+
+	for (const uint32_t constantId : specializationConstants)
+	{
+		const SpirvId& constant = ids[constantId];
+
+		if (constant.specId == SPIRV_UNSET)
+		{
+			continue;
+		}
+
+		ShaderSpecializationConstant specializationConstant;
+		specializationConstant.constantId = constant.specId;
+		specializationConstant.size = GetSpirvTypeSize(ids, constant.typeId, 0);
+		specializationConstant.name = constant.name;
+
+		reflection.specializationConstants.push_back(specializationConstant);
+	}
+
+	return reflection;
+}
@@ -0,0 +1,221 @@
+#include "../../../Public/Infrastructure/Shaders/ShaderWatcher.hpp"
+#include "../../../Public/Infrastructure/Shaders/ShaderCompiler.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// editors usually save in several writes, changes are collected for a short while before compiling
+static const std::chrono::milliseconds DEBOUNCE_INTERVAL(100);
+static const std::chrono::milliseconds POLL_INTERVAL(250);
+
+VulkanCore::ShaderWatcher::ShaderWatcher(const std::string& sourceDirectory, const std::string& outputDirectory) :
+	SourceDirectory(sourceDirectory),
+	OutputDirectory(outputDirectory),
+	IsRunning(false)
+{
+}
+
+VulkanCore::ShaderWatcher::~ShaderWatcher()
+{
+	this->Stop();
+}
+
+void VulkanCore::ShaderWatcher::SetReloadHandler(ShaderReloadHandler handler)
+{
+	this->ReloadHandler = std::move(handler);
+}
+
+void VulkanCore::ShaderWatcher::Start()
+{
+	if (this->IsRunning)
+	{
+		return;
+	}
+
+#ifdef __linux__
+	this->InotifyDescriptor = inotify_init1(IN_NONBLOCK);
+
+	if (this->InotifyDescriptor < 0
+		|| inotify_add_watch(this->InotifyDescriptor, this->SourceDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+	{
+		std::cerr << "shader hot reload disabled: failed to watch " << this->SourceDirectory << std::endl;
+		if (this->InotifyDescriptor >= 0)
+		{
+			close(this->InotifyDescriptor);
+			this->InotifyDescriptor = -1;
+		}
+		return;
+	}
+#else
+	this->ScanDirectory();
+#endif
+
+	this->IsRunning = true;
+	this->WatchThread = std::thread(&ShaderWatcher::WatchLoop, this);
+}
+
+void VulkanCore::ShaderWatcher::Stop()
+{
+	if (!this->IsRunning)
+	{
+		return;
+	}
+
+	this->IsRunning = false;
+
+	if (this->WatchThread.joinable())
+	{
+		this->WatchThread.join();
+	}
+
+#ifdef __linux__
+	close(this->InotifyDescriptor);
+	this->InotifyDescriptor = -1;
+#endif
+}
+
+std::vector<VulkanCore::ShaderReloadResult> VulkanCore::ShaderWatcher::ConsumeReloads()
+{
+	std::lock_guard<std::mutex> lock(this->ReloadsLock);
+
+	std::vector<ShaderReloadResult> reloads;
+	reloads.swap(this->PendingReloads);
+
+	return reloads;
+}
+
+void VulkanCore::ShaderWatcher::WatchLoop()
+{
+	while (this->IsRunning)
+	{
+		std::set<std::string> changedFiles = this->WaitForChanges();
+
+		if (changedFiles.empty())
+		{
+			continue;
+		}
+
+		std::this_thread::sleep_for(DEBOUNCE_INTERVAL);
+
+		const std::set<std::string> lateChanges = this->WaitForChanges();
+		changedFiles.insert(lateChanges.begin(), lateChanges.end());
+
+		for (const auto& fileName : changedFiles)
+		{
+			if (ShaderCompiler::IsShaderSource(fileName))
+			{
+				this->Recompile(fileName);
+			}
+		}
+	}
+}
+
+std::set<std::string> VulkanCore::ShaderWatcher::WaitForChanges()
+{
+#ifdef __linux__
+	std::set<std::string> changedFiles;
+
+	pollfd descriptor = {};
+	descriptor.fd = this->InotifyDescriptor;
+	descriptor.events = POLLIN;
+
+	if (poll(&descriptor, 1, static_cast<int>(POLL_INTERVAL.count())) <= 0)
+	{
+		return changedFiles;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+
+	while ((length = read(this->InotifyDescriptor, buffer, sizeof(buffer))) > 0)
+	{
+		for (char* pointer = buffer; pointer < buffer + length;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(pointer);
+
+			if (event->len > 0)
+			{
+				changedFiles.insert(event->name);
+			}
+
+			pointer += sizeof(inotify_event) + event->len;
+		}
+	}
+
+	return changedFiles;
+#else
+	std::this_thread::sleep_for(POLL_INTERVAL);
+
+	return this->ScanDirectory();
+#endif
+}
+
+#ifndef __linux__
+std::set<std::string> VulkanCore::ShaderWatcher::ScanDirectory()
+{
+	std::set<std::string> changedFiles;
+	std::error_code error;
+
+	for (const auto& entry : std::filesystem::directory_iterator(this->SourceDirectory, error))
+	{
+		const std::string fileName = entry.path().filename().string();
+		const auto writeTime = std::filesystem::last_write_time(entry.path(), error);
+
+		if (error)
+		{
+			continue;
+		}
+
+		const auto known = this->LastWriteTimes.find(fileName);
+
+		if (known != this->LastWriteTimes.end() && known->second != writeTime)
+		{
+			changedFiles.insert(fileName);
+		}
+
+		this->LastWriteTimes[fileName] = writeTime;
+	}
+
+	return changedFiles;
+}
+#endif
+
+void VulkanCore::ShaderWatcher::Recompile(const std::string& fileName)
+{
+	ShaderReloadResult result;
+	result.sourcePath = this->SourceDirectory + "/" + fileName;
+	result.outputPath = this->OutputDirectory + "/" + fileName + ".spv";
+
+	std::string log;
+
+	if (!ShaderCompiler::CompileToSpirv(result.sourcePath, result.outputPath, log))
+	{
+		// the running pipeline is kept, the compiler output tells what to fix
+		std::cerr << "shader " << fileName << " failed to compile:" << std::endl << log << std::endl;
+		return;
+	}
+
+	std::ifstream shaderFile(result.outputPath, std::ios::ate | std::ios::binary);
+	const size_t fileSize = static_cast<size_t>(shaderFile.tellg());
+
+	result.code.resize(fileSize / sizeof(uint32_t));
+	shaderFile.seekg(0);
+	shaderFile.read(reinterpret_cast<char*>(result.code.data()), result.code.size() * sizeof(uint32_t));
+
+	std::cout << "shader " << fileName << " recompiled" << std::endl;
+
+	if (this->ReloadHandler && !this->ReloadHandler(result))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(this->ReloadsLock);
+	this->PendingReloads.push_back(std::move(result));
+}
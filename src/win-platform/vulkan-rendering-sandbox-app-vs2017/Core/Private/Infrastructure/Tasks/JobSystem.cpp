@@ -0,0 +1,430 @@
+#include "../../../Public/Infrastructure/Tasks/JobSystem.hpp"
+#include "../../../Public/Infrastructure/Profiling/CpuTrace.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// which system and deque the current thread works for, -1 on threads outside any system
+	thread_local VulkanCore::JobSystem* CurrentSystem = nullptr;
+	thread_local int32_t CurrentWorker = -1;
+
+	const uint32_t IDLE_SPINS = 64;
+}
+
+bool VulkanCore::JobCounter::IsDone() const
+{
+	return this->PendingJobs.load(std::memory_order_acquire) == 0;
+}
+
+VulkanCore::JobSystem::WorkStealingDeque::WorkStealingDeque() :
+	Jobs(DEQUE_CAPACITY)
+{
+}
+
+bool VulkanCore::JobSystem::WorkStealingDeque::Push(Job* job)
+{
+	const int64_t bottom = this->Bottom.load(std::memory_order_relaxed);
+	const int64_t top = this->Top.load(std::memory_order_acquire);
+
+	if (bottom - top >= static_cast<int64_t>(DEQUE_CAPACITY))
+	{
+		return false;
+	}
+
+	// a thief that sees the new bottom also sees the job
+	this->Jobs[bottom & (DEQUE_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+	this->Bottom.store(bottom + 1, std::memory_order_release);
+
+	return true;
+}
+
+VulkanCore::JobSystem::Job* VulkanCore::JobSystem::WorkStealingDeque::Pop()
+{
+	const int64_t bottom = this->Bottom.load(std::memory_order_relaxed) - 1;
+	this->Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = this->Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		this->Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = this->Jobs[bottom & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+
+	// the last job may be stolen at the same time, whoever moves the top first gets it
+	if (top == bottom)
+	{
+		if (!this->Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+
+		this->Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+VulkanCore::JobSystem::Job* VulkanCore::JobSystem::WorkStealingDeque::Steal()
+{
+	int64_t top = this->Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t bottom = this->Bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
+
+	Job* job = this->Jobs[top & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+
+	if (!this->Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+
+	return job;
+}
+
+VulkanCore::JobSystem::JobSystem(uint32_t workerCount)
+{
+	static_assert((DEQUE_CAPACITY & (DEQUE_CAPACITY - 1)) == 0, "the deque capacity has to be a power of two");
+
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		this->Deques.push_back(new WorkStealingDeque());
+	}
+
+	this->Workers.reserve(workerCount);
+
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		this->Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+VulkanCore::JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->SleepLock);
+		this->Stopping.store(true);
+	}
+
+	this->SleepSignal.notify_all();
+
+	for (auto& worker : this->Workers)
+	{
+		worker.join();
+	}
+
+	// jobs nobody waited for are dropped with the system
+	for (WorkStealingDeque* deque : this->Deques)
+	{
+		while (Job* job = deque->Steal())
+		{
+			delete job;
+		}
+
+		delete deque;
+	}
+
+	for (Job* job : this->InjectedJobs)
+	{
+		delete job;
+	}
+}
+
+void VulkanCore::JobSystem::Run(const char* name, std::function<void()> work, JobCounter* counter)
+{
+	if (counter != nullptr)
+	{
+		counter->PendingJobs.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	this->Enqueue(new Job{ name, std::move(work), counter });
+}
+
+void VulkanCore::JobSystem::RunAfter(JobCounter& dependency, const char* name, std::function<void()> work, JobCounter* counter)
+{
+	if (counter != nullptr)
+	{
+		counter->PendingJobs.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(dependency.Lock);
+
+		if (dependency.PendingJobs.load(std::memory_order_acquire) != 0)
+		{
+			dependency.Continuations.push_back({ name, std::move(work), counter });
+			return;
+		}
+	}
+
+	this->Enqueue(new Job{ name, std::move(work), counter });
+}
+
+void VulkanCore::JobSystem::Wait(JobCounter& counter)
+{
+	const int32_t workerIndex = CurrentSystem == this ? CurrentWorker : -1;
+
+	while (counter.PendingJobs.load(std::memory_order_acquire) != 0)
+	{
+		if (Job* job = this->TakeJob(workerIndex))
+		{
+			this->Execute(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	std::exception_ptr failure;
+
+	{
+		std::lock_guard<std::mutex> lock(counter.Lock);
+		std::swap(failure, counter.Failure);
+	}
+
+	if (failure)
+	{
+		std::rethrow_exception(failure);
+	}
+}
+
+void VulkanCore::JobSystem::ParallelFor(
+	const char* name,
+	size_t begin,
+	size_t end,
+	size_t grainSize,
+	const std::function<void(size_t chunkBegin, size_t chunkEnd)>& work)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+
+	// a few chunks per thread so stealing evens out uneven chunks, but never below the grain size
+	const size_t count = end - begin;
+	const size_t targetChunks = (static_cast<size_t>(this->GetWorkerCount()) + 1) * 4;
+	const size_t chunkSize = std::max(std::max<size_t>(grainSize, 1), (count + targetChunks - 1) / targetChunks);
+
+	if (chunkSize >= count)
+	{
+		CpuTraceZone zone(name);
+		work(begin, end);
+		return;
+	}
+
+	JobCounter counter;
+
+	for (size_t chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize)
+	{
+		const size_t chunkEnd = chunkBegin + std::min(chunkSize, end - chunkBegin);
+
+		this->Run(name, [&work, chunkBegin, chunkEnd]() { work(chunkBegin, chunkEnd); }, &counter);
+	}
+
+	// the chunks reference the work and the counter, they have to finish even when the first one throws
+	try
+	{
+		CpuTraceZone zone(name);
+		work(begin, begin + chunkSize);
+	}
+	catch (...)
+	{
+		try
+		{
+			this->Wait(counter);
+		}
+		catch (...)
+		{
+		}
+
+		throw;
+	}
+
+	this->Wait(counter);
+}
+
+uint32_t VulkanCore::JobSystem::GetWorkerCount() const
+{
+	return static_cast<uint32_t>(this->Workers.size());
+}
+
+uint32_t VulkanCore::JobSystem::GetDefaultWorkerCount()
+{
+	const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+
+	return std::max(hardwareThreads, 2u) - 1;
+}
+
+VulkanCore::JobSystem& VulkanCore::JobSystem::GetShared()
+{
+	static JobSystem shared;
+
+	return shared;
+}
+
+void VulkanCore::JobSystem::Enqueue(Job* job)
+{
+	if (CurrentSystem == this && CurrentWorker >= 0)
+	{
+		// a full deque means plenty of queued work already, the job runs in place
+		if (!this->Deques[CurrentWorker]->Push(job))
+		{
+			this->Execute(job);
+			return;
+		}
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(this->InjectionLock);
+		this->InjectedJobs.push_back(job);
+	}
+
+	// pairs with the sleeping worker raising SleepingWorkers before it checks QueuedJobs, one of the two sees the other
+	this->QueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+	if (this->SleepingWorkers.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> lock(this->SleepLock);
+		this->SleepSignal.notify_one();
+	}
+}
+
+VulkanCore::JobSystem::Job* VulkanCore::JobSystem::TakeJob(int32_t workerIndex)
+{
+	Job* job = nullptr;
+
+	if (workerIndex >= 0)
+	{
+		job = this->Deques[workerIndex]->Pop();
+	}
+
+	if (job == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(this->InjectionLock);
+
+		if (!this->InjectedJobs.empty())
+		{
+			job = this->InjectedJobs.front();
+			this->InjectedJobs.pop_front();
+		}
+	}
+
+	// victims are visited starting after the thief so workers do not all hit the same deque
+	const size_t dequeCount = this->Deques.size();
+
+	for (size_t i = 1; job == nullptr && i <= dequeCount; ++i)
+	{
+		const size_t victim = (static_cast<size_t>(workerIndex + 1) + i) % dequeCount;
+
+		if (static_cast<int32_t>(victim) != workerIndex)
+		{
+			job = this->Deques[victim]->Steal();
+		}
+	}
+
+	if (job != nullptr)
+	{
+		this->QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+void VulkanCore::JobSystem::Execute(Job* job)
+{
+	std::exception_ptr failure;
+
+	try
+	{
+		CpuTraceZone zone(job->name);
+		job->work();
+	}
+	catch (...)
+	{
+		failure = std::current_exception();
+	}
+
+	JobCounter* counter = job->counter;
+	delete job;
+
+	if (counter != nullptr)
+	{
+		this->Finish(*counter, failure);
+	}
+}
+
+void VulkanCore::JobSystem::Finish(JobCounter& counter, std::exception_ptr failure)
+{
+	std::vector<JobCounter::Continuation> continuations;
+	std::exception_ptr batchFailure;
+
+	{
+		std::lock_guard<std::mutex> lock(counter.Lock);
+
+		if (failure && !counter.Failure)
+		{
+			counter.Failure = failure;
+		}
+
+		if (counter.PendingJobs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		{
+			return;
+		}
+
+		continuations.swap(counter.Continuations);
+		batchFailure = counter.Failure;
+	}
+
+	// the counter may be gone from here on, continuations of a failed batch pass the failure on instead of running
+	for (auto& continuation : continuations)
+	{
+		if (!batchFailure)
+		{
+			this->Enqueue(new Job{ continuation.name, std::move(continuation.work), continuation.counter });
+		}
+		else if (continuation.counter != nullptr)
+		{
+			this->Finish(*continuation.counter, batchFailure);
+		}
+	}
+}
+
+void VulkanCore::JobSystem::WorkerLoop(uint32_t workerIndex)
+{
+	CurrentSystem = this;
+	CurrentWorker = static_cast<int32_t>(workerIndex);
+
+	while (!this->Stopping.load(std::memory_order_acquire))
+	{
+		Job* job = this->TakeJob(CurrentWorker);
+
+		for (uint32_t spin = 0; job == nullptr && spin < IDLE_SPINS; ++spin)
+		{
+			std::this_thread::yield();
+			job = this->TakeJob(CurrentWorker);
+		}
+
+		if (job != nullptr)
+		{
+			this->Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(this->SleepLock);
+		this->SleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+
+		this->SleepSignal.wait(lock, [this]() {
+			return this->QueuedJobs.load(std::memory_order_seq_cst) > 0 || this->Stopping.load();
+		});
+
+		this->SleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+	}
+}
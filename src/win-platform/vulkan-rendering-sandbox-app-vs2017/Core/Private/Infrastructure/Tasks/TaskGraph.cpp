@@ -0,0 +1,89 @@
+#include "../../../Public/Infrastructure/Tasks/TaskGraph.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+VulkanCore::TaskGraph::TaskId VulkanCore::TaskGraph::AddTask(
+	const char* name,
+	std::function<void()> work,
+	const std::vector<TaskId>& dependencies)
+{
+	const TaskId taskId = static_cast<TaskId>(this->Tasks.size());
+
+	for (const TaskId dependency : dependencies)
+	{
+		// tasks only depend on earlier ones, so the graph cannot have cycles
+		if (dependency >= taskId)
+		{
+			throw std::runtime_error(std::string("task ") + name + " depends on a task added after it");
+		}
+
+		this->Tasks[dependency].dependents.push_back(taskId);
+	}
+
+	Task task;
+	task.name = name;
+	task.work = std::move(work);
+	task.dependencyCount = static_cast<uint32_t>(dependencies.size());
+
+	this->Tasks.push_back(std::move(task));
+
+	return taskId;
+}
+
+void VulkanCore::TaskGraph::Run(JobSystem& jobs)
+{
+	std::vector<std::atomic<uint32_t>> pendingDependencies(this->Tasks.size());
+	std::atomic<bool> failed{ false };
+	JobCounter counter;
+
+	// every task queues the dependents it was the last dependency of, the job system traces the task names
+	std::function<void(TaskId)> start = [&](TaskId taskId) {
+		jobs.Run(this->Tasks[taskId].name, [&, taskId]() {
+			// after a failure nothing new is started, running tasks are left to finish
+			if (failed.load())
+			{
+				return;
+			}
+
+			try
+			{
+				this->Tasks[taskId].work();
+			}
+			catch (...)
+			{
+				failed.store(true);
+				throw;
+			}
+
+			for (const TaskId dependent : this->Tasks[taskId].dependents)
+			{
+				if (pendingDependencies[dependent].fetch_sub(1) == 1)
+				{
+					start(dependent);
+				}
+			}
+		}, &counter);
+	};
+
+	for (TaskId taskId = 0; taskId < this->Tasks.size(); ++taskId)
+	{
+		pendingDependencies[taskId].store(this->Tasks[taskId].dependencyCount);
+	}
+
+	for (TaskId taskId = 0; taskId < this->Tasks.size(); ++taskId)
+	{
+		if (this->Tasks[taskId].dependencyCount == 0)
+		{
+			start(taskId);
+		}
+	}
+
+	jobs.Wait(counter);
+}
+
+size_t VulkanCore::TaskGraph::GetTaskCount() const
+{
+	return this->Tasks.size();
+}
@@ -0,0 +1,206 @@
+#include "../../../Public/Infrastructure/Textures/SamplerCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+template <typename T>
+static void HashCombine(size_t& seed, const T& value)
+{
+	seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+VulkanCore::SamplerKey::SamplerKey(const VkSamplerCreateInfo& createInfo) :
+	flags(createInfo.flags),
+	magFilter(createInfo.magFilter),
+	minFilter(createInfo.minFilter),
+	mipmapMode(createInfo.mipmapMode),
+	addressModeU(createInfo.addressModeU),
+	addressModeV(createInfo.addressModeV),
+	addressModeW(createInfo.addressModeW),
+	mipLodBias(createInfo.mipLodBias),
+	anisotropyEnable(createInfo.anisotropyEnable),
+	maxAnisotropy(createInfo.maxAnisotropy),
+	compareEnable(createInfo.compareEnable),
+	compareOp(createInfo.compareOp),
+	minLod(createInfo.minLod),
+	maxLod(createInfo.maxLod),
+	borderColor(createInfo.borderColor),
+	unnormalizedCoordinates(createInfo.unnormalizedCoordinates)
+{
+}
+
+bool VulkanCore::SamplerKey::operator==(const SamplerKey& other) const
+{
+	return flags == other.flags
+		&& magFilter == other.magFilter
+		&& minFilter == other.minFilter
+		&& mipmapMode == other.mipmapMode
+		&& addressModeU == other.addressModeU
+		&& addressModeV == other.addressModeV
+		&& addressModeW == other.addressModeW
+		&& mipLodBias == other.mipLodBias
+		&& anisotropyEnable == other.anisotropyEnable
+		&& maxAnisotropy == other.maxAnisotropy
+		&& compareEnable == other.compareEnable
+		&& compareOp == other.compareOp
+		&& minLod == other.minLod
+		&& maxLod == other.maxLod
+		&& borderColor == other.borderColor
+		&& unnormalizedCoordinates == other.unnormalizedCoordinates;
+}
+
+VkSamplerCreateInfo VulkanCore::SamplerKey::ToCreateInfo() const
+{
+	VkSamplerCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	createInfo.flags = flags;
+	createInfo.magFilter = magFilter;
+	createInfo.minFilter = minFilter;
+	createInfo.mipmapMode = mipmapMode;
+	createInfo.addressModeU = addressModeU;
+	createInfo.addressModeV = addressModeV;
+	createInfo.addressModeW = addressModeW;
+	createInfo.mipLodBias = mipLodBias;
+	createInfo.anisotropyEnable = anisotropyEnable;
+	createInfo.maxAnisotropy = maxAnisotropy;
+	createInfo.compareEnable = compareEnable;
+	createInfo.compareOp = compareOp;
+	createInfo.minLod = minLod;
+	createInfo.maxLod = maxLod;
+	createInfo.borderColor = borderColor;
+	createInfo.unnormalizedCoordinates = unnormalizedCoordinates;
+
+	return createInfo;
+}
+
+size_t VulkanCore::SamplerKeyHash::operator()(const SamplerKey& key) const
+{
+	size_t seed = 0;
+
+	HashCombine(seed, static_cast<uint32_t>(key.flags));
+	HashCombine(seed, static_cast<int>(key.magFilter));
+	HashCombine(seed, static_cast<int>(key.minFilter));
+	HashCombine(seed, static_cast<int>(key.mipmapMode));
+	HashCombine(seed, static_cast<int>(key.addressModeU));
+	HashCombine(seed, static_cast<int>(key.addressModeV));
+	HashCombine(seed, static_cast<int>(key.addressModeW));
+	HashCombine(seed, key.mipLodBias);
+	HashCombine(seed, static_cast<uint32_t>(key.anisotropyEnable));
+	HashCombine(seed, key.maxAnisotropy);
+	HashCombine(seed, static_cast<uint32_t>(key.compareEnable));
+	HashCombine(seed, static_cast<int>(key.compareOp));
+	HashCombine(seed, key.minLod);
+	HashCombine(seed, key.maxLod);
+	HashCombine(seed, static_cast<int>(key.borderColor));
+	HashCombine(seed, static_cast<uint32_t>(key.unnormalizedCoordinates));
+
+	return seed;
+}
+
+VulkanCore::SamplerCache::SamplerCache(VkDevice device, VkPhysicalDevice physicalDevice) :
+	vkDevice(device)
+{
+	VkPhysicalDeviceProperties deviceProperties;
+	VkPhysicalDeviceFeatures deviceFeatures;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	vkGetPhysicalDeviceFeatures(physicalDevice, &deviceFeatures);
+
+	this->MaxSamplerAnisotropy = deviceProperties.limits.maxSamplerAnisotropy;
+	this->MaxSamplerAllocationCount = deviceProperties.limits.maxSamplerAllocationCount;
+	this->AnisotropySupported = deviceFeatures.samplerAnisotropy;
+}
+
+VulkanCore::SamplerCache::~SamplerCache()
+{
+	this->Clear();
+}
+
+VkSampler VulkanCore::SamplerCache::GetSampler(const VkSamplerCreateInfo& createInfo)
+{
+	const SamplerKey key = this->Normalize(createInfo);
+
+	const auto cached = this->Samplers.find(key);
+	if (cached != this->Samplers.end())
+	{
+		this->HitCount++;
+		return cached->second;
+	}
+
+	this->MissCount++;
+
+	if (this->Samplers.size() >= this->MaxSamplerAllocationCount)
+	{
+		throw std::runtime_error("sampler cache exceeded maxSamplerAllocationCount!");
+	}
+
+	const VkSamplerCreateInfo samplerInfo = key.ToCreateInfo();
+
+	VkSampler sampler;
+	if (vkCreateSampler(this->vkDevice, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create texture sampler!");
+	}
+
+	this->Samplers.emplace(key, sampler);
+
+	return sampler;
+}
+
+void VulkanCore::SamplerCache::Clear()
+{
+	for (const auto& entry : this->Samplers)
+	{
+		vkDestroySampler(this->vkDevice, entry.second, nullptr);
+	}
+
+	this->Samplers.clear();
+}
+
+uint64_t VulkanCore::SamplerCache::GetHitCount() const
+{
+	return this->HitCount;
+}
+
+uint64_t VulkanCore::SamplerCache::GetMissCount() const
+{
+	return this->MissCount;
+}
+
+size_t VulkanCore::SamplerCache::GetSamplerCount() const
+{
+	return this->Samplers.size();
+}
+
+VulkanCore::SamplerKey VulkanCore::SamplerCache::Normalize(const VkSamplerCreateInfo& createInfo) const
+{
+	SamplerKey key(createInfo);
+
+	// fields the driver ignores are reset so equivalent states share one sampler
+	if (key.anisotropyEnable && this->AnisotropySupported)
+	{
+		key.maxAnisotropy = std::min(std::max(key.maxAnisotropy, 1.0f), this->MaxSamplerAnisotropy);
+	}
+	else
+	{
+		key.anisotropyEnable = VK_FALSE;
+		key.maxAnisotropy = 1.0f;
+	}
+
+	if (!key.compareEnable)
+	{
+		key.compareOp = VK_COMPARE_OP_NEVER;
+	}
+
+	const bool usesBorder =
+		key.addressModeU == VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER
+		|| key.addressModeV == VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER
+		|| key.addressModeW == VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+
+	if (!usesBorder)
+	{
+		key.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+	}
+
+	return key;
+}
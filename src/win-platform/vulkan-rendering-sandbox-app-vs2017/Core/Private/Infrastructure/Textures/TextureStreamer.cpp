@@ -0,0 +1,726 @@
+#include "../../../Public/Infrastructure/Textures/TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// retired images and staging buffers are kept alive for a few frames, until no frame in flight can use them
+static const uint64_t RETIRE_LATENCY_FRAMES = 3;
+
+static void RecordMipBarrier(
+	VkCommandBuffer commandBuffer,
+	VkImage image,
+	uint32_t baseMip,
+	uint32_t levelCount,
+	VkImageLayout oldLayout,
+	VkImageLayout newLayout,
+	VkAccessFlags srcAccessMask,
+	VkAccessFlags dstAccessMask,
+	VkPipelineStageFlags srcStage,
+	VkPipelineStageFlags dstStage)
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = baseMip;
+	barrier.subresourceRange.levelCount = levelCount;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.srcAccessMask = srcAccessMask;
+	barrier.dstAccessMask = dstAccessMask;
+
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		srcStage,
+		dstStage,
+		0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+}
+
+VulkanCore::TextureStreamer::TextureStreamer(
+	VkDevice device,
+	VkPhysicalDevice physicalDevice,
+	VkCommandPool commandPool,
+	VkQueue graphicsQueue,
+	VkDeviceSize budgetBytes,
+	float heapBudgetFraction,
+	VkDeviceSize maxUploadBytesPerFrame) :
+	vkDevice(device),
+	vkPhysicalDevice(physicalDevice),
+	vkCommandPool(commandPool),
+	vkGraphicsQueue(graphicsQueue),
+	MaxUploadBytesPerFrame(maxUploadBytesPerFrame)
+{
+	if (budgetBytes != 0)
+	{
+		this->Budget = budgetBytes;
+	}
+	else
+	{
+		this->Budget = static_cast<VkDeviceSize>(
+			static_cast<double>(QueryDeviceLocalHeapSize(physicalDevice)) * heapBudgetFraction);
+	}
+}
+
+VulkanCore::TextureStreamer::~TextureStreamer()
+{
+	this->CollectRetiredResources(0, true);
+
+	for (auto& texture : this->Textures)
+	{
+		if (texture.imageView != texture.tailImageView)
+		{
+			vkDestroyImageView(this->vkDevice, texture.imageView, nullptr);
+		}
+
+		vkDestroyImage(this->vkDevice, texture.detailImage, nullptr);
+		vkFreeMemory(this->vkDevice, texture.detailImageMemory, nullptr);
+		vkDestroyImageView(this->vkDevice, texture.tailImageView, nullptr);
+		vkDestroyImage(this->vkDevice, texture.tailImage, nullptr);
+		vkFreeMemory(this->vkDevice, texture.tailImageMemory, nullptr);
+	}
+}
+
+VulkanCore::StreamedTexture VulkanCore::TextureStreamer::DecodeTexture(const std::string& filePath)
+{
+	int textureWidth, textureHeight, textureChannels;
+
+	stbi_uc* pixels = ShaderExtensions::CreateTextureImage(filePath.c_str(), &textureWidth, &textureHeight, &textureChannels);
+
+	StreamedTexture texture;
+	texture.filePath = filePath;
+	texture.width = static_cast<uint32_t>(textureWidth);
+	texture.height = static_cast<uint32_t>(textureHeight);
+
+	GenerateMipChain(texture, pixels);
+
+	stbi_image_free(pixels);
+
+	// start from the mip tail so the texture can be sampled right away
+	texture.requestedMip = texture.mipLevels - 1;
+	for (uint32_t level = 0; level < texture.mipLevels; ++level)
+	{
+		if (std::max(texture.width >> level, texture.height >> level) <= INITIAL_RESIDENT_DIMENSION)
+		{
+			texture.requestedMip = level;
+			break;
+		}
+	}
+
+	return texture;
+}
+
+uint32_t VulkanCore::TextureStreamer::RegisterTexture(const std::string& filePath)
+{
+	return this->RegisterTexture(DecodeTexture(filePath));
+}
+
+uint32_t VulkanCore::TextureStreamer::RegisterTexture(StreamedTexture&& texture)
+{
+	const uint32_t textureId = static_cast<uint32_t>(this->Textures.size());
+	this->Textures.push_back(std::move(texture));
+
+	StreamedTexture& registered = this->Textures[textureId];
+	registered.tailMip = registered.requestedMip;
+
+	this->EvictLeastRecentlyUsed(GetMipRangeSize(registered, registered.tailMip), 0, textureId);
+	this->CreateTailImage(textureId);
+
+	return textureId;
+}
+
+void VulkanCore::TextureStreamer::RequestScreenSize(uint32_t textureId, float screenSpacePixels, uint64_t frameIndex)
+{
+	StreamedTexture& texture = this->Textures.at(textureId);
+
+	texture.lastUsedFrame = frameIndex;
+
+	const float texels = static_cast<float>(std::max(texture.width, texture.height));
+	const float pixels = std::max(screenSpacePixels, 1.0f);
+	const float lod = std::floor(std::log2(texels / pixels));
+
+	texture.requestedMip = static_cast<uint32_t>(
+		std::min(std::max(lod, 0.0f), static_cast<float>(texture.mipLevels - 1)));
+}
+
+bool VulkanCore::TextureStreamer::Update(uint64_t frameIndex, VkCommandBuffer commandBuffer)
+{
+	this->CollectRetiredResources(frameIndex, false);
+	this->ResidencyChanged = false;
+
+	// most recently used textures get their upload bandwidth first
+	std::vector<uint32_t> order(this->Textures.size());
+	for (uint32_t i = 0; i < order.size(); ++i)
+	{
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+		return this->Textures[a].lastUsedFrame > this->Textures[b].lastUsedFrame;
+	});
+
+	VkDeviceSize uploadedBytes = 0;
+
+	for (const uint32_t textureId : order)
+	{
+		StreamedTexture& texture = this->Textures[textureId];
+
+		if (texture.requestedMip >= texture.residentMip)
+		{
+			continue;
+		}
+
+		// stream one level finer per update to spread the upload cost over frames
+		const uint32_t nextMip = texture.residentMip - 1;
+		const VkDeviceSize levelBytes = texture.mipData[nextMip].size();
+
+		if (uploadedBytes + levelBytes > this->MaxUploadBytesPerFrame && uploadedBytes != 0)
+		{
+			break;
+		}
+
+		if (texture.detailImage == VK_NULL_HANDLE || nextMip < texture.detailMip)
+		{
+			// sized for everything requested now, the levels in between then stream in without reallocating
+			if (!this->EvictLeastRecentlyUsed(GetMipRangeSize(texture, texture.requestedMip), frameIndex, textureId))
+			{
+				continue;
+			}
+
+			this->CreateDetailImage(textureId, texture.requestedMip, frameIndex, commandBuffer);
+		}
+
+		this->UploadDetailMip(textureId, nextMip, frameIndex, commandBuffer);
+
+		uploadedBytes += levelBytes;
+	}
+
+	return this->ResidencyChanged;
+}
+
+VkImageView VulkanCore::TextureStreamer::GetImageView(uint32_t textureId) const
+{
+	return this->Textures.at(textureId).imageView;
+}
+
+uint32_t VulkanCore::TextureStreamer::GetMipLevels(uint32_t textureId) const
+{
+	return this->Textures.at(textureId).mipLevels;
+}
+
+uint32_t VulkanCore::TextureStreamer::GetResidentMip(uint32_t textureId) const
+{
+	return this->Textures.at(textureId).residentMip;
+}
+
+VkDeviceSize VulkanCore::TextureStreamer::GetBudget() const
+{
+	return this->Budget;
+}
+
+VkDeviceSize VulkanCore::TextureStreamer::GetResidentBytes() const
+{
+	return this->ResidentBytes + this->RetiredBytes;
+}
+
+void VulkanCore::TextureStreamer::SetProfiler(GpuProfiler* profiler)
+{
+	this->Profiler = profiler;
+}
+
+VkDeviceSize VulkanCore::TextureStreamer::QueryDeviceLocalHeapSize(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+
+	VkDeviceSize heapSize = 0;
+
+	for (uint32_t i = 0; i < memProperties.memoryHeapCount; i++)
+	{
+		if (memProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			heapSize = std::max(heapSize, memProperties.memoryHeaps[i].size);
+		}
+	}
+
+	if (heapSize == 0)
+	{
+		throw std::runtime_error("failed to find device local memory heap!");
+	}
+
+	return heapSize;
+}
+
+void VulkanCore::TextureStreamer::GenerateMipChain(StreamedTexture& texture, const stbi_uc* pixels)
+{
+	texture.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texture.width, texture.height)))) + 1;
+	texture.mipData.resize(texture.mipLevels);
+	texture.mipData[0].assign(pixels, pixels + texture.width * texture.height * 4);
+
+	uint32_t sourceWidth = texture.width;
+	uint32_t sourceHeight = texture.height;
+
+	for (uint32_t level = 1; level < texture.mipLevels; ++level)
+	{
+		const uint32_t mipWidth = std::max(sourceWidth / 2, 1u);
+		const uint32_t mipHeight = std::max(sourceHeight / 2, 1u);
+		const std::vector<stbi_uc>& source = texture.mipData[level - 1];
+		std::vector<stbi_uc>& destination = texture.mipData[level];
+
+		destination.resize(mipWidth * mipHeight * 4);
+
+		// 2x2 box filter, edge texels are clamped for odd dimensions
+		for (uint32_t y = 0; y < mipHeight; ++y)
+		{
+			const uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+			const uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+
+			for (uint32_t x = 0; x < mipWidth; ++x)
+			{
+				const uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+
+				for (uint32_t channel = 0; channel < 4; ++channel)
+				{
+					const uint32_t sum =
+						source[(y0 * sourceWidth + x0) * 4 + channel] +
+						source[(y0 * sourceWidth + x1) * 4 + channel] +
+						source[(y1 * sourceWidth + x0) * 4 + channel] +
+						source[(y1 * sourceWidth + x1) * 4 + channel];
+
+					destination[(y * mipWidth + x) * 4 + channel] = static_cast<stbi_uc>((sum + 2) / 4);
+				}
+			}
+		}
+
+		sourceWidth = mipWidth;
+		sourceHeight = mipHeight;
+	}
+}
+
+VkDeviceSize VulkanCore::TextureStreamer::GetMipRangeSize(const StreamedTexture& texture, uint32_t firstMip)
+{
+	VkDeviceSize size = 0;
+
+	for (uint32_t level = firstMip; level < texture.mipLevels; ++level)
+	{
+		size += texture.mipData[level].size();
+	}
+
+	return size;
+}
+
+void VulkanCore::TextureStreamer::StageMips(
+	const StreamedTexture& texture,
+	uint32_t firstMip,
+	uint32_t endMip,
+	uint32_t imageBaseMip,
+	VkBuffer& stagingBuffer,
+	VkDeviceMemory& stagingBufferMemory,
+	std::vector<VkBufferImageCopy>& regions)
+{
+	VkDeviceSize stagingSize = 0;
+	for (uint32_t level = firstMip; level < endMip; ++level)
+	{
+		stagingSize += texture.mipData[level].size();
+	}
+
+	MemoryUtils::CreateBuffer(
+		stagingSize,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		this->vkDevice,
+		this->vkPhysicalDevice,
+		stagingBuffer,
+		stagingBufferMemory);
+
+	void* data;
+	vkMapMemory(this->vkDevice, stagingBufferMemory, 0, stagingSize, 0, &data);
+
+	VkDeviceSize offset = 0;
+	for (uint32_t level = firstMip; level < endMip; ++level)
+	{
+		memcpy(static_cast<char*>(data) + offset, texture.mipData[level].data(), texture.mipData[level].size());
+
+		VkBufferImageCopy region = {};
+		region.bufferOffset = offset;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = level - imageBaseMip;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = {
+			std::max(texture.width >> level, 1u),
+			std::max(texture.height >> level, 1u),
+			1
+		};
+
+		regions.push_back(region);
+		offset += texture.mipData[level].size();
+	}
+
+	vkUnmapMemory(this->vkDevice, stagingBufferMemory);
+}
+
+bool VulkanCore::TextureStreamer::EvictLeastRecentlyUsed(VkDeviceSize requiredBytes, uint64_t frameIndex, uint32_t protectedTextureId)
+{
+	while (this->ResidentBytes + requiredBytes > this->Budget)
+	{
+		uint32_t candidate = std::numeric_limits<uint32_t>::max();
+
+		for (uint32_t i = 0; i < this->Textures.size(); ++i)
+		{
+			const StreamedTexture& texture = this->Textures[i];
+
+			// only detail images are evicted, the tail keeps every texture sampleable
+			if (i == protectedTextureId || texture.detailImage == VK_NULL_HANDLE)
+			{
+				continue;
+			}
+
+			// textures holding more detail than requested go first, the rest in LRU order
+			const bool overResident = texture.residentMip < texture.requestedMip;
+
+			if (!overResident && texture.lastUsedFrame >= frameIndex && frameIndex != 0)
+			{
+				continue;
+			}
+
+			if (candidate == std::numeric_limits<uint32_t>::max())
+			{
+				candidate = i;
+				continue;
+			}
+
+			const StreamedTexture& best = this->Textures[candidate];
+			const bool bestOverResident = best.residentMip < best.requestedMip;
+
+			if ((overResident && !bestOverResident)
+				|| (overResident == bestOverResident && texture.lastUsedFrame < best.lastUsedFrame))
+			{
+				candidate = i;
+			}
+		}
+
+		if (candidate == std::numeric_limits<uint32_t>::max())
+		{
+			return false;
+		}
+
+		this->EvictDetailImage(candidate, frameIndex);
+	}
+
+	// retired images are still allocated, the new one has to fit next to them
+	return this->ResidentBytes + this->RetiredBytes + requiredBytes <= this->Budget;
+}
+
+void VulkanCore::TextureStreamer::CreateTailImage(uint32_t textureId)
+{
+	StreamedTexture& texture = this->Textures[textureId];
+
+	const uint32_t levelCount = texture.mipLevels - texture.tailMip;
+
+	MemoryUtils::CreateImage(
+		std::max(texture.width >> texture.tailMip, 1u),
+		std::max(texture.height >> texture.tailMip, 1u),
+		levelCount,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		texture.tailImage,
+		texture.tailImageMemory,
+		this->vkDevice,
+		this->vkPhysicalDevice);
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	std::vector<VkBufferImageCopy> regions;
+
+	this->StageMips(texture, texture.tailMip, texture.mipLevels, texture.tailMip, stagingBuffer, stagingBufferMemory, regions);
+
+	VkCommandBuffer commandBuffer = GraphicsPipelineUtils::BeginSingleTimeCommands(this->vkDevice, this->vkCommandPool);
+
+	const uint32_t uploadScope = this->Profiler != nullptr
+		? this->Profiler->BeginScope(commandBuffer, "texture upload")
+		: GpuProfiler::INVALID_SCOPE;
+
+	RecordMipBarrier(
+		commandBuffer, texture.tailImage, 0, levelCount,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+	vkCmdCopyBufferToImage(
+		commandBuffer,
+		stagingBuffer,
+		texture.tailImage,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<uint32_t>(regions.size()),
+		regions.data());
+
+	RecordMipBarrier(
+		commandBuffer, texture.tailImage, 0, levelCount,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	if (this->Profiler != nullptr)
+	{
+		this->Profiler->EndScope(commandBuffer, uploadScope);
+	}
+
+	GraphicsPipelineUtils::EndSingleTimeCommands(this->vkDevice, this->vkCommandPool, this->vkGraphicsQueue, commandBuffer);
+
+	vkDestroyBuffer(this->vkDevice, stagingBuffer, nullptr);
+	vkFreeMemory(this->vkDevice, stagingBufferMemory, nullptr);
+
+	texture.tailImageView = GraphicsPipelineUtils::CreateImageView(
+		texture.tailImage,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_ASPECT_COLOR_BIT,
+		levelCount,
+		this->vkDevice);
+
+	texture.imageView = texture.tailImageView;
+	texture.residentMip = texture.tailMip;
+	this->ResidentBytes += GetMipRangeSize(texture, texture.tailMip);
+	this->ResidencyChanged = true;
+}
+
+void VulkanCore::TextureStreamer::CreateDetailImage(uint32_t textureId, uint32_t detailMip, uint64_t frameIndex, VkCommandBuffer commandBuffer)
+{
+	StreamedTexture& texture = this->Textures[textureId];
+
+	VkImage image;
+	VkDeviceMemory imageMemory;
+
+	MemoryUtils::CreateImage(
+		std::max(texture.width >> detailMip, 1u),
+		std::max(texture.height >> detailMip, 1u),
+		texture.mipLevels - detailMip,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		image,
+		imageMemory,
+		this->vkDevice,
+		this->vkPhysicalDevice);
+
+	// resident levels are copied over from the image sampled now, finer ones stay undefined until uploaded
+	const bool hasDetailImage = texture.detailImage != VK_NULL_HANDLE;
+	const VkImage sourceImage = hasDetailImage ? texture.detailImage : texture.tailImage;
+	const uint32_t sourceBaseMip = hasDetailImage ? texture.detailMip : texture.tailMip;
+	const uint32_t copyLevelCount = texture.mipLevels - texture.residentMip;
+
+	const uint32_t uploadScope = this->Profiler != nullptr
+		? this->Profiler->BeginScope(commandBuffer, "texture upload")
+		: GpuProfiler::INVALID_SCOPE;
+
+	RecordMipBarrier(
+		commandBuffer, image, texture.residentMip - detailMip, copyLevelCount,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+	// waits for frames already submitted to stop sampling the source
+	RecordMipBarrier(
+		commandBuffer, sourceImage, texture.residentMip - sourceBaseMip, copyLevelCount,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+	std::vector<VkImageCopy> copyRegions;
+	for (uint32_t level = texture.residentMip; level < texture.mipLevels; ++level)
+	{
+		VkImageCopy region = {};
+		region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.srcSubresource.mipLevel = level - sourceBaseMip;
+		region.srcSubresource.baseArrayLayer = 0;
+		region.srcSubresource.layerCount = 1;
+		region.dstSubresource = region.srcSubresource;
+		region.dstSubresource.mipLevel = level - detailMip;
+		region.extent = {
+			std::max(texture.width >> level, 1u),
+			std::max(texture.height >> level, 1u),
+			1
+		};
+
+		copyRegions.push_back(region);
+	}
+
+	vkCmdCopyImage(
+		commandBuffer,
+		sourceImage,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		image,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<uint32_t>(copyRegions.size()),
+		copyRegions.data());
+
+	// the tail image is sampled again once the detail image is evicted
+	RecordMipBarrier(
+		commandBuffer, sourceImage, texture.residentMip - sourceBaseMip, copyLevelCount,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	RecordMipBarrier(
+		commandBuffer, image, texture.residentMip - detailMip, copyLevelCount,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	if (this->Profiler != nullptr)
+	{
+		this->Profiler->EndScope(commandBuffer, uploadScope);
+	}
+
+	if (hasDetailImage)
+	{
+		this->RetireImage(texture.detailImage, texture.detailImageMemory, texture.imageView, texture.detailBytes, frameIndex);
+		this->ResidentBytes -= texture.detailBytes;
+	}
+
+	texture.detailMip = detailMip;
+	texture.detailBytes = GetMipRangeSize(texture, detailMip);
+	texture.detailImage = image;
+	texture.detailImageMemory = imageMemory;
+	texture.imageView = GraphicsPipelineUtils::CreateImageView(
+		image,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_ASPECT_COLOR_BIT,
+		texture.residentMip - detailMip,
+		copyLevelCount,
+		this->vkDevice);
+
+	this->ResidentBytes += texture.detailBytes;
+	this->ResidencyChanged = true;
+}
+
+void VulkanCore::TextureStreamer::UploadDetailMip(uint32_t textureId, uint32_t level, uint64_t frameIndex, VkCommandBuffer commandBuffer)
+{
+	StreamedTexture& texture = this->Textures[textureId];
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	std::vector<VkBufferImageCopy> regions;
+
+	this->StageMips(texture, level, level + 1, texture.detailMip, stagingBuffer, stagingBufferMemory, regions);
+
+	const uint32_t uploadScope = this->Profiler != nullptr
+		? this->Profiler->BeginScope(commandBuffer, "texture upload")
+		: GpuProfiler::INVALID_SCOPE;
+
+	// no view covers this level yet, nothing in flight reads it
+	RecordMipBarrier(
+		commandBuffer, texture.detailImage, level - texture.detailMip, 1,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+	vkCmdCopyBufferToImage(
+		commandBuffer,
+		stagingBuffer,
+		texture.detailImage,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<uint32_t>(regions.size()),
+		regions.data());
+
+	RecordMipBarrier(
+		commandBuffer, texture.detailImage, level - texture.detailMip, 1,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	if (this->Profiler != nullptr)
+	{
+		this->Profiler->EndScope(commandBuffer, uploadScope);
+	}
+
+	// the frame's command buffer reads it once submitted
+	this->RetiredStagingBuffers.push_back({ stagingBuffer, stagingBufferMemory, frameIndex });
+
+	// a new view exposes the level, the previous one only has to outlive the frames still sampling it
+	if (texture.imageView != texture.tailImageView)
+	{
+		this->RetireImage(VK_NULL_HANDLE, VK_NULL_HANDLE, texture.imageView, 0, frameIndex);
+	}
+
+	texture.imageView = GraphicsPipelineUtils::CreateImageView(
+		texture.detailImage,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_ASPECT_COLOR_BIT,
+		level - texture.detailMip,
+		texture.mipLevels - level,
+		this->vkDevice);
+
+	texture.residentMip = level;
+	this->ResidencyChanged = true;
+}
+
+void VulkanCore::TextureStreamer::EvictDetailImage(uint32_t textureId, uint64_t frameIndex)
+{
+	StreamedTexture& texture = this->Textures[textureId];
+
+	this->RetireImage(texture.detailImage, texture.detailImageMemory, texture.imageView, texture.detailBytes, frameIndex);
+	this->ResidentBytes -= texture.detailBytes;
+
+	texture.detailImage = VK_NULL_HANDLE;
+	texture.detailImageMemory = VK_NULL_HANDLE;
+	texture.detailBytes = 0;
+	texture.imageView = texture.tailImageView;
+	texture.residentMip = texture.tailMip;
+	this->ResidencyChanged = true;
+}
+
+void VulkanCore::TextureStreamer::RetireImage(VkImage image, VkDeviceMemory imageMemory, VkImageView imageView, VkDeviceSize size, uint64_t frameIndex)
+{
+	this->RetiredImages.push_back({ image, imageMemory, imageView, size, frameIndex });
+	this->RetiredBytes += size;
+}
+
+void VulkanCore::TextureStreamer::CollectRetiredResources(uint64_t frameIndex, bool force)
+{
+	auto bufferIt = this->RetiredStagingBuffers.begin();
+
+	while (bufferIt != this->RetiredStagingBuffers.end())
+	{
+		if (force || frameIndex >= bufferIt->retireFrame + RETIRE_LATENCY_FRAMES)
+		{
+			vkDestroyBuffer(this->vkDevice, bufferIt->buffer, nullptr);
+			vkFreeMemory(this->vkDevice, bufferIt->bufferMemory, nullptr);
+			bufferIt = this->RetiredStagingBuffers.erase(bufferIt);
+		}
+		else
+		{
+			++bufferIt;
+		}
+	}
+
+	auto it = this->RetiredImages.begin();
+
+	while (it != this->RetiredImages.end())
+	{
+		if (force || frameIndex >= it->retireFrame + RETIRE_LATENCY_FRAMES)
+		{
+			vkDestroyImageView(this->vkDevice, it->imageView, nullptr);
+			vkDestroyImage(this->vkDevice, it->image, nullptr);
+			vkFreeMemory(this->vkDevice, it->imageMemory, nullptr);
+			this->RetiredBytes -= it->size;
+			it = this->RetiredImages.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
@@ -1,16 +1,50 @@
 #include "../Public/RenderEngine.hpp"
 
+const char* VulkanCore::RenderEngine::SAMPLE_COUNT_VARIABLE = "VK_RENDER_MSAA";
+const char* VulkanCore::RenderEngine::NOISE_VARIABLE = "VK_RENDER_NOISE";
+const char* VulkanCore::RenderEngine::MESHLET_CULLING_VARIABLE = "VK_RENDER_MESHLET_CULLING";
+const char* VulkanCore::RenderEngine::PIPELINED_UPDATE_VARIABLE = "VK_RENDER_PIPELINED_UPDATE";
+
+VulkanCore::RenderEngine::RenderEngine(
+	int width,
+	int height,
+	std::string modelPath,
+	std::string baseColorTexturePath,
+	GLFWwindow* window,
+	uint32_t sampleCount,
+	bool postProcessNoise,
+	bool meshletCulling) :
+	ViewportWidth(width),
+	ViewportHeight(height),
+	ModelPath(modelPath),
+	BaseColorTexturePath(baseColorTexturePath),
+	GLWindow(window),
+	RequestedSampleCount(sampleCount),
+	PostProcessNoise(postProcessNoise),
+	MeshletCulling(meshletCulling)
+{
+	if (!this->IsPipelineInitialized)
+	{
+		this->RenderEngine::BootstrapPipeline();
+	}
+}
+
 VulkanCore::RenderEngine::RenderEngine(
 	int width,
 	int height,
 	std::string modelPath,
 	std::string baseColorTexturePath,
-	GLFWwindow* window) :
+	uint32_t sampleCount,
+	bool postProcessNoise,
+	bool meshletCulling) :
 	ViewportWidth(width),
 	ViewportHeight(height),
 	ModelPath(modelPath),
 	BaseColorTexturePath(baseColorTexturePath),
-	GLWindow(window)
+	IsHeadless(true),
+	RequestedSampleCount(sampleCount),
+	PostProcessNoise(postProcessNoise),
+	MeshletCulling(meshletCulling)
 {
 	if (!this->IsPipelineInitialized)
 	{
@@ -33,28 +67,60 @@ void VulkanCore::RenderEngine::BootstrapPipeline()
 	if (this->IsPipelineInitialized)
 		return;
 
-	this->CreateVulkanInstance();
-	this->SetupDebugCallback();
-	this->CreateSurface();
-	this->PickPhysicalDevice();
-	this->CreateLogicalDevice();
-	this->CreateSwapChain();
-	this->CreateImageViews();
-	this->CreateRenderPass();
-	this->CreateDescriptorSetLayout();
-	this->CreateGraphicsPipeline();
-	this->CreateCommandPool();
-	this->CreateDepthResources();
-	this->CreateFrameBuffers();
-	this->LoadTextures();
-	this->CreateTextureViews();
-	this->InitializeSampler();
-	this->CreateGeometryBuffers();
-	this->CreateUniformBuffer();
-	this->CreateDescriptorPool();
-	this->CreateDescriptorSet();
-	this->CreateCommandBuffers();
-	this->CreatePipelineSyncObjects();
+	// every phase is timed, the benchmark harness reports them as load timings
+	this->LoadTimings.clear();
+	this->TraceOutputPath = CpuTrace::EnableFromEnvironment();
+
+	CpuTraceZone bootstrapZone("BootstrapPipeline");
+
+	TaskGraph bootstrap;
+
+	// asset decoding needs no Vulkan objects, it overlaps instance and device creation
+	const auto loadShaders = this->AddLoadPhase(bootstrap, "LoadShaders", &RenderEngine::LoadShaders);
+	const auto decodeTextures = this->AddLoadPhase(bootstrap, "DecodeTextures", &RenderEngine::DecodeTextures);
+	const auto loadModel = this->AddLoadPhase(bootstrap, "LoadModel", &RenderEngine::LoadModel);
+
+	const auto instance = this->AddLoadPhase(bootstrap, "CreateVulkanInstance", &RenderEngine::CreateVulkanInstance);
+	const auto debugCallback = this->AddLoadPhase(bootstrap, "SetupDebugCallback", &RenderEngine::SetupDebugCallback, { instance });
+	const auto surface = this->AddLoadPhase(bootstrap, "CreateSurface", &RenderEngine::CreateSurface, { debugCallback });
+	const auto physicalDevice = this->AddLoadPhase(bootstrap, "PickPhysicalDevice", &RenderEngine::PickPhysicalDevice, { surface });
+	const auto device = this->AddLoadPhase(bootstrap, "CreateLogicalDevice", &RenderEngine::CreateLogicalDevice, { physicalDevice });
+
+	const auto swapChain = this->AddLoadPhase(bootstrap, "CreateSwapChain", &RenderEngine::CreateSwapChain, { device });
+	const auto imageViews = this->AddLoadPhase(bootstrap, "CreateImageViews", &RenderEngine::CreateImageViews, { swapChain });
+	const auto renderGraph = this->AddLoadPhase(bootstrap, "CreateRenderGraph", &RenderEngine::CreateRenderGraph, { swapChain });
+	const auto descriptorSetLayout = this->AddLoadPhase(bootstrap, "CreateDescriptorSetLayout", &RenderEngine::CreateDescriptorSetLayout, { device, loadShaders });
+	this->AddLoadPhase(bootstrap, "CreateGraphicsPipeline", &RenderEngine::CreateGraphicsPipeline, { renderGraph, descriptorSetLayout });
+
+	// the command pool and the graphics queue are externally synchronized, everything recording into them forms one chain
+	const auto commandPool = this->AddLoadPhase(bootstrap, "CreateCommandPool", &RenderEngine::CreateCommandPool, { device });
+	const auto textures = this->AddLoadPhase(bootstrap, "LoadTextures", &RenderEngine::LoadTextures, { commandPool, decodeTextures });
+	const auto textureViews = this->AddLoadPhase(bootstrap, "CreateTextureViews", &RenderEngine::CreateTextureViews, { textures });
+	const auto sampler = this->AddLoadPhase(bootstrap, "InitializeSampler", &RenderEngine::InitializeSampler, { textureViews });
+	const auto geometryBuffers = this->AddLoadPhase(bootstrap, "CreateGeometryBuffers", &RenderEngine::CreateGeometryBuffers, { textures, loadModel });
+	const auto meshletCulling = this->AddLoadPhase(bootstrap, "CreateMeshletCulling", &RenderEngine::CreateMeshletCulling, { geometryBuffers });
+
+	const auto descriptorPool = this->AddLoadPhase(bootstrap, "CreateDescriptorPool", &RenderEngine::CreateDescriptorPool, { swapChain, loadShaders });
+	this->AddLoadPhase(bootstrap, "CreateDescriptorSet", &RenderEngine::CreateDescriptorSet, { descriptorPool, descriptorSetLayout, sampler });
+	this->AddLoadPhase(bootstrap, "CreateCommandBuffers", &RenderEngine::CreateCommandBuffers, { meshletCulling, imageViews });
+	this->AddLoadPhase(bootstrap, "CreatePipelineSyncObjects", &RenderEngine::CreatePipelineSyncObjects, { device });
+	this->AddLoadPhase(bootstrap, "CreateGpuProfiler", &RenderEngine::CreateGpuProfiler, { textures });
+
+	bootstrap.Run(JobSystem::GetShared());
+
+	this->StartTime = std::chrono::high_resolution_clock::now();
+
+	// batch runs render a fixed shader set
+	if (!this->IsHeadless)
+	{
+		// the watch thread keeps its own copy of the stage code, reloads build on top of each other
+		this->HotReloadVertexShaderCode = this->VertexShaderCode;
+		this->HotReloadFragmentShaderCode = this->FragmentShaderCode;
+
+		this->ShaderHotReload = new ShaderWatcher(this->ShaderSourceDirectory, this->ShaderOutputDirectory);
+		this->ShaderHotReload->SetReloadHandler([this](ShaderReloadResult& reload) { return this->PrepareShaderReload(reload); });
+		this->ShaderHotReload->Start();
+	}
 
 	this->IsPipelineInitialized = true;
 }
@@ -64,24 +130,45 @@ void VulkanCore::RenderEngine::CleanPipeline()
 	if (!this->IsPipelineInitialized)
 		return;
 
+	if (this->ShaderHotReload != nullptr)
+	{
+		// pipelines built for reloads that were never applied
+		this->ShaderHotReload->Stop();
+
+		for (const auto& reload : this->ShaderHotReload->ConsumeReloads())
+		{
+			vkDestroyPipeline(this->vkDevice, reload.pipeline, nullptr);
+		}
+	}
+
+	delete this->ShaderHotReload;
+	this->ShaderHotReload = nullptr;
+
 	this->CleanSwapChain();
 
-	vkDestroySampler(this->vkDevice, this->vkTextureSampler, nullptr);
+	delete this->PipelineVariants;
+	this->PipelineVariants = nullptr;
+
+	delete this->NoisePass;
+	this->NoisePass = nullptr;
 
-	vkDestroyImageView(this->vkDevice, this->vkTextureImageView, nullptr);
+	delete this->MeshletCuller;
+	this->MeshletCuller = nullptr;
 
-	vkDestroyImage(this->vkDevice, this->vkTextureImage, nullptr);
-	vkFreeMemory(this->vkDevice, this->vkTextureImageMemory, nullptr);
+	std::cout << "sampler cache: " << this->Samplers->GetSamplerCount() << " samplers, "
+		<< this->Samplers->GetHitCount() << " hits, "
+		<< this->Samplers->GetMissCount() << " misses" << std::endl;
+
+	delete this->Samplers;
+	this->Samplers = nullptr;
+
+	delete this->TextureStreaming;
+	this->TextureStreaming = nullptr;
 
 	vkDestroyDescriptorPool(this->vkDevice, this->vkDescriptorPool, nullptr);
 
 	vkDestroyDescriptorSetLayout(this->vkDevice, this->vkDescriptorSetLayout, nullptr);
 
-	for (size_t i = 0; i < this->vkSwapChainImages.size(); i++) {
-		vkDestroyBuffer(this->vkDevice, this->vkUniformBuffers[i], nullptr);
-		vkFreeMemory(this->vkDevice, this->vkUniformBuffersMemory[i], nullptr);
-	}
-
 	vkDestroyBuffer(this->vkDevice, vkIndexBuffer, nullptr);
 	vkFreeMemory(this->vkDevice, vkIndexBufferMemory, nullptr);
 
@@ -95,22 +182,34 @@ void VulkanCore::RenderEngine::CleanPipeline()
 		vkDestroyFence(this->vkDevice, this->vkInFlightSyncFences[i], nullptr);
 	}
 
+	delete this->Profiler;
+	this->Profiler = nullptr;
+
 	vkDestroyCommandPool(this->vkDevice, this->vkCommandPool, nullptr);
 
 	vkDestroyDevice(this->vkDevice, nullptr);
-	if (this->enableValidationLayers)
+	if (this->UseValidationLayers)
 	{
 		this->DestroyVkDebugReportCallback(this->vkInstance, this->vkCallback, nullptr);
 	}
-	vkDestroySurfaceKHR(this->vkInstance, this->vkSurface, nullptr);
+	if (!this->IsHeadless)
+	{
+		vkDestroySurfaceKHR(this->vkInstance, this->vkSurface, nullptr);
+	}
 	vkDestroyInstance(this->vkInstance, nullptr);
 
+	if (!this->TraceOutputPath.empty())
+	{
+		CpuTrace::WriteChromeTrace(this->TraceOutputPath);
+		std::cout << "cpu trace written to " << this->TraceOutputPath << std::endl;
+	}
+
 	this->IsPipelineInitialized = false;
 }
 
 void VulkanCore::RenderEngine::Draw()
 {
-	if (this->ThrottleCheck())
+	if (!this->IsHeadless && this->ThrottleCheck())
 	{
 		return;
 	}
@@ -120,20 +219,59 @@ void VulkanCore::RenderEngine::Draw()
 			std::chrono::system_clock::now()
 		);	 
 
-	vkWaitForFences(this->vkDevice, 1, &this->vkInFlightSyncFences[this->currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
-	vkResetFences(this->vkDevice, 1, &this->vkInFlightSyncFences[this->currentFrame]);
+	CpuTraceZone drawZone("Draw");
+
+	{
+		CpuTraceZone zone("Draw.ApplyShaderReloads");
+		this->ApplyShaderReloads();
+	}
+
+	{
+		CpuTraceZone zone("Draw.WaitForFence");
+		vkWaitForFences(this->vkDevice, 1, &this->vkInFlightSyncFences[this->currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+		vkResetFences(this->vkDevice, 1, &this->vkInFlightSyncFences[this->currentFrame]);
+	}
+
+	this->DestroyRetiredPipelines(false);
+
+	// the slot's queries finished with its fence, uploads below already record into the new frame
+	this->Profiler->CollectResults(static_cast<uint32_t>(this->currentFrame));
+	this->Profiler->BeginFrame(static_cast<uint32_t>(this->currentFrame), this->frameNumber);
+
+	if (this->ProfilerLogInterval != 0 && this->frameNumber != 0 && this->frameNumber % this->ProfilerLogInterval == 0)
+	{
+		std::cout << this->Profiler->FormatStatistics() << std::endl;
+	}
 
 	uint32_t imageIndex;
+	VkResult result = VK_SUCCESS;
 
-	const VkResult result = vkAcquireNextImageKHR(
-		this->vkDevice,
-		this->vkSwapChain,
-		std::numeric_limits<uint64_t>::max(),
-		this->vkImageAvailableSemLocks[this->currentFrame],
-		nullptr,
-		&imageIndex);
+	if (this->IsHeadless)
+	{
+		// offscreen images are paired with the frames in flight, the frame fence also guards the image
+		imageIndex = static_cast<uint32_t>(this->currentFrame);
+	}
+	else
+	{
+		CpuTraceZone zone("Draw.AcquireImage");
+		result = vkAcquireNextImageKHR(
+			this->vkDevice,
+			this->vkSwapChain,
+			std::numeric_limits<uint64_t>::max(),
+			this->vkImageAvailableSemLocks[this->currentFrame],
+			nullptr,
+			&imageIndex);
+	}
+
+	{
+		CpuTraceZone zone("Draw.UpdateFrameConstants");
+		this->UpdateFrameConstants();
+	}
 
-	this->UpdateUniformBuffer(imageIndex);
+	{
+		CpuTraceZone zone("Draw.RecordCommandBuffer");
+		this->RecordCommandBuffer(this->vkCommandBuffers[this->currentFrame], imageIndex);
+	}
 
 	VkSubmitInfo submitInfo = {};
 
@@ -141,20 +279,33 @@ void VulkanCore::RenderEngine::Draw()
 	VkSemaphore waitLocks[] = { this->vkImageAvailableSemLocks[this->currentFrame] };
 
 	VkPipelineStageFlags waitFlags[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.waitSemaphoreCount = this->IsHeadless ? 0 : 1;
 	submitInfo.pWaitSemaphores = waitLocks;
 	submitInfo.pWaitDstStageMask = waitFlags;
 
 	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &this->vkCommandBuffers[imageIndex];
+	submitInfo.pCommandBuffers = &this->vkCommandBuffers[this->currentFrame];
 
 	VkSemaphore signalLocks[] = { this->vkRenderFinishedSemLocks[this->currentFrame] };
-	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.signalSemaphoreCount = this->IsHeadless ? 0 : 1;
 	submitInfo.pSignalSemaphores = signalLocks;
 
-	if (vkQueueSubmit(this->vkGraphicsQueue, 1, &submitInfo, this->vkInFlightSyncFences[this->currentFrame]) != VK_SUCCESS)
 	{
-		throw std::runtime_error("Failed to submit draw commands");
+		CpuTraceZone zone("Draw.Submit");
+
+		if (vkQueueSubmit(this->vkGraphicsQueue, 1, &submitInfo, this->vkInFlightSyncFences[this->currentFrame]) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to submit draw commands");
+		}
+	}
+
+	if (this->IsHeadless)
+	{
+		this->LastRenderedImage = imageIndex;
+
+		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		frameNumber++;
+		return;
 	}
 
 	VkPresentInfoKHR presentInfo = {};
@@ -169,7 +320,10 @@ void VulkanCore::RenderEngine::Draw()
 	presentInfo.pImageIndices = &imageIndex;
 	presentInfo.pResults = nullptr; // Optional param
 
-	vkQueuePresentKHR(this->vkPresentQueue, &presentInfo);
+	{
+		CpuTraceZone zone("Draw.Present");
+		vkQueuePresentKHR(this->vkPresentQueue, &presentInfo);
+	}
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || FrameBufferResized)
 	{
@@ -183,6 +337,7 @@ void VulkanCore::RenderEngine::Draw()
 	}
 
 	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	frameNumber++;
 }
 
 void VulkanCore::RenderEngine::WaitDevice()
@@ -190,37 +345,278 @@ void VulkanCore::RenderEngine::WaitDevice()
 	vkDeviceWaitIdle(this->vkDevice);
 }
 
+void VulkanCore::RenderEngine::ReadbackFrame(std::vector<uint8_t>& pixels)
+{
+	if (!this->IsHeadless)
+	{
+		throw std::runtime_error("frame readback is only available in headless mode!");
+	}
 
-void VulkanCore::RenderEngine::CreateFrameBuffers()
+	if (this->frameNumber == 0)
+	{
+		throw std::runtime_error("no frame has been rendered yet!");
+	}
+
+	vkQueueWaitIdle(this->vkGraphicsQueue);
+
+	const VkDeviceSize imageSize = static_cast<VkDeviceSize>(this->vkExtent.width) * this->vkExtent.height * 4;
+
+	VkBuffer readbackBuffer;
+	VkDeviceMemory readbackBufferMemory;
+
+	MemoryUtils::CreateBuffer(
+		imageSize,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		this->vkDevice,
+		this->vkPhysicalDevice,
+		readbackBuffer,
+		readbackBufferMemory);
+
+	VkCommandBuffer commandBuffer = GraphicsPipelineUtils::BeginSingleTimeCommands(this->vkDevice, this->vkCommandPool);
+
+	VkBufferImageCopy region = {};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { this->vkExtent.width, this->vkExtent.height, 1 };
+
+	vkCmdCopyImageToBuffer(
+		commandBuffer,
+		this->vkSwapChainImages[this->LastRenderedImage],
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		readbackBuffer,
+		1, &region);
+
+	GraphicsPipelineUtils::EndSingleTimeCommands(this->vkDevice, this->vkCommandPool, this->vkGraphicsQueue, commandBuffer);
+
+	pixels.resize(static_cast<size_t>(imageSize));
+
+	void* data;
+	vkMapMemory(this->vkDevice, readbackBufferMemory, 0, imageSize, 0, &data);
+	memcpy(pixels.data(), data, static_cast<size_t>(imageSize));
+	vkUnmapMemory(this->vkDevice, readbackBufferMemory);
+
+	vkDestroyBuffer(this->vkDevice, readbackBuffer, nullptr);
+	vkFreeMemory(this->vkDevice, readbackBufferMemory, nullptr);
+}
+
+uint32_t VulkanCore::RenderEngine::GetFrameWidth() const
+{
+	return this->vkExtent.width;
+}
+
+uint32_t VulkanCore::RenderEngine::GetFrameHeight() const
+{
+	return this->vkExtent.height;
+}
+
+
+void VulkanCore::RenderEngine::SetFixedTimestep(double seconds)
 {
-	this->vkSwapChainFrameBuffers.resize(this->vkSwapChainImageViews.size());
+	this->FixedTimestep = seconds;
+}
 
-	for (size_t i = 0; i < this->vkSwapChainImageViews.size(); ++i)
+void VulkanCore::RenderEngine::SetPipelinedUpdate(bool enabled)
+{
+	if (enabled && !this->PipelinedUpdate)
 	{
-		std::array<VkImageView, 2> attachments = {
-			this->vkSwapChainImageViews[i],
-			this->vkDepthImagesView[i]
-		};
+		this->UpdateNumber = this->frameNumber;
+		this->UpdateFramePacket();
+
+		std::lock_guard<std::mutex> lock(this->FramePacketLock);
+		this->FramePacketWaitCancelled = false;
+	}
 
-		VkFramebufferCreateInfo frameBufferCreateInfo = {};
+	this->PipelinedUpdate = enabled;
+}
 
-		frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		frameBufferCreateInfo.renderPass = this->vkRenderPass;
-		frameBufferCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-		frameBufferCreateInfo.pAttachments = attachments.data();
-		frameBufferCreateInfo.width = this->vkExtent.width;
-		frameBufferCreateInfo.height = this->vkExtent.height;
-		frameBufferCreateInfo.layers = 1;
+bool VulkanCore::RenderEngine::IsPipelinedUpdate() const
+{
+	return this->PipelinedUpdate;
+}
 
-		if (vkCreateFramebuffer(
-			this->vkDevice,
-			&frameBufferCreateInfo,
-			nullptr,
-			&this->vkSwapChainFrameBuffers[i]) != VK_SUCCESS)
+void VulkanCore::RenderEngine::UpdateFramePacket()
+{
+	FramePacket& packet = this->FramePackets.GetWriteSlot();
+	packet.updateNumber = this->UpdateNumber++;
+
+	this->BuildFramePacket(packet);
+	this->FramePackets.Publish();
+}
+
+bool VulkanCore::RenderEngine::WaitForFramePacketConsumed()
+{
+	std::unique_lock<std::mutex> lock(this->FramePacketLock);
+
+	this->FramePacketSignal.wait(lock, [this]() {
+		return this->FramePacketWaitCancelled || !this->FramePackets.IsPending();
+	});
+
+	return !this->FramePacketWaitCancelled;
+}
+
+void VulkanCore::RenderEngine::CancelFramePacketWait()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->FramePacketLock);
+		this->FramePacketWaitCancelled = true;
+	}
+
+	this->FramePacketSignal.notify_all();
+}
+
+const std::vector<std::pair<std::string, double>>& VulkanCore::RenderEngine::GetLoadTimings() const
+{
+	return this->LoadTimings;
+}
+
+bool VulkanCore::RenderEngine::GetLastGpuFrameTime(uint64_t& frameIndex, double& milliseconds) const
+{
+	return this->Profiler->GetLastScopeTime("frame", frameIndex, milliseconds);
+}
+
+const VulkanCore::GpuProfiler* VulkanCore::RenderEngine::GetGpuProfiler() const
+{
+	return this->Profiler;
+}
+
+const VulkanCore::RenderGraph* VulkanCore::RenderEngine::GetRenderGraph() const
+{
+	return this->FrameGraph;
+}
+
+uint32_t VulkanCore::RenderEngine::GetSampleCount() const
+{
+	return static_cast<uint32_t>(this->SampleCount);
+}
+
+uint32_t VulkanCore::RenderEngine::GetModelLod() const
+{
+	return this->ModelLod;
+}
+
+const std::vector<VulkanCore::MeshLod>& VulkanCore::RenderEngine::GetModelLods() const
+{
+	return this->ModelMesh.lods;
+}
+
+const std::vector<VulkanCore::Meshlet>& VulkanCore::RenderEngine::GetModelMeshlets() const
+{
+	return this->ModelMesh.meshlets;
+}
+
+uint32_t VulkanCore::RenderEngine::CountVisibleMeshlets() const
+{
+	std::atomic<uint32_t> visibleCount{ 0 };
+
+	JobSystem::GetShared().ParallelFor("CountVisibleMeshlets", 0, this->CullingConstants.meshletCount, 256, [&](size_t begin, size_t end) {
+		uint32_t chunkVisibleCount = 0;
+
+		for (size_t i = begin; i < end; i++)
 		{
-			throw std::runtime_error("Failed to create frame buffer!");
+			const Meshlet& meshlet = this->ModelMesh.meshlets[this->CullingConstants.firstMeshlet + i];
+
+			if (MeshletBuilder::IsVisible(meshlet, this->CullingConstants.cameraPosition, this->CullingConstants.frustumPlanes))
+			{
+				chunkVisibleCount++;
+			}
 		}
+
+		visibleCount.fetch_add(chunkVisibleCount);
+	});
+
+	return visibleCount.load();
+}
+
+uint32_t VulkanCore::RenderEngine::GetSampleCountFromEnvironment()
+{
+	const char* value = std::getenv(SAMPLE_COUNT_VARIABLE);
+
+	if (value == nullptr || *value == '\0')
+	{
+		return 1;
+	}
+
+	return static_cast<uint32_t>(std::max(std::atoi(value), 1));
+}
+
+bool VulkanCore::RenderEngine::GetPostProcessNoiseFromEnvironment()
+{
+	const char* value = std::getenv(NOISE_VARIABLE);
+
+	return value != nullptr && *value != '\0' && std::string(value) != "0";
+}
+
+bool VulkanCore::RenderEngine::GetMeshletCullingFromEnvironment()
+{
+	const char* value = std::getenv(MESHLET_CULLING_VARIABLE);
+
+	return value != nullptr && *value != '\0' && std::string(value) != "0";
+}
+
+bool VulkanCore::RenderEngine::GetPipelinedUpdateFromEnvironment()
+{
+	const char* value = std::getenv(PIPELINED_UPDATE_VARIABLE);
+
+	return value != nullptr && *value != '\0' && std::string(value) != "0";
+}
+
+std::string VulkanCore::RenderEngine::GetDeviceName() const
+{
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(this->vkPhysicalDevice, &deviceProperties);
+
+	return deviceProperties.deviceName;
+}
+
+VkDeviceSize VulkanCore::RenderEngine::GetTextureResidentBytes() const
+{
+	return this->TextureStreaming->GetResidentBytes();
+}
+
+void VulkanCore::RenderEngine::RunLoadPhase(const char* name, void (RenderEngine::*phase)())
+{
+	const auto phaseStart = std::chrono::high_resolution_clock::now();
+
+	(this->*phase)();
+
+	const auto phaseEnd = std::chrono::high_resolution_clock::now();
+
+	std::lock_guard<std::mutex> lock(this->LoadTimingsLock);
+	this->LoadTimings.emplace_back(name, std::chrono::duration<double, std::milli>(phaseEnd - phaseStart).count());
+}
+
+VulkanCore::TaskGraph::TaskId VulkanCore::RenderEngine::AddLoadPhase(
+	TaskGraph& bootstrap,
+	const char* name,
+	void (RenderEngine::*phase)(),
+	const std::vector<TaskGraph::TaskId>& dependencies)
+{
+	return bootstrap.AddTask(name, [this, name, phase]() { this->RunLoadPhase(name, phase); }, dependencies);
+}
+
+void VulkanCore::RenderEngine::CreateGpuProfiler()
+{
+	const QueueFamilyIndices indices = this->FindQueueFamilies(this->vkPhysicalDevice);
+
+	this->Profiler = new GpuProfiler(
+		this->vkDevice,
+		this->vkPhysicalDevice,
+		indices.graphicsFamily,
+		MAX_FRAMES_IN_FLIGHT);
+
+	if (!this->Profiler->IsSupported())
+	{
+		std::cout << "graphics queue has no timestamp support, GPU frame times are not available" << std::endl;
 	}
+
+	this->TextureStreaming->SetProfiler(this->Profiler);
 }
 
 void VulkanCore::RenderEngine::CreateCommandPool()
@@ -231,7 +627,8 @@ void VulkanCore::RenderEngine::CreateCommandPool()
 
 	poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	poolCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
-	poolCreateInfo.flags = 0; // Optional param
+	// command buffers are rerecorded every frame
+	poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
 	if (vkCreateCommandPool(this->vkDevice, &poolCreateInfo, nullptr, &this->vkCommandPool) != VK_SUCCESS)
 	{
@@ -241,7 +638,7 @@ void VulkanCore::RenderEngine::CreateCommandPool()
 
 void VulkanCore::RenderEngine::CreateCommandBuffers()
 {
-	this->vkCommandBuffers.resize(this->vkSwapChainFrameBuffers.size());
+	this->vkCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
 	VkCommandBufferAllocateInfo allocInfo = {};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -252,62 +649,102 @@ void VulkanCore::RenderEngine::CreateCommandBuffers()
 	if (vkAllocateCommandBuffers(this->vkDevice, &allocInfo, this->vkCommandBuffers.data()) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to allocate command buffers!");
 	}
+}
 
-	for (size_t i = 0; i < this->vkCommandBuffers.size(); i++) {
-		VkCommandBufferBeginInfo beginInfo = {};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-		beginInfo.pInheritanceInfo = nullptr; // Optional
+void VulkanCore::RenderEngine::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+	vkResetCommandBuffer(commandBuffer, 0);
 
-		if (vkBeginCommandBuffer(this->vkCommandBuffers[i], &beginInfo) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to begin recording command buffer!");
-		}
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = nullptr; // Optional
 
-		VkRenderPassBeginInfo renderPassInfo = {};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = this->vkRenderPass;
-		renderPassInfo.framebuffer = this->vkSwapChainFrameBuffers[i];
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to begin recording command buffer!");
+	}
 
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = this->vkExtent;
+	const uint32_t frameScope = this->Profiler->BeginScope(commandBuffer, "frame");
 
-		std::array<VkClearValue, 2> clearValues = {};
-		clearValues[0].color = { 0.7f, 0.76f, 0.8f, 0.95f };
-		clearValues[1].depthStencil = { 1.0f, 0 };
+	// mip uploads go first, the texture descriptor is rewritten before the main pass binds the set
+	{
+		CpuTraceZone zone("Draw.UpdateTextureStreaming");
+		this->UpdateTextureStreaming(commandBuffer);
+	}
 
-		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-		renderPassInfo.pClearValues = clearValues.data();
+	// dispatches cannot be recorded inside the main pass, the draws it reads are produced up front
+	if (this->MeshletCuller != nullptr)
+	{
+		const uint32_t cullingScope = this->Profiler->BeginScope(commandBuffer, "meshlet culling");
+		this->MeshletCuller->Record(commandBuffer, static_cast<uint32_t>(this->currentFrame), this->CullingConstants);
+		this->Profiler->EndScope(commandBuffer, cullingScope);
+	}
 
-		vkCmdBeginRenderPass(this->vkCommandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	this->RecordingImageIndex = imageIndex;
+	this->FrameGraph->SetImportedImage(this->BackBufferResource, this->vkSwapChainImages[imageIndex], this->vkSwapChainImageViews[imageIndex]);
 
-		vkCmdBindPipeline(this->vkCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, this->vkGraphicsPipeline);
+	// every graph pass is timed as its own profiler scope
+	this->FrameGraph->Execute(commandBuffer, this->Profiler);
 
-		VkBuffer vertexBuffers[] = { this->vkVertexBuffer };
-		VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(
-			this->vkCommandBuffers[i],
-			0, 1,
-			vertexBuffers, offsets);
+	this->Profiler->EndScope(commandBuffer, frameScope);
 
-		vkCmdBindIndexBuffer(
-			this->vkCommandBuffers[i],
-			this->vkIndexBuffer,
-			0, VK_INDEX_TYPE_UINT32);
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record command buffer!");
+	}
+}
 
-		vkCmdBindDescriptorSets(
-			this->vkCommandBuffers[i],
-			VK_PIPELINE_BIND_POINT_GRAPHICS,
-			this->vkPipelineLayout,
-			0, 1,
-			&this->vkDescriptorSets[i], 0, nullptr);
+void VulkanCore::RenderEngine::RecordMainPass(VkCommandBuffer commandBuffer)
+{
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->vkGraphicsPipeline);
 
-		vkCmdDrawIndexed(this->vkCommandBuffers[i], static_cast<uint32_t>(Vertex::GetSampleVertexIndices().size()), 1, 0, 0, 0);
+	VkBuffer vertexBuffers[] = { this->vkVertexBuffer };
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(
+		commandBuffer,
+		0, 1,
+		vertexBuffers, offsets);
 
-		vkCmdEndRenderPass(this->vkCommandBuffers[i]);
+	vkCmdBindIndexBuffer(
+		commandBuffer,
+		this->vkIndexBuffer,
+		0, VK_INDEX_TYPE_UINT32);
 
-		if (vkEndCommandBuffer(this->vkCommandBuffers[i]) != VK_SUCCESS) {
-			throw std::runtime_error("failed to record command buffer!");
+	vkCmdBindDescriptorSets(
+		commandBuffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		this->vkPipelineLayout,
+		0, 1,
+		&this->vkDescriptorSets[this->currentFrame], 0, nullptr);
+
+	this->PushDrawConstants(commandBuffer, this->ModelDrawConstants);
+
+	const MeshLod& lod = this->ModelMesh.lods[this->ModelLod];
+
+	if (this->MeshletCuller != nullptr)
+	{
+		this->MeshletCuller->Draw(commandBuffer, static_cast<uint32_t>(this->currentFrame), lod.firstMeshlet, lod.meshletCount);
+	}
+	else
+	{
+		vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
+	}
+}
+
+void VulkanCore::RenderEngine::PushDrawConstants(VkCommandBuffer commandBuffer, const DrawPushConstants& drawConstants) const
+{
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(&drawConstants);
+
+	// every reflected range receives the part of the block it declares, with the stages it was declared for
+	for (const auto& range : this->PushConstantRanges)
+	{
+		if (range.offset >= sizeof(DrawPushConstants))
+		{
+			continue;
 		}
+
+		const uint32_t size = std::min(range.size, static_cast<uint32_t>(sizeof(DrawPushConstants)) - range.offset);
+
+		vkCmdPushConstants(commandBuffer, this->vkPipelineLayout, range.stageFlags, range.offset, size, data + range.offset);
 	}
 }
 
@@ -337,32 +774,34 @@ void VulkanCore::RenderEngine::CreatePipelineSyncObjects()
 
 void VulkanCore::RenderEngine::CleanSwapChain()
 {
-	for (size_t i = 0; i < this->vkSwapChainImages.size(); i++) {
-		vkDestroyImageView(this->vkDevice, this->vkDepthImagesView[i], nullptr);
-		vkDestroyImage(this->vkDevice, this->vkDepthImages[i], nullptr);
-		vkFreeMemory(this->vkDevice, this->vkDepthImagesMemory[i], nullptr);
-	}
-
-	for (auto frameBuffer : this->vkSwapChainFrameBuffers)
-	{
-		vkDestroyFramebuffer(this->vkDevice, frameBuffer, nullptr);
-	}
-
 	vkFreeCommandBuffers(
 		this->vkDevice,
 		this->vkCommandPool,
 		static_cast<uint32_t>(this->vkCommandBuffers.size()),
 		this->vkCommandBuffers.data());
 
-	vkDestroyPipeline(this->vkDevice, this->vkGraphicsPipeline, nullptr);
+	this->PipelineVariants->Clear();
+	this->DestroyRetiredPipelines(true);
 	vkDestroyPipelineLayout(this->vkDevice, this->vkPipelineLayout, nullptr);
-	vkDestroyRenderPass(this->vkDevice, this->vkRenderPass, nullptr);
+
+	delete this->FrameGraph;
+	this->FrameGraph = nullptr;
 
 	for (auto imageView : this->vkSwapChainImageViews) {
 		vkDestroyImageView(this->vkDevice, imageView, nullptr);
 	}
 
-	vkDestroySwapchainKHR(this->vkDevice, this->vkSwapChain, nullptr);
+	if (this->IsHeadless)
+	{
+		for (size_t i = 0; i < this->vkSwapChainImages.size(); i++) {
+			vkDestroyImage(this->vkDevice, this->vkSwapChainImages[i], nullptr);
+			vkFreeMemory(this->vkDevice, this->vkOffscreenImagesMemory[i], nullptr);
+		}
+	}
+	else
+	{
+		vkDestroySwapchainKHR(this->vkDevice, this->vkSwapChain, nullptr);
+	}
 }
 
 void VulkanCore::RenderEngine::UpdateSwapChain()
@@ -375,15 +814,18 @@ void VulkanCore::RenderEngine::UpdateSwapChain()
 
 	vkDeviceWaitIdle(this->vkDevice);
 
+	// the render pass, layout and extent change under a pipeline the watch thread may be building
+	std::lock_guard<std::mutex> lock(this->PipelineStateLock);
+
 	this->CleanSwapChain();
 
 	this->CreateSwapChain();
 	this->CreateImageViews();
-	this->CreateRenderPass();
+	this->CreateRenderGraph();
 	this->CreateGraphicsPipeline();
-	this->CreateDepthResources();
-	this->CreateFrameBuffers();
 	this->CreateCommandBuffers();
+
+	this->PipelineGeneration++;
 }
 
 void VulkanCore::RenderEngine::InitializeSampler()
@@ -402,69 +844,56 @@ void VulkanCore::RenderEngine::InitializeSampler()
 	samplerInfo.compareEnable = VK_FALSE;
 	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = static_cast<float>(this->TextureStreaming->GetMipLevels(this->BaseColorTextureId));
 
-	if (vkCreateSampler(this->vkDevice, &samplerInfo, nullptr, &this->vkTextureSampler) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create texture sampler!");
+	if (this->Samplers == nullptr)
+	{
+		this->Samplers = new SamplerCache(this->vkDevice, this->vkPhysicalDevice);
 	}
+
+	this->vkTextureSampler = this->Samplers->GetSampler(samplerInfo);
 }
 
 void VulkanCore::RenderEngine::CreateDescriptorSet()
 {
-	std::vector<VkDescriptorSetLayout> layouts(this->vkSwapChainImages.size(), this->vkDescriptorSetLayout);
+	std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, this->vkDescriptorSetLayout);
 	VkDescriptorSetAllocateInfo allocInfo = {};
 	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	allocInfo.descriptorPool = this->vkDescriptorPool;
-	allocInfo.descriptorSetCount = static_cast<uint32_t>(this->vkSwapChainImages.size());
+	allocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
 	allocInfo.pSetLayouts = layouts.data();
 
-	this->vkDescriptorSets.resize(this->vkSwapChainImages.size());
+	this->vkDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
 	if (vkAllocateDescriptorSets(this->vkDevice, &allocInfo, &this->vkDescriptorSets[0]) != VK_SUCCESS) {
 		throw std::runtime_error("failed to allocate descriptor sets!");
 	}
 
-	for (size_t i = 0; i < this->vkSwapChainImages.size(); i++) {
-		VkDescriptorBufferInfo bufferInfo = {};
-		bufferInfo.buffer = this->vkUniformBuffers[i];
-		bufferInfo.offset = 0;
-		bufferInfo.range = sizeof(UniformBufferObject);
-
-		VkDescriptorImageInfo imageInfo = {};
-		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imageInfo.imageView = this->vkTextureImageView;
-		imageInfo.sampler = this->vkTextureSampler;
-
-		std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
-
-		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[0].dstSet = this->vkDescriptorSets[i];
-		descriptorWrites[0].dstBinding = 0;
-		descriptorWrites[0].dstArrayElement = 0;
-		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		descriptorWrites[0].descriptorCount = 1;
-		descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[1].dstSet = this->vkDescriptorSets[i];
-		descriptorWrites[1].dstBinding = 1;
-		descriptorWrites[1].dstArrayElement = 0;
-		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		descriptorWrites[1].descriptorCount = 1;
-		descriptorWrites[1].pImageInfo = &imageInfo;
-
-		descriptorWrites[0].pImageInfo = nullptr; // Optional
-		descriptorWrites[0].pTexelBufferView = nullptr; // Optional
-
-		vkUpdateDescriptorSets(
-			this->vkDevice,
-			static_cast<uint32_t>(descriptorWrites.size()),
-			descriptorWrites.data(),
-			0,
-			nullptr);
+	this->DescriptorTextureViews.assign(MAX_FRAMES_IN_FLIGHT, this->vkTextureImageView);
+
+	// the writes follow the reflected layout, a binding the engine has nothing for fails here instead of at draw time
+	const std::vector<VkDescriptorSetLayoutBinding> bindings = this->ShaderLayout.GetDescriptorSetLayoutBindings(0);
+
+	if (bindings.size() != 1 || bindings[0].descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+	{
+		throw std::runtime_error("the base shaders must declare exactly one descriptor, the base color texture sampler");
+	}
+
+	this->BaseColorTextureBinding = bindings[0].binding;
+
+	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		this->UpdateTextureDescriptor(i);
 	}
 }
 
 void VulkanCore::RenderEngine::CreateSwapChain()
 {
+	if (this->IsHeadless)
+	{
+		this->CreateOffscreenTargets();
+		return;
+	}
+
 	const SwapChainSupportDetails swapChainSupportDetails = QuerySwapChainSupport(this->vkPhysicalDevice, this->vkSurface);
 
 	const VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupportDetails.formats);
@@ -490,6 +919,17 @@ void VulkanCore::RenderEngine::CreateSwapChain()
 	createInfo.imageArrayLayers = 1;
 	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+	// post-processed frames are blitted into the swap chain image
+	if (this->PostProcessNoise)
+	{
+		if ((swapChainSupportDetails.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) == 0)
+		{
+			throw std::runtime_error("swap chain images cannot be post-processed, they do not support transfers!");
+		}
+
+		createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	}
+
 	QueueFamilyIndices indices = FindQueueFamilies(this->vkPhysicalDevice);
 
 	uint32_t queueFamilyIndicies[] = {
@@ -531,7 +971,38 @@ void VulkanCore::RenderEngine::CreateSwapChain()
 	this->vkSwapChainImageColorSpace = surfaceFormat.colorSpace;
 }
 
+// headless frames go to plain color images standing in for the swap chain images, one per frame in flight
+void VulkanCore::RenderEngine::CreateOffscreenTargets()
+{
+	this->vkExtent = { static_cast<uint32_t>(this->ViewportWidth), static_cast<uint32_t>(this->ViewportHeight) };
+	this->vkSwapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	this->vkSwapChainImageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+
+	this->vkSwapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+	this->vkOffscreenImagesMemory.resize(MAX_FRAMES_IN_FLIGHT);
+
+	for (size_t i = 0; i < this->vkSwapChainImages.size(); i++) {
+		MemoryUtils::CreateImage(
+			this->vkExtent.width,
+			this->vkExtent.height,
+			this->vkSwapChainImageFormat,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			this->vkSwapChainImages[i],
+			this->vkOffscreenImagesMemory[i],
+			this->vkDevice,
+			this->vkPhysicalDevice
+		);
+	}
+}
+
 void VulkanCore::RenderEngine::CreateSurface() {
+	if (this->IsHeadless)
+	{
+		return;
+	}
+
 	/*VkWin32SurfaceCreateInfoKHR createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
 	createInfo.hwnd = glfwGetWin32Window(this->window);
@@ -550,7 +1021,7 @@ void VulkanCore::RenderEngine::CreateSurface() {
 
 void VulkanCore::RenderEngine::SetupDebugCallback()
 {
-	if (!this->enableValidationLayers)
+	if (!this->UseValidationLayers)
 	{
 		return;
 	}
@@ -581,99 +1052,43 @@ void VulkanCore::RenderEngine::CreateImageViews()
 	}
 }
 
-void VulkanCore::RenderEngine::LoadTextures()
+void VulkanCore::RenderEngine::DecodeTextures()
 {
-	int textureWidth, textureHeight, textureChannels;
-
-	this->PixelBuffer = ShaderExtensions::CreateTextureImage(this->BaseColorTexturePath.c_str(), &textureWidth, &textureHeight, &textureChannels);
-
-	VkDeviceSize imageSize = textureWidth * textureHeight * 4;
+	this->DecodedBaseColorTexture = TextureStreamer::DecodeTexture(this->BaseColorTexturePath);
+}
 
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	MemoryUtils::CreateBuffer(
-		imageSize,
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+void VulkanCore::RenderEngine::LoadTextures()
+{
+	this->TextureStreaming = new TextureStreamer(
 		this->vkDevice,
 		this->vkPhysicalDevice,
-		stagingBuffer,
-		stagingBufferMemory);
-
-	void* data;
-	vkMapMemory(this->vkDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, this->PixelBuffer, static_cast<size_t>(imageSize));
-	vkUnmapMemory(this->vkDevice, stagingBufferMemory);
-
-	stbi_image_free(this->PixelBuffer);
-
-	MemoryUtils::CreateImage(
-		textureWidth,
-		textureHeight,
-		VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		this->vkTextureImage,
-		this->vkTextureImageMemory,
-		this->vkDevice,
-		this->vkPhysicalDevice);
-
-	MemoryUtils::TransitionImageLayout(
-		this->vkTextureImage,
-		VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_LAYOUT_UNDEFINED,
-		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		this->vkDevice,
-		this->vkCommandPool,
-		this->vkGraphicsQueue);
-	MemoryUtils::CopyBufferToImage(
-		stagingBuffer,
-		this->vkTextureImage,
-		static_cast<uint32_t>(textureWidth),
-		static_cast<uint32_t>(textureHeight),
-		this->vkDevice,
-		this->vkCommandPool,
-		this->vkGraphicsQueue);
-	MemoryUtils::TransitionImageLayout(
-		this->vkTextureImage,
-		VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		this->vkDevice,
 		this->vkCommandPool,
 		this->vkGraphicsQueue);
 
-	vkDestroyBuffer(this->vkDevice, stagingBuffer, nullptr);
-	vkFreeMemory(this->vkDevice, stagingBufferMemory, nullptr);
+	this->BaseColorTextureId = this->TextureStreaming->RegisterTexture(std::move(this->DecodedBaseColorTexture));
 }
 
 void VulkanCore::RenderEngine::CreateTextureViews()
 {
-	this->vkTextureImageView = GraphicsPipelineUtils::CreateImageView(
-		this->vkTextureImage,
-		VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_ASPECT_COLOR_BIT,
-		this->vkDevice);
+	this->vkTextureImageView = this->TextureStreaming->GetImageView(this->BaseColorTextureId);
+}
+
+void VulkanCore::RenderEngine::LoadShaders()
+{
+	this->VertexShaderCode = ShaderExtensions::ReadSpirvFile(this->VertexShaderPath);
+	this->FragmentShaderCode = ShaderExtensions::ReadSpirvFile(this->FragmentShaderPath);
+
+	this->ShaderLayout = ShaderReflection::Reflect(this->VertexShaderCode, this->VertexShaderPath);
+	this->ShaderLayout.Merge(ShaderReflection::Reflect(this->FragmentShaderCode, this->FragmentShaderPath));
+
+	auto attributeDescriptions = Vertex::GetAttributeDescriptions();
+	this->ShaderLayout.ValidateVertexInputs(attributeDescriptions.data(), attributeDescriptions.size());
 }
 
 void VulkanCore::RenderEngine::CreateDescriptorSetLayout()
 {
-	VkDescriptorSetLayoutBinding uboLayoutBinding = {};
-	uboLayoutBinding.binding = 0;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboLayoutBinding.descriptorCount = 1;
-	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-	uboLayoutBinding.pImmutableSamplers = nullptr;
-
-	VkDescriptorSetLayoutBinding samplerLayoutBinding = {};
-	samplerLayoutBinding.binding = 1;
-	samplerLayoutBinding.descriptorCount = 1;
-	samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	samplerLayoutBinding.pImmutableSamplers = nullptr;
-	samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-	std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
+	const std::vector<VkDescriptorSetLayoutBinding> bindings = this->ShaderLayout.GetDescriptorSetLayoutBindings(0);
+
 	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
 	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -684,27 +1099,75 @@ void VulkanCore::RenderEngine::CreateDescriptorSetLayout()
 	}
 }
 
+void VulkanCore::RenderEngine::CreatePipelineLayout()
+{
+	const std::vector<VkPushConstantRange> pushConstantRanges = this->ShaderLayout.GetPushConstantRanges();
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(this->vkPhysicalDevice, &deviceProperties);
+
+	for (const auto& range : pushConstantRanges)
+	{
+		if (range.offset + range.size > deviceProperties.limits.maxPushConstantsSize)
+		{
+			throw std::runtime_error("shader push constants exceed the device push constant size!");
+		}
+	}
+
+	this->PushConstantRanges = pushConstantRanges;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &this->vkDescriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.empty() ? nullptr : pushConstantRanges.data();
+
+	if (vkCreatePipelineLayout(this->vkDevice, &pipelineLayoutInfo, nullptr, &this->vkPipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create pipeline layout!");
+	}
+}
+
 void VulkanCore::RenderEngine::CreateGraphicsPipeline()
 {
-	const std::vector<char> vertrexShaderText = ShaderExtensions::ReadShaderFile("../Shaders/base_ubo_vertrex_shader.vert");
-	const std::vector<char> fragmentShaderText = ShaderExtensions::ReadShaderFile("../Shaders/base_fragment_shader.frag");
+	this->CreatePipelineLayout();
 
-	this->vkVertrexShader = ShaderExtensions::CreateShaderModule(this->vkDevice, vertrexShaderText);
-	this->vkFragmentShader = ShaderExtensions::CreateShaderModule(this->vkDevice, fragmentShaderText);
+	if (this->PipelineVariants == nullptr)
+	{
+		this->PipelineVariants = new PipelineVariantCache(
+			this->vkDevice,
+			[this](const VkSpecializationInfo& specializationInfo) {
+				return this->BuildGraphicsPipeline(this->VertexShaderCode, this->FragmentShaderCode, &specializationInfo);
+			});
+	}
+
+	this->vkGraphicsPipeline = this->PipelineVariants->GetPipeline(this->MaterialFeatures);
+}
+
+VkPipeline VulkanCore::RenderEngine::BuildGraphicsPipeline(
+	const std::vector<uint32_t>& vertexShaderCode,
+	const std::vector<uint32_t>& fragmentShaderCode,
+	const VkSpecializationInfo* specializationInfo)
+{
+	// the modules are local, reloads build pipelines on the watch thread
+	const VkShaderModule vertexShader = ShaderExtensions::CreateShaderModule(this->vkDevice, vertexShaderCode);
+	const VkShaderModule fragmentShader = ShaderExtensions::CreateShaderModule(this->vkDevice, fragmentShaderCode);
 
 	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo = {};
 
 	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageCreateInfo.module = this->vkVertrexShader;
+	vertShaderStageCreateInfo.module = vertexShader;
 	vertShaderStageCreateInfo.pName = "main";
+	vertShaderStageCreateInfo.pSpecializationInfo = specializationInfo;
 
 	VkPipelineShaderStageCreateInfo fragmentShaderStageCreateInfo = {};
 
 	fragmentShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	fragmentShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragmentShaderStageCreateInfo.module = this->vkFragmentShader;
+	fragmentShaderStageCreateInfo.module = fragmentShader;
 	fragmentShaderStageCreateInfo.pName = "main";
+	fragmentShaderStageCreateInfo.pSpecializationInfo = specializationInfo;
 
 	VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageCreateInfo, fragmentShaderStageCreateInfo };
 
@@ -756,7 +1219,7 @@ void VulkanCore::RenderEngine::CreateGraphicsPipeline()
 	VkPipelineMultisampleStateCreateInfo multisampling = {};
 	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 	multisampling.sampleShadingEnable = VK_FALSE;
-	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisampling.rasterizationSamples = this->SampleCount;
 
 
 	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
@@ -784,16 +1247,7 @@ void VulkanCore::RenderEngine::CreateGraphicsPipeline()
 	colorBlending.blendConstants[0] = 0.0f;
 	colorBlending.blendConstants[1] = 0.0f;
 	colorBlending.blendConstants[2] = 0.0f;
-	colorBlending.blendConstants[3] = 0.0f;
-
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = 1;
-	pipelineLayoutInfo.pSetLayouts = &this->vkDescriptorSetLayout;
-
-	if (vkCreatePipelineLayout(this->vkDevice, &pipelineLayoutInfo, nullptr, &this->vkPipelineLayout) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create pipeline layout!");
-	}
+	colorBlending.blendConstants[3] = 0.0f;
 
 	VkGraphicsPipelineCreateInfo pipelineInfo = {};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -811,16 +1265,153 @@ void VulkanCore::RenderEngine::CreateGraphicsPipeline()
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
+	VkPipeline pipeline = VK_NULL_HANDLE;
+
 	if (vkCreateGraphicsPipelines(
 		this->vkDevice,
 		nullptr,
 		1, &pipelineInfo,
-		nullptr, &this->vkGraphicsPipeline) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create graphics pipeline!");
+		nullptr, &pipeline) != VK_SUCCESS) {
+		pipeline = VK_NULL_HANDLE;
+	}
+
+	vkDestroyShaderModule(this->vkDevice, fragmentShader, nullptr);
+	vkDestroyShaderModule(this->vkDevice, vertexShader, nullptr);
+
+	return pipeline;
+}
+
+void VulkanCore::RenderEngine::ApplyShaderReloads()
+{
+	if (this->ShaderHotReload == nullptr)
+	{
+		return;
+	}
+
+	std::vector<ShaderReloadResult> reloads = this->ShaderHotReload->ConsumeReloads();
+
+	if (reloads.empty())
+	{
+		return;
+	}
+
+	// every reload was built on top of the previous ones, only the newest is bound and the others were never used
+	for (size_t i = 0; i + 1 < reloads.size(); i++)
+	{
+		vkDestroyPipeline(this->vkDevice, reloads[i].pipeline, nullptr);
+	}
+
+	ShaderReloadResult& reload = reloads.back();
+
+	// frames in flight still reference the previous pipelines, they are destroyed once those frames retire.
+	// other variants were built from the previous code and are recreated on demand
+	for (const VkPipeline retiredPipeline : this->PipelineVariants->Release())
+	{
+		this->RetiredPipelines.push_back({ retiredPipeline, this->frameNumber });
+	}
+
+	this->VertexShaderCode = std::move(reload.vertexShaderCode);
+	this->FragmentShaderCode = std::move(reload.fragmentShaderCode);
+
+	if (reload.pipelineGeneration == this->PipelineGeneration)
+	{
+		this->PipelineVariants->AddPipeline(this->MaterialFeatures, reload.pipeline);
+	}
+	else
+	{
+		// the swap chain was recreated while it was built, like every other pipeline it is rebuilt for the new pass
+		vkDestroyPipeline(this->vkDevice, reload.pipeline, nullptr);
+	}
+
+	this->vkGraphicsPipeline = this->PipelineVariants->GetPipeline(this->MaterialFeatures);
+
+	std::cout << "graphics pipeline reloaded" << std::endl;
+}
+
+bool VulkanCore::RenderEngine::PrepareShaderReload(ShaderReloadResult& reload)
+{
+	const std::string compiledName = std::filesystem::path(reload.outputPath).filename().string();
+
+	std::vector<uint32_t> vertexShaderCode = this->HotReloadVertexShaderCode;
+	std::vector<uint32_t> fragmentShaderCode = this->HotReloadFragmentShaderCode;
+	std::vector<uint32_t>* stageCode = nullptr;
+
+	if (compiledName == std::filesystem::path(this->VertexShaderPath).filename().string())
+	{
+		stageCode = &vertexShaderCode;
+	}
+	else if (compiledName == std::filesystem::path(this->FragmentShaderPath).filename().string())
+	{
+		stageCode = &fragmentShaderCode;
+	}
+	else
+	{
+		return false;
+	}
+
+	try
+	{
+		const ShaderReflectionData stageLayout = ShaderReflection::Reflect(reload.code, reload.outputPath);
+
+		if (!this->ShaderLayout.IsLayoutCompatible(stageLayout))
+		{
+			std::cerr << "shader " << reload.sourcePath << " changed its resource layout, restart to apply it" << std::endl;
+			return false;
+		}
+
+		if (stageLayout.stageFlags & VK_SHADER_STAGE_VERTEX_BIT)
+		{
+			auto attributeDescriptions = Vertex::GetAttributeDescriptions();
+			stageLayout.ValidateVertexInputs(attributeDescriptions.data(), attributeDescriptions.size());
+		}
+	}
+	catch (const std::runtime_error& error)
+	{
+		std::cerr << "shader " << reload.sourcePath << " rejected: " << error.what() << std::endl;
+		return false;
+	}
+
+	*stageCode = reload.code;
+
+	{
+		std::lock_guard<std::mutex> lock(this->PipelineStateLock);
+
+		// frames keep rendering with the old pipeline while this one compiles, a failure keeps it bound
+		const ShaderVariantSpecialization specialization(this->MaterialFeatures);
+		reload.pipeline = this->BuildGraphicsPipeline(vertexShaderCode, fragmentShaderCode, &specialization.info);
+		reload.pipelineGeneration = this->PipelineGeneration;
 	}
 
-	vkDestroyShaderModule(this->vkDevice, this->vkFragmentShader, nullptr);
-	vkDestroyShaderModule(this->vkDevice, this->vkVertrexShader, nullptr);
+	if (reload.pipeline == VK_NULL_HANDLE)
+	{
+		std::cerr << "failed to rebuild graphics pipeline, keeping the previous one" << std::endl;
+		return false;
+	}
+
+	this->HotReloadVertexShaderCode = vertexShaderCode;
+	this->HotReloadFragmentShaderCode = fragmentShaderCode;
+	reload.vertexShaderCode = std::move(vertexShaderCode);
+	reload.fragmentShaderCode = std::move(fragmentShaderCode);
+
+	return true;
+}
+
+void VulkanCore::RenderEngine::DestroyRetiredPipelines(bool force)
+{
+	auto retired = this->RetiredPipelines.begin();
+
+	while (retired != this->RetiredPipelines.end())
+	{
+		if (force || this->frameNumber >= retired->second + MAX_FRAMES_IN_FLIGHT)
+		{
+			vkDestroyPipeline(this->vkDevice, retired->first, nullptr);
+			retired = this->RetiredPipelines.erase(retired);
+		}
+		else
+		{
+			++retired;
+		}
+	}
 }
 
 void VulkanCore::RenderEngine::CreateLogicalDevice()
@@ -840,8 +1431,15 @@ void VulkanCore::RenderEngine::CreateLogicalDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(this->vkPhysicalDevice, &supportedFeatures);
+
+	// anisotropy is optional, SamplerCache falls back to plain filtering without it
 	VkPhysicalDeviceFeatures deviceFeatures = {};
-	deviceFeatures.samplerAnisotropy = VK_TRUE;
+	deviceFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
+	// so is multiDrawIndirect, culled meshlets are drawn one indirect command at a time without it
+	deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+	this->MultiDrawIndirect = supportedFeatures.multiDrawIndirect == VK_TRUE;
 
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -851,10 +1449,12 @@ void VulkanCore::RenderEngine::CreateLogicalDevice()
 
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(this->deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = this->deviceExtensions.data();
+	const std::vector<const char*> requiredExtensions = this->GetRequiredDeviceExtensions();
 
-	if (this->enableValidationLayers) {
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
+	createInfo.ppEnabledExtensionNames = requiredExtensions.data();
+
+	if (this->UseValidationLayers) {
 		createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
 		createInfo.ppEnabledLayerNames = validationLayers.data();
 	}
@@ -880,8 +1480,13 @@ QueueFamilyIndices VulkanCore::RenderEngine::FindQueueFamilies(VkPhysicalDevice
 
 	int i = 0;
 	for (const auto& queueFamily : queueFamilies) {
-		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, this->vkSurface, &presentSupport);
+		// without a surface nothing is presented, the graphics queue is all that is needed
+		VkBool32 presentSupport = this->IsHeadless;
+
+		if (!this->IsHeadless)
+		{
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, this->vkSurface, &presentSupport);
+		}
 
 		if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT && presentSupport) {
 			indices.graphicsFamily = i;
@@ -908,80 +1513,86 @@ void VulkanCore::RenderEngine::PickPhysicalDevice() {
 	std::vector<VkPhysicalDevice> devices(deviceCount);
 	vkEnumeratePhysicalDevices(this->vkInstance, &deviceCount, devices.data());
 
-	// Use an ordered map to automatically sort candidates by increasing score
-	std::multimap<int, VkPhysicalDevice> candidates;
+	int64_t bestScore = -1;
 
-	for (const auto& device : devices) {
-		int score = this->RateDeviceSuitability(device);
-		candidates.insert(std::make_pair(score, device));
+	for (uint32_t i = 0; i < deviceCount; ++i) {
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(devices[i], &deviceProperties);
 
-		if (this->IsDeviceSuitable(device)) {
-			this->vkPhysicalDevice = device;
-		}
-	}
+		std::string rejectReason;
+		const bool isSuitable = this->IsDeviceSuitable(devices[i], rejectReason);
+		const int64_t score = DeviceSelectionPolicy::ScoreDevice(devices[i]);
 
-	if (this->vkPhysicalDevice == VK_NULL_HANDLE) {
-		throw std::runtime_error("failed to find a suitable GPU!");
-	}
+		std::cout << "device " << i << ": " << deviceProperties.deviceName
+			<< " (" << DeviceSelectionPolicy::GetDeviceTypeName(deviceProperties.deviceType) << ")";
 
-	if (candidates.rbegin()->first > 0) {
-		this->vkPhysicalDevice = candidates.rbegin()->second;
-	}
-	else {
-		throw std::runtime_error("failed to find a suitable GPU!");
-	}
-}
+		if (isSuitable) {
+			std::cout << ", score " << score << std::endl;
+		}
+		else {
+			std::cout << ", unsuitable: " << rejectReason << std::endl;
+		}
 
-int VulkanCore::RenderEngine::RateDeviceSuitability(VkPhysicalDevice device) {
-	VkPhysicalDeviceProperties deviceProperties;
-	VkPhysicalDeviceFeatures deviceFeatures;
-	vkGetPhysicalDeviceProperties(device, &deviceProperties);
-	vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+		if (this->DevicePolicy.HasOverride()) {
+			if (!this->DevicePolicy.MatchesOverride(i, deviceProperties) || this->vkPhysicalDevice != VK_NULL_HANDLE) {
+				continue;
+			}
 
-	int score = 0;
+			if (!isSuitable) {
+				throw std::runtime_error(std::string("requested device ") + deviceProperties.deviceName + " is unsuitable: " + rejectReason);
+			}
 
-	// Discrete GPUs have a significant performance advantage
-	if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
-		score += 1000;
+			this->vkPhysicalDevice = devices[i];
+		}
+		else if (isSuitable && score > bestScore) {
+			bestScore = score;
+			this->vkPhysicalDevice = devices[i];
+		}
 	}
 
-	// Maximum possible size of textures affects graphics quality
-	score += deviceProperties.limits.maxImageDimension2D;
+	if (this->vkPhysicalDevice == VK_NULL_HANDLE && this->DevicePolicy.HasOverride()) {
+		throw std::runtime_error(std::string("no device matches ") + DeviceSelectionPolicy::OVERRIDE_VARIABLE + "!");
+	}
 
-	// Application can't function without geometry shaders
-	if (!deviceFeatures.geometryShader) {
-		return 0;
+	if (this->vkPhysicalDevice == VK_NULL_HANDLE) {
+		throw std::runtime_error("failed to find a suitable GPU!");
 	}
 
-	return score;
+	VkPhysicalDeviceProperties selectedProperties;
+	vkGetPhysicalDeviceProperties(this->vkPhysicalDevice, &selectedProperties);
+
+	std::cout << "selected device: " << selectedProperties.deviceName << std::endl;
 }
 
-bool VulkanCore::RenderEngine::IsDeviceSuitable(VkPhysicalDevice device) const
+// checks only what the renderer actually uses, preferences are scored by DeviceSelectionPolicy
+bool VulkanCore::RenderEngine::IsDeviceSuitable(VkPhysicalDevice device, std::string& rejectReason) const
 {
-	VkPhysicalDeviceProperties deviceProperties;
-	VkPhysicalDeviceFeatures deviceFeatures;
-	vkGetPhysicalDeviceProperties(device, &deviceProperties);
-	vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
-
 	QueueFamilyIndices indices = this->FindQueueFamilies(device);
 
-	const bool requiredExtensionsSupported = this->CheckDeviceExtensionsSupport(device);
+	if (!indices.IsComplete())
+	{
+		rejectReason = this->IsHeadless ? "no graphics queue" : "no graphics queue with present support";
+		return false;
+	}
 
-	bool swapChainValidationResult = false;
+	if (!this->CheckDeviceExtensionsSupport(device))
+	{
+		rejectReason = "missing required device extensions";
+		return false;
+	}
 
-	if (requiredExtensionsSupported)
+	if (!this->IsHeadless)
 	{
 		SwapChainSupportDetails swapChainSupportDetails = QuerySwapChainSupport(device, this->vkSurface);
 
-		swapChainValidationResult = !swapChainSupportDetails.formats.empty() && !swapChainSupportDetails.presentModes.empty();
+		if (swapChainSupportDetails.formats.empty() || swapChainSupportDetails.presentModes.empty())
+		{
+			rejectReason = "no swap chain support for the window surface";
+			return false;
+		}
 	}
 
-	return indices.IsComplete()
-		&& deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU
-		&& deviceFeatures.geometryShader
-		&& requiredExtensionsSupported
-		&& swapChainValidationResult
-		&& deviceFeatures.samplerAnisotropy;
+	return true;
 }
 
 bool VulkanCore::RenderEngine::CheckDeviceExtensionsSupport(VkPhysicalDevice device) const
@@ -994,7 +1605,9 @@ bool VulkanCore::RenderEngine::CheckDeviceExtensionsSupport(VkPhysicalDevice dev
 
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-	std::set<std::string> requiredExtensions(this->deviceExtensions.begin(), this->deviceExtensions.end());
+	const std::vector<const char*> deviceRequiredExtensions = this->GetRequiredDeviceExtensions();
+
+	std::set<std::string> requiredExtensions(deviceRequiredExtensions.begin(), deviceRequiredExtensions.end());
 
 	for (const auto& extension : availableExtensions)
 	{
@@ -1004,70 +1617,169 @@ bool VulkanCore::RenderEngine::CheckDeviceExtensionsSupport(VkPhysicalDevice dev
 	return requiredExtensions.empty();
 }
 
-void VulkanCore::RenderEngine::CreateRenderPass()
-{
-	VkAttachmentDescription colorAttachment = {};
-	colorAttachment.format = this->vkSwapChainImageFormat;
-	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-	VkAttachmentDescription depthAttachment = {};
-	depthAttachment.format = GraphicsPipelineUtils::FindDepthFormat(this->vkPhysicalDevice);
-	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-	VkAttachmentReference colorAttachmentRef = {};
-	colorAttachmentRef.attachment = 0;
-	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkAttachmentReference depthAttachmentRef = {};
-	depthAttachmentRef.attachment = 1;
-	depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-	VkSubpassDescription subpass = {};
-	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpass.colorAttachmentCount = 1;
-	subpass.pColorAttachments = &colorAttachmentRef;
-	subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-	VkSubpassDependency dependency = {};
-	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-	dependency.dstSubpass = 0;
-	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.srcAccessMask = 0;
-	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-	std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
-
-	VkRenderPassCreateInfo renderPassInfo = {};
-	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-	renderPassInfo.pAttachments = attachments.data();
-	renderPassInfo.subpassCount = 1;
-	renderPassInfo.pSubpasses = &subpass;
-	renderPassInfo.dependencyCount = 1;
-	renderPassInfo.pDependencies = &dependency;
-
-	if (vkCreateRenderPass(this->vkDevice, &renderPassInfo, nullptr, &this->vkRenderPass) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create render pass!");
+// picks the largest supported count not above the requested one, color and depth have to agree on it
+VkSampleCountFlagBits VulkanCore::RenderEngine::ChooseSampleCount(uint32_t requestedSampleCount) const
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(this->vkPhysicalDevice, &properties);
+
+	const VkSampleCountFlags supportedCounts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+
+	for (const VkSampleCountFlagBits sampleCount : { VK_SAMPLE_COUNT_8_BIT, VK_SAMPLE_COUNT_4_BIT, VK_SAMPLE_COUNT_2_BIT })
+	{
+		if (static_cast<uint32_t>(sampleCount) <= requestedSampleCount && (supportedCounts & sampleCount) != 0)
+		{
+			return sampleCount;
+		}
+	}
+
+	return VK_SAMPLE_COUNT_1_BIT;
+}
+
+void VulkanCore::RenderEngine::CreateRenderGraph()
+{
+	this->FrameGraph = new RenderGraph(this->vkDevice, this->vkPhysicalDevice);
+	this->SampleCount = this->ChooseSampleCount(this->RequestedSampleCount);
+
+	if (static_cast<uint32_t>(this->SampleCount) != this->RequestedSampleCount)
+	{
+		std::cout << "requested " << this->RequestedSampleCount << "x MSAA, using " << this->SampleCount << "x" << std::endl;
+	}
+
+	RenderGraphImageDescription colorDescription;
+	colorDescription.format = this->vkSwapChainImageFormat;
+	colorDescription.extent = this->vkExtent;
+
+	// post-processing works on a storage capable copy of the frame, swap chain formats rarely allow storage
+	RenderGraphImageDescription sceneColorDescription = colorDescription;
+	sceneColorDescription.format = this->PostProcessNoise ? WorleyNoisePass::TARGET_FORMAT : this->vkSwapChainImageFormat;
+
+	RenderGraphImageDescription multisampledColorDescription = sceneColorDescription;
+	multisampledColorDescription.samples = this->SampleCount;
+
+	RenderGraphImageDescription depthDescription;
+	depthDescription.format = GraphicsPipelineUtils::FindDepthFormat(this->vkPhysicalDevice);
+	depthDescription.extent = this->vkExtent;
+	depthDescription.samples = this->SampleCount;
+
+	// acquired images are waited on at color output, headless frames are copied out after the graph
+	RenderGraphImageState backBufferInitialState;
+	backBufferInitialState.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	backBufferInitialState.stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	backBufferInitialState.accessMask = 0;
+
+	RenderGraphImageState backBufferFinalState;
+	backBufferFinalState.layout = this->IsHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	backBufferFinalState.stageMask = this->IsHeadless ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	backBufferFinalState.accessMask = this->IsHeadless ? VK_ACCESS_TRANSFER_READ_BIT : 0;
+
+	this->BackBufferResource = this->FrameGraph->ImportImage("back buffer", colorDescription, backBufferInitialState, backBufferFinalState);
+
+	// depth is cleared every frame and never stored, all frames in flight share one transient image
+	// and the graph orders each frame's depth tests after the previous frame's
+	this->DepthResource = this->FrameGraph->CreateImage("depth", depthDescription);
+
+	this->SceneColorResource = this->PostProcessNoise
+		? this->FrameGraph->CreateImage("scene color", sceneColorDescription)
+		: this->BackBufferResource;
+
+	this->MainPass = this->FrameGraph->AddPass("main pass", [this](VkCommandBuffer commandBuffer) {
+		this->RecordMainPass(commandBuffer);
+	});
+
+	if (this->SampleCount != VK_SAMPLE_COUNT_1_BIT)
+	{
+		// samples stay in transient memory, only the resolved image is written out
+		this->MultisampledColorResource = this->FrameGraph->CreateImage("multisampled color", multisampledColorDescription);
+		this->FrameGraph->WriteColorAttachment(this->MainPass, this->MultisampledColorResource, VK_ATTACHMENT_LOAD_OP_CLEAR, { 0.7f, 0.76f, 0.8f, 0.95f });
+		this->FrameGraph->ResolveAttachment(this->MainPass, this->MultisampledColorResource, this->SceneColorResource);
+	}
+	else
+	{
+		this->FrameGraph->WriteColorAttachment(this->MainPass, this->SceneColorResource, VK_ATTACHMENT_LOAD_OP_CLEAR, { 0.7f, 0.76f, 0.8f, 0.95f });
+	}
+
+	this->FrameGraph->WriteDepthAttachment(this->MainPass, this->DepthResource, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+	if (this->PostProcessNoise)
+	{
+		if (this->NoisePass == nullptr)
+		{
+			this->NoisePass = new WorleyNoisePass(this->vkDevice, this->NoiseShaderPath);
+		}
+
+		const uint32_t noisePass = this->FrameGraph->AddPass("worley noise", [this](VkCommandBuffer commandBuffer) {
+			this->NoisePass->Record(commandBuffer, this->vkExtent, this->AnimationTime);
+		});
+		this->FrameGraph->ReadWriteStorage(noisePass, this->SceneColorResource, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		const uint32_t copyPass = this->FrameGraph->AddPass("present copy", [this](VkCommandBuffer commandBuffer) {
+			this->RecordPresentCopy(commandBuffer);
+		});
+		this->FrameGraph->ReadTransfer(copyPass, this->SceneColorResource);
+		this->FrameGraph->WriteTransfer(copyPass, this->BackBufferResource);
+	}
+
+	this->FrameGraph->Compile();
+
+	if (this->PostProcessNoise)
+	{
+		this->NoisePass->SetTarget(this->FrameGraph->GetImageView(this->SceneColorResource));
+	}
+
+	std::cout << "render targets: " << this->FrameGraph->GetTransientMemorySize() << " bytes, "
+		<< this->FrameGraph->GetLazilyAllocatedMemorySize() << " lazily allocated" << std::endl;
+
+	// pipelines are created against the main pass, the graph owns it
+	this->vkRenderPass = this->FrameGraph->GetRenderPass(this->MainPass);
+}
+
+// blits convert the float scene color into whatever format the swap chain uses
+void VulkanCore::RenderEngine::RecordPresentCopy(VkCommandBuffer commandBuffer)
+{
+	VkImageBlit region = {};
+	region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.srcSubresource.layerCount = 1;
+	region.srcOffsets[1] = { static_cast<int32_t>(this->vkExtent.width), static_cast<int32_t>(this->vkExtent.height), 1 };
+	region.dstSubresource = region.srcSubresource;
+	region.dstOffsets[1] = region.srcOffsets[1];
+
+	vkCmdBlitImage(
+		commandBuffer,
+		this->FrameGraph->GetImage(this->SceneColorResource),
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		this->vkSwapChainImages[this->RecordingImageIndex],
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		1,
+		&region,
+		VK_FILTER_NEAREST);
+}
+
+void VulkanCore::RenderEngine::LoadModel()
+{
+	MeshCooker::LoadOrCook(this->ModelPath, this->ModelMesh);
+
+	if (this->ModelMesh.lods.empty())
+	{
+		throw std::runtime_error("model " + this->ModelPath + " has no triangles");
+	}
+
+	std::cout << "model levels of detail:";
+	for (const auto& lod : this->ModelMesh.lods)
+	{
+		std::cout << " " << lod.indexCount / 3;
 	}
+	std::cout << " triangles" << std::endl;
+
+	this->Scene.Clear();
+	this->ModelNode = this->Scene.AddNode(SceneGraph::NO_PARENT);
 }
 
 void VulkanCore::RenderEngine::CreateGeometryBuffers()
 {
-	MeshExtensions::LoadModelToMemoryBuffer(
-		this->ModelPath.c_str(),
+	MeshExtensions::CreateModelBuffers(
+		this->ModelMesh.vertices,
+		this->ModelMesh.indices,
 		this->vkDevice,
 		this->vkPhysicalDevice,
 		this->vkCommandPool,
@@ -1076,108 +1788,204 @@ void VulkanCore::RenderEngine::CreateGeometryBuffers()
 		this->vkVertexBufferMemory,
 		this->vkIndexBuffer,
 		this->vkIndexBufferMemory);
+
+	// only the device copies are drawn from
+	std::vector<Vertex>().swap(this->ModelMesh.vertices);
+	std::vector<uint32_t>().swap(this->ModelMesh.indices);
+}
+
+void VulkanCore::RenderEngine::CreateMeshletCulling()
+{
+	// the meshlets stay on the CPU either way, CountVisibleMeshlets reports what the culling would keep
+	if (!this->MeshletCulling)
+	{
+		return;
+	}
+
+	this->MeshletCuller = new MeshletCullingPass(
+		this->vkDevice,
+		this->vkPhysicalDevice,
+		this->vkCommandPool,
+		this->vkGraphicsQueue,
+		this->MeshletCullingShaderPath,
+		this->ModelMesh.meshlets,
+		MAX_FRAMES_IN_FLIGHT,
+		this->MultiDrawIndirect);
 }
 
 void VulkanCore::RenderEngine::CreateDescriptorPool()
 {
-	std::array<VkDescriptorPoolSize, 2> poolSizes = {};
-	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	poolSizes[0].descriptorCount = static_cast<uint32_t>(this->vkSwapChainImages.size());
-	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	poolSizes[1].descriptorCount = static_cast<uint32_t>(this->vkSwapChainImages.size());
+	std::map<VkDescriptorType, uint32_t> descriptorCounts;
+	for (const auto& binding : this->ShaderLayout.GetDescriptorSetLayoutBindings(0))
+	{
+		descriptorCounts[binding.descriptorType] += binding.descriptorCount;
+	}
+
+	std::vector<VkDescriptorPoolSize> poolSizes;
+	for (const auto& descriptorCount : descriptorCounts)
+	{
+		VkDescriptorPoolSize poolSize = {};
+		poolSize.type = descriptorCount.first;
+		poolSize.descriptorCount = descriptorCount.second * MAX_FRAMES_IN_FLIGHT;
+		poolSizes.push_back(poolSize);
+	}
 
 	VkDescriptorPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 	poolInfo.pPoolSizes = poolSizes.data();
-	poolInfo.maxSets = static_cast<uint32_t>(this->vkSwapChainImages.size());
+	poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
 
 	if (vkCreateDescriptorPool(this->vkDevice, &poolInfo, nullptr, &this->vkDescriptorPool) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create descriptor pool!");
 	}
 }
 
-void VulkanCore::RenderEngine::CreateUniformBuffer()
+void VulkanCore::RenderEngine::UpdateFrameConstants()
 {
-	const VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-
-	this->vkUniformBuffers.resize(this->vkSwapChainImages.size());
-	this->vkUniformBuffersMemory.resize(this->vkSwapChainImages.size());
+	// without the update thread the frame is simulated right here, numbered like the frame it is drawn in
+	if (!this->PipelinedUpdate)
+	{
+		this->UpdateNumber = this->frameNumber;
+		this->UpdateFramePacket();
+	}
 
-	for (size_t i = 0; i < this->vkSwapChainImages.size(); i++) {
-		MemoryUtils::CreateBuffer(
-			bufferSize,
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			this->vkDevice,
-			this->vkPhysicalDevice,
-			this->vkUniformBuffers[i],
-			this->vkUniformBuffersMemory[i]);
+	// keeps rendering the last packet when the update thread has not finished the next one yet, a packet that
+	// was picked up lets it simulate the next; taking the lock orders the wakeup after its pending check
+	if (this->FramePackets.Acquire() && this->PipelinedUpdate)
+	{
+		std::lock_guard<std::mutex> lock(this->FramePacketLock);
+		this->FramePacketSignal.notify_one();
 	}
+	const FramePacket& packet = this->FramePackets.GetReadSlot();
+
+	const glm::mat4& model = packet.worldTransforms[this->ModelNode];
+
+	// the projection follows the swap chain, which only the render thread resizes
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), this->vkExtent.width / static_cast<float>(this->vkExtent.height), 0.01f, 2000.0f);
+
+	//projection[0][0] *= -1;
+	projection[1][1] *= -1;
+	//projection[2][2] *= -1;
+	//projection[3][3] *= -1;
+
+	this->AnimationTime = packet.time;
+
+	// everything the draw needs goes into its push constants, there is no per-frame buffer to write
+	this->ModelDrawConstants.modelViewProjection = projection * packet.view * model;
+	this->ModelDrawConstants.materialIndex = 0;
+	this->SelectModelLod(model, packet.eye);
+	this->UpdateMeshletCulling(this->ModelDrawConstants.modelViewProjection, model, packet.eye);
 }
 
-void VulkanCore::RenderEngine::CreateDepthResources()
+void VulkanCore::RenderEngine::BuildFramePacket(FramePacket& packet)
 {
-	VkFormat depthFormat = GraphicsPipelineUtils::FindDepthFormat(this->vkPhysicalDevice);
+	// a fixed timestep makes every run animate through exactly the same frames
+	if (this->FixedTimestep > 0.0)
+	{
+		packet.time = static_cast<float>(static_cast<double>(packet.updateNumber) * this->FixedTimestep);
+	}
+	else
+	{
+		const auto currentTime = std::chrono::high_resolution_clock::now();
+		packet.time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - this->StartTime).count();
+	}
 
-	this->vkDepthImages.resize(this->vkSwapChainImages.size());
-	this->vkDepthImagesMemory.resize(this->vkSwapChainImages.size());
-	this->vkDepthImagesView.resize(this->vkSwapChainImages.size());
+	this->Scene.SetRotation(this->ModelNode, glm::angleAxis(packet.time * glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+	this->Scene.UpdateWorldTransforms();
 
-	for (size_t i = 0; i < this->vkSwapChainImages.size(); i++) {
-		MemoryUtils::CreateImage(
-			this->vkExtent.width,
-			this->vkExtent.height,
-			depthFormat,
-			VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			this->vkDepthImages[i],
-			this->vkDepthImagesMemory[i],
-			this->vkDevice,
-			this->vkPhysicalDevice
-		);
+	// the slot keeps its capacity, after the first few frames this copy does not allocate
+	const std::vector<glm::mat4>& worldTransforms = this->Scene.GetWorldTransforms();
+	packet.worldTransforms.assign(worldTransforms.begin(), worldTransforms.end());
 
-		this->vkDepthImagesView[i] = GraphicsPipelineUtils::CreateImageView(
-			this->vkDepthImages[i],
-			depthFormat,
-			VK_IMAGE_ASPECT_DEPTH_BIT,
-			this->vkDevice);
+	packet.eye = glm::vec3(2.0f, 2.0f, 2.0f);
+	packet.view = lookAt(packet.eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+}
 
-		MemoryUtils::TransitionImageLayout(
-			this->vkDepthImages[i],
-			depthFormat,
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-			this->vkDevice,
-			this->vkCommandPool,
-			this->vkGraphicsQueue);
-	}
+void VulkanCore::RenderEngine::SelectModelLod(const glm::mat4& model, const glm::vec3& eye)
+{
+	const float screenSize = this->GetModelScreenSize(model, eye);
+
+	this->ModelLod = MeshLodSelector::SelectLod(this->ModelMesh.lods, screenSize, this->ModelLod, this->LodSettings);
 }
 
-void VulkanCore::RenderEngine::UpdateUniformBuffer(uint32_t currentImage)
+float VulkanCore::RenderEngine::GetModelScreenSize(const glm::mat4& model, const glm::vec3& eye) const
 {
-	static auto startTime = std::chrono::high_resolution_clock::now();
+	const glm::vec3 boundsCenter = glm::vec3(model * glm::vec4(
+		this->ModelMesh.boundsCenter[0],
+		this->ModelMesh.boundsCenter[1],
+		this->ModelMesh.boundsCenter[2],
+		1.0f));
+
+	// the sphere is in model space, the largest axis scale keeps it enclosing the transformed mesh
+	const float scale = std::max(
+		glm::length(glm::vec3(model[0])),
+		std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	return MeshLodSelector::GetScreenSize(
+		this->ModelMesh.boundsRadius * scale,
+		glm::length(eye - boundsCenter),
+		glm::radians(45.0f),
+		this->vkExtent.height);
+}
 
-	const auto currentTime = std::chrono::high_resolution_clock::now();
-	float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+void VulkanCore::RenderEngine::UpdateMeshletCulling(const glm::mat4& modelViewProjection, const glm::mat4& model, const glm::vec3& eye)
+{
+	// meshlet bounds are in model space, the frustum and the camera are brought there instead
+	MeshletBuilder::GetFrustumPlanes(modelViewProjection, this->CullingConstants.frustumPlanes);
 
-	UniformBufferObject ubo = {};
-	ubo.model = rotate(glm::mat4(1.0f), time * glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	const glm::vec4 cameraPosition = glm::inverse(model) * glm::vec4(eye, 1.0f);
 
-	ubo.view = lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	for (int axis = 0; axis < 4; axis++)
+	{
+		this->CullingConstants.cameraPosition[axis] = cameraPosition[axis];
+	}
 
-	ubo.projection = glm::perspective(glm::radians(45.0f), this->vkExtent.width / static_cast<float>(this->vkExtent.height), 0.01f, 2000.0f);
+	const MeshLod& lod = this->ModelMesh.lods[this->ModelLod];
+	this->CullingConstants.firstMeshlet = lod.firstMeshlet;
+	this->CullingConstants.meshletCount = lod.meshletCount;
+}
 
-	//ubo.projection[0][0] *= -1;
-	ubo.projection[1][1] *= -1;
-	//ubo.projection[2][2] *= -1;
-	//ubo.projection[3][3] *= -1;
+void VulkanCore::RenderEngine::UpdateTextureStreaming(VkCommandBuffer commandBuffer)
+{
+	// the packet this frame's uniforms were built from, its camera and model placement give the projected size
+	const FramePacket& packet = this->FramePackets.GetReadSlot();
+	const float projectedPixels = this->GetModelScreenSize(packet.worldTransforms[this->ModelNode], packet.eye);
 
-	void* data;
-	vkMapMemory(this->vkDevice, this->vkUniformBuffersMemory[currentImage], 0, sizeof(ubo), 0, &data);
-	memcpy(data, &ubo, sizeof(ubo));
-	vkUnmapMemory(this->vkDevice, this->vkUniformBuffersMemory[currentImage]);
+	this->TextureStreaming->RequestScreenSize(this->BaseColorTextureId, projectedPixels, this->frameNumber);
+
+	if (this->TextureStreaming->Update(this->frameNumber, commandBuffer))
+	{
+		this->vkTextureImageView = this->TextureStreaming->GetImageView(this->BaseColorTextureId);
+	}
+
+	// this slot's fence was waited on, no submitted frame reads its set anymore; the other slots catch up
+	// on their own turn, the streamer keeps the views they still hold alive until then
+	if (this->DescriptorTextureViews[this->currentFrame] != this->vkTextureImageView)
+	{
+		this->UpdateTextureDescriptor(this->currentFrame);
+	}
+}
+
+void VulkanCore::RenderEngine::UpdateTextureDescriptor(size_t frameSlot)
+{
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = this->vkTextureImageView;
+	imageInfo.sampler = this->vkTextureSampler;
+
+	VkWriteDescriptorSet descriptorWrite = {};
+	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet = this->vkDescriptorSets[frameSlot];
+	descriptorWrite.dstBinding = this->BaseColorTextureBinding;
+	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descriptorWrite.descriptorCount = 1;
+	descriptorWrite.pImageInfo = &imageInfo;
+
+	vkUpdateDescriptorSets(this->vkDevice, 1, &descriptorWrite, 0, nullptr);
+
+	this->DescriptorTextureViews[frameSlot] = this->vkTextureImageView;
 }
 
 void VulkanCore::RenderEngine::CreateVulkanInstance()
@@ -1195,25 +2003,32 @@ void VulkanCore::RenderEngine::CreateVulkanInstance()
 	createInfo.pApplicationInfo = &appInfo;
 
 
-	auto glfwExtensions = this->GetRequiredExtensions();
-
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(glfwExtensions.size());
-	createInfo.ppEnabledExtensionNames = glfwExtensions.data();
+	this->UseValidationLayers = enableValidationLayers && this->CheckVkValidationLayerSupport();
 
-	if (enableValidationLayers && this->CheckVkValidationLayerSupport()) {
+	if (this->UseValidationLayers) {
 		std::cout << "Vulkan validation layers enabled" << std::endl;
 		createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
 		createInfo.ppEnabledLayerNames = this->validationLayers.data();
 	}
+	else if (enableValidationLayers && this->IsHeadless)
+	{
+		// CI and render nodes often ship the loader and driver only
+		std::cout << "Vulkan validation layers not available, continuing without them" << std::endl;
+		createInfo.enabledLayerCount = 0;
+	}
 	else if (enableValidationLayers)
 	{
 		throw std::runtime_error("Failed to check validation layers");
 	}
-
-	if (!enableValidationLayers) {
+	else {
 		createInfo.enabledLayerCount = 0;
 	}
 
+	auto glfwExtensions = this->GetRequiredExtensions();
+
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(glfwExtensions.size());
+	createInfo.ppEnabledExtensionNames = glfwExtensions.data();
+
 	uint32_t extensionCount = 0;
 	vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
 	std::vector<VkExtensionProperties> extensions(extensionCount);
@@ -1307,13 +2122,18 @@ bool VulkanCore::RenderEngine::CheckVkValidationLayerSupport() const
 
 std::vector<const char*> VulkanCore::RenderEngine::GetRequiredExtensions() const
 {
-	uint32_t glfwExtensionCount = 0;
+	std::vector<const char*> extensions;
+
+	if (!this->IsHeadless)
+	{
+		uint32_t glfwExtensionCount = 0;
 
-	const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		const char **glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
-	if (this->enableValidationLayers)
+	if (this->UseValidationLayers)
 	{
 		extensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 	}
@@ -1321,6 +2141,16 @@ std::vector<const char*> VulkanCore::RenderEngine::GetRequiredExtensions() const
 	return extensions;
 }
 
+std::vector<const char*> VulkanCore::RenderEngine::GetRequiredDeviceExtensions() const
+{
+	if (this->IsHeadless)
+	{
+		return std::vector<const char*>();
+	}
+
+	return this->deviceExtensions;
+}
+
 bool VulkanCore::RenderEngine::ThrottleCheck() const
 {
 	const auto currentTime = std::chrono::system_clock::now();
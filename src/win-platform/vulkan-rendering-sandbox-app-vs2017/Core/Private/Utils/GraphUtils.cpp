@@ -126,14 +126,33 @@ VkImageView GraphicsPipelineUtils::CreateImageView(
 	VkFormat format,
 	VkImageAspectFlags aspectFlags,
 	VkDevice device) {
+	return CreateImageView(image, format, aspectFlags, 1, device);
+}
+
+VkImageView GraphicsPipelineUtils::CreateImageView(
+	VkImage image,
+	VkFormat format,
+	VkImageAspectFlags aspectFlags,
+	uint32_t mipLevels,
+	VkDevice device) {
+	return CreateImageView(image, format, aspectFlags, 0, mipLevels, device);
+}
+
+VkImageView GraphicsPipelineUtils::CreateImageView(
+	VkImage image,
+	VkFormat format,
+	VkImageAspectFlags aspectFlags,
+	uint32_t baseMipLevel,
+	uint32_t mipLevels,
+	VkDevice device) {
 	VkImageViewCreateInfo viewInfo = {};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewInfo.image = image;
 	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 	viewInfo.format = format;
 	viewInfo.subresourceRange.aspectMask = aspectFlags;
-	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
+	viewInfo.subresourceRange.levelCount = mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 
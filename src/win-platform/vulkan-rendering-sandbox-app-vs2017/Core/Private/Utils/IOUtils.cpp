@@ -31,6 +31,53 @@ std::vector<char> ShaderExtensions::ReadShaderFile(const std::string& shaderFile
 	return buffer;
 }
 
+std::vector<uint32_t> ShaderExtensions::ReadSpirvFile(const std::string& shaderFileName)
+{
+	std::ifstream shaderFile(shaderFileName, std::ios::ate | std::ios::binary);
+
+	if (!shaderFile.is_open())
+	{
+		throw std::runtime_error("shader file " + shaderFileName + " not found, run Shaders/build_shaders first");
+	}
+
+	const size_t fileSize = static_cast<size_t>(shaderFile.tellg());
+
+	// SPIR-V is a stream of 32-bit words starting with the magic number
+	if (fileSize < sizeof(uint32_t) * 5 || fileSize % sizeof(uint32_t) != 0)
+	{
+		throw std::runtime_error("shader file " + shaderFileName + " is not a valid SPIR-V module");
+	}
+
+	std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
+
+	shaderFile.seekg(0);
+	shaderFile.read(reinterpret_cast<char*>(buffer.data()), fileSize);
+	shaderFile.close();
+
+	if (buffer[0] != 0x07230203)
+	{
+		throw std::runtime_error("shader file " + shaderFileName + " is not a valid SPIR-V module");
+	}
+
+	return buffer;
+}
+
+VkShaderModule ShaderExtensions::CreateShaderModule(const VkDevice& device, const std::vector<uint32_t>& shaderCode)
+{
+	VkShaderModuleCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = shaderCode.size() * sizeof(uint32_t);
+	createInfo.pCode = shaderCode.data();
+
+	VkShaderModule shaderModule;
+	if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create shader module");
+	}
+
+	return shaderModule;
+}
+
 VkShaderModule ShaderExtensions::CreateShaderModule(const VkDevice& device, const std::vector<char>& shaderText)
 {
 	VkShaderModuleCreateInfo createInfo = {};
@@ -60,6 +107,13 @@ stbi_uc* ShaderExtensions::CreateTextureImage(const char* filePath, int* texture
 	return pixels;
 }
 
+void ShaderExtensions::SaveTextureImage(const char* filePath, int textureWidth, int textureHeight, const std::vector<uint8_t>& pixels)
+{
+	if (!stbi_write_png(filePath, textureWidth, textureHeight, STBI_rgb_alpha, pixels.data(), textureWidth * STBI_rgb_alpha)) {
+		throw std::runtime_error("failed to save texture image");
+	}
+}
+
 void MeshExtensions::LoadModelToMemoryBuffer(
 	const char* modelPath,
 	VkDevice device,
@@ -74,6 +128,23 @@ void MeshExtensions::LoadModelToMemoryBuffer(
 	std::vector<Vertex> vertices; // = Vertex::GetSampleVertexMatrix();
 	std::vector<uint32_t> indices; // = Vertex::GetSampleVertexIndices();
 
+	LoadModel(modelPath, vertices, indices);
+
+	CreateModelBuffers(
+		vertices,
+		indices,
+		device,
+		physicalDevice,
+		commandPool,
+		graphicsQueue,
+		vertexBuffer,
+		vertexBufferMemory,
+		indexBuffer,
+		indexBufferMemory);
+}
+
+void MeshExtensions::LoadModel(const char* modelPath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
@@ -111,7 +182,20 @@ void MeshExtensions::LoadModelToMemoryBuffer(
 			indices.push_back(uniqueVertices[vertex]);
 		}
 	}
+}
 
+void MeshExtensions::CreateModelBuffers(
+	const std::vector<Vertex>& vertices,
+	const std::vector<uint32_t>& indices,
+	VkDevice device,
+	VkPhysicalDevice physicalDevice,
+	VkCommandPool commandPool,
+	VkQueue graphicsQueue,
+	VkBuffer& vertexBuffer,
+	VkDeviceMemory& vertexBufferMemory,
+	VkBuffer& indexBuffer,
+	VkDeviceMemory& indexBufferMemory)
+{
 	VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
 
 	VkBuffer stagingBuffer;
@@ -42,6 +42,22 @@ uint32_t MemoryUtils::FindMemoryType(
 	uint32_t typeFilter,
 	VkMemoryPropertyFlags properties,
 	VkPhysicalDevice physicalDevice)
+{
+	uint32_t memoryTypeIndex;
+
+	if (!TryFindMemoryType(typeFilter, properties, physicalDevice, memoryTypeIndex))
+	{
+		throw std::runtime_error("failed to find suitable memory type!");
+	}
+
+	return memoryTypeIndex;
+}
+
+bool MemoryUtils::TryFindMemoryType(
+	uint32_t typeFilter,
+	VkMemoryPropertyFlags properties,
+	VkPhysicalDevice physicalDevice,
+	uint32_t& memoryTypeIndex)
 {
 	VkPhysicalDeviceMemoryProperties memProperties;
 	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
@@ -50,11 +66,12 @@ uint32_t MemoryUtils::FindMemoryType(
 	{
 		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
 		{
-			return i;
+			memoryTypeIndex = i;
+			return true;
 		}
 	}
 
-	throw std::runtime_error("failed to find suitable memory type!");
+	return false;
 }
 
 void MemoryUtils::CopyBuffer(
@@ -110,13 +127,39 @@ void MemoryUtils::CreateImage(
 	VkDeviceMemory& imageMemory,
 	VkDevice device,
 	VkPhysicalDevice physicalDevice) {
+	CreateImage(
+		width,
+		height,
+		1,
+		format,
+		tiling,
+		usage,
+		properties,
+		image,
+		imageMemory,
+		device,
+		physicalDevice);
+}
+
+void MemoryUtils::CreateImage(
+	uint32_t width,
+	uint32_t height,
+	uint32_t mipLevels,
+	VkFormat format,
+	VkImageTiling tiling,
+	VkImageUsageFlags usage,
+	VkMemoryPropertyFlags properties,
+	VkImage& image,
+	VkDeviceMemory& imageMemory,
+	VkDevice device,
+	VkPhysicalDevice physicalDevice) {
 	VkImageCreateInfo imageInfo = {};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
 	imageInfo.extent.width = width;
 	imageInfo.extent.height = height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
@@ -170,8 +213,104 @@ void MemoryUtils::TransitionImageLayout(
 	VkDevice device,
 	VkCommandPool commandPool,
 	VkQueue graphicsQueue) {
+	TransitionImageLayout(
+		image,
+		format,
+		1,
+		oldLayout,
+		newLayout,
+		device,
+		commandPool,
+		graphicsQueue);
+}
+
+void MemoryUtils::TransitionImageLayout(
+	VkImage image,
+	VkFormat format,
+	uint32_t mipLevels,
+	VkImageLayout oldLayout,
+	VkImageLayout newLayout,
+	VkDevice device,
+	VkCommandPool commandPool,
+	VkQueue graphicsQueue) {
 	const VkCommandBuffer commandBuffer = GraphicsPipelineUtils::BeginSingleTimeCommands(device, commandPool);
 
+	RecordImageLayoutTransition(commandBuffer, image, format, mipLevels, oldLayout, newLayout);
+
+	GraphicsPipelineUtils::EndSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
+}
+
+void MemoryUtils::GetLayoutSyncScope(
+	VkImageLayout layout,
+	VkPipelineStageFlags& stageMask,
+	VkAccessFlags& accessMask) {
+	switch (layout) {
+	case VK_IMAGE_LAYOUT_UNDEFINED:
+	case VK_IMAGE_LAYOUT_PREINITIALIZED:
+		stageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		accessMask = 0;
+		break;
+	case VK_IMAGE_LAYOUT_GENERAL:
+		stageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		accessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+		stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		accessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+		stageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+		stageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+		stageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		accessMask = VK_ACCESS_SHADER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+		stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		accessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+		stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		accessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+		stageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		accessMask = 0;
+		break;
+	default:
+		throw std::invalid_argument("unsupported image layout!");
+	}
+}
+
+VkImageAspectFlags MemoryUtils::GetImageAspectFlags(VkFormat format) {
+	switch (format) {
+	case VK_FORMAT_D16_UNORM:
+	case VK_FORMAT_X8_D24_UNORM_PACK32:
+	case VK_FORMAT_D32_SFLOAT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT;
+	case VK_FORMAT_S8_UINT:
+		return VK_IMAGE_ASPECT_STENCIL_BIT;
+	case VK_FORMAT_D16_UNORM_S8_UINT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	default:
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+}
+
+void MemoryUtils::RecordImageLayoutTransition(
+	VkCommandBuffer commandBuffer,
+	VkImage image,
+	VkFormat format,
+	uint32_t mipLevels,
+	VkImageLayout oldLayout,
+	VkImageLayout newLayout) {
 	VkImageMemoryBarrier barrier = {};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	barrier.oldLayout = oldLayout;
@@ -179,50 +318,31 @@ void MemoryUtils::TransitionImageLayout(
 	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	barrier.image = image;
-
-	if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-
-		if (GraphicsPipelineUtils::HasStencilComponent(format)) {
-			barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-		}
-	}
-	else {
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	}
-
-	//barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.aspectMask = GetImageAspectFlags(format);
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
+	// the old layout's accesses are made available to the ones the new layout is used with
 	VkPipelineStageFlags sourceStage;
 	VkPipelineStageFlags destinationStage;
-
-	if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-	}
-	else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	}
-	else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	} 
-	else {
-		throw std::invalid_argument("unsupported layout transition!");
+	VkAccessFlags sourceAccess;
+	VkAccessFlags destinationAccess;
+
+	GetLayoutSyncScope(oldLayout, sourceStage, sourceAccess);
+	GetLayoutSyncScope(newLayout, destinationStage, destinationAccess);
+
+	// only writes need to be made available
+	barrier.srcAccessMask = sourceAccess & (
+		VK_ACCESS_SHADER_WRITE_BIT |
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_TRANSFER_WRITE_BIT);
+	barrier.dstAccessMask = destinationAccess;
+
+	if (destinationStage == VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT) {
+		barrier.dstAccessMask = 0;
 	}
 
 	vkCmdPipelineBarrier(
@@ -234,8 +354,6 @@ void MemoryUtils::TransitionImageLayout(
 		0, nullptr,
 		1, &barrier
 	);
-
-	GraphicsPipelineUtils::EndSingleTimeCommands(device, commandPool, graphicsQueue, commandBuffer);
 }
 
 void MemoryUtils::CopyBufferToImage(
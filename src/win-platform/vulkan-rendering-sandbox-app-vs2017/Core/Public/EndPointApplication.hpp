@@ -18,16 +18,21 @@ namespace VulkanCore
 		);
 		~EndPointApplication();
 		virtual void Run();
-		RenderEngine *VkEngine;
+		virtual void RunHeadless(uint32_t frameCount, const std::string& outputPath);
+		RenderEngine *VkEngine = nullptr;
 
 	protected:
 		virtual void OpenWindow();
 		virtual void Init();
 		virtual void Wait();
 		virtual void Loop();
+		// VK_RENDER_PIPELINED_UPDATE=1, an update thread simulates the next frame while this one is drawn
+		virtual void LoopPipelined();
 		virtual void Update();
 		virtual void Clean();
-		GLFWwindow *window;
+		// VK_RENDER_SCENE replaces the model and base color texture with the ones of the scene's first mesh node
+		virtual void ApplySceneFromEnvironment();
+		GLFWwindow *window = nullptr;
 
 	private:
 		int width;
@@ -0,0 +1,59 @@
+#ifndef _BENCHMARK_HARNESS_HPP_
+#define	_BENCHMARK_HARNESS_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace VulkanCore
+{
+	struct BenchmarkSettings
+	{
+		uint32_t frameCount = 600;
+		uint32_t warmupFrames = 30;
+		double timestepSeconds = 1.0 / 60.0;
+		int width = 1280;
+		int height = 1024;
+		uint32_t sampleCount = 1;
+		bool postProcessNoise = false;
+		bool meshletCulling = false;
+		std::string modelPath = "../Assets/Models/crystal.obj";
+		std::string baseColorTexturePath = "../Assets/Textures/crystalis_1001_BaseColor.png";
+		std::string outputPath = "benchmark.json";
+	};
+
+	// renders a fixed number of headless frames with a simulated timestep and reports the timings as JSON
+	class BenchmarkHarness
+	{
+	public:
+		explicit BenchmarkHarness(const BenchmarkSettings& settings);
+
+		nlohmann::json Run();
+		// one run per sample count, frame times and render target memory side by side
+		nlohmann::json CompareSampleCounts(const std::vector<uint32_t>& sampleCounts);
+		// one run per resolution scale, main pass GPU time per pixel shows what the fragment stage costs
+		nlohmann::json CompareFragmentThroughput(const std::vector<uint32_t>& resolutionScales);
+		// CPU reference of the Worley noise pass, naive against tiled, then frames with and without the compute pass
+		nlohmann::json CompareWorleyNoise(uint32_t cpuIterations = 5);
+		// world transform updates of a generated hierarchy, full, partial and clean, against a pointer based tree
+		nlohmann::json CompareSceneGraph(uint32_t nodeCount = 131072, uint32_t iterations = 20);
+		// parsing the JSON authoring form of a generated scene against mapping its compiled form
+		nlohmann::json CompareSceneLoading(uint32_t nodeCount = 16384, uint32_t iterations = 20);
+		// glm one object at a time against the batch kernels of every supported instruction set, single threaded
+		nlohmann::json CompareSimdKernels(uint32_t count = 65536, uint32_t iterations = 50);
+		// cost per job of queueing from outside, from a worker and as continuations, then parallel for speedup per thread count
+		nlohmann::json CompareJobSystem(uint32_t jobCount = 65536, uint32_t iterations = 10);
+		void WriteReport(const nlohmann::json& report) const;
+
+		static nlohmann::json Summarize(std::vector<double> samples);
+		static uint64_t GetPeakResidentBytes();
+
+	protected:
+		BenchmarkSettings Settings;
+
+		static double Percentile(const std::vector<double>& sortedSamples, double percentile);
+	};
+}
+
+#endif
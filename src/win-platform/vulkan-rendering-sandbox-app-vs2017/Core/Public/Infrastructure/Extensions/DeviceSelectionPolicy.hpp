@@ -0,0 +1,25 @@
+#ifndef _DEVICE_SELECTION_POLICY_HPP_
+#define	_DEVICE_SELECTION_POLICY_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+
+// picks the physical device by capability score, VK_RENDER_DEVICE=<index or name part> overrides the choice
+struct DeviceSelectionPolicy
+{
+	const static char* OVERRIDE_VARIABLE;
+
+	std::string preferredDeviceName;
+	int preferredDeviceIndex = -1;
+
+	static DeviceSelectionPolicy FromEnvironment();
+
+	bool HasOverride() const;
+	bool MatchesOverride(uint32_t deviceIndex, const VkPhysicalDeviceProperties& properties) const;
+
+	static int64_t ScoreDevice(VkPhysicalDevice device);
+	static const char* GetDeviceTypeName(VkPhysicalDeviceType deviceType);
+};
+
+#endif
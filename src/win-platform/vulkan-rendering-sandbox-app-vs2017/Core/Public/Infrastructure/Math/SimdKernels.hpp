@@ -0,0 +1,72 @@
+#ifndef _SIMD_KERNELS_HPP_
+#define	_SIMD_KERNELS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+// SSE2 and AVX2 kernels only exist on x86, elsewhere every instruction set runs the scalar ones
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_KERNELS_X86
+#endif
+
+namespace VulkanCore
+{
+	enum class SimdInstructionSet
+	{
+		Scalar,
+		Sse2,
+		Avx2
+	};
+
+	// the kernels of one instruction set, each handles any count with a scalar tail
+	struct SimdKernelTable
+	{
+		SimdInstructionSet instructionSet;
+		void (*multiplyMatrices)(const float* left, const float* right, float* results, size_t count);
+		void (*transformBoxes)(const float* matrices, const float* boxes, float* results, size_t count);
+		uint32_t (*cullSpheres)(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count);
+	};
+
+	// batch math over structure of arrays data, every attribute is a plane of count floats:
+	// 4x4 matrices are 16 planes with element [column][row] in plane column * 4 + row like glm,
+	// boxes are the planes minX, minY, minZ, maxX, maxY, maxZ and spheres x, y, z, radius
+	class SimdKernels
+	{
+	public:
+		// "scalar", "sse2" or "avx2", an instruction set the CPU lacks falls back to the detected one
+		const static char* INSTRUCTION_SET_VARIABLE;
+
+		// results[i] = left[i] * right[i], results must not overlap the inputs
+		static void MultiplyMatrices(const float* left, const float* right, float* results, size_t count);
+		// the world space bounds of every box under its matrix, which has to be affine
+		static void TransformBoxes(const float* matrices, const float* boxes, float* results, size_t count);
+		// frustum planes as MeshletBuilder::GetFrustumPlanes returns them, writes 1 for every sphere that
+		// touches the frustum and returns how many do
+		static uint32_t CullSpheres(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count);
+
+		// the kernels picked on first use, detected and then overridden from the environment
+		static const SimdKernelTable& GetKernels();
+		static const SimdKernelTable& GetKernels(SimdInstructionSet instructionSet);
+		static bool IsSupported(SimdInstructionSet instructionSet);
+		static const char* GetName(SimdInstructionSet instructionSet);
+
+	protected:
+		static SimdInstructionSet DetectInstructionSet();
+
+		// the scalar kernels over [begin, end) of planes count floats apart, also the tails of the wider ones
+		static void MultiplyMatricesScalar(const float* left, const float* right, float* results, size_t count, size_t begin, size_t end);
+		static void TransformBoxesScalar(const float* matrices, const float* boxes, float* results, size_t count, size_t begin, size_t end);
+		static uint32_t CullSpheresScalar(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count, size_t begin, size_t end);
+
+		static void MultiplyMatricesSse2(const float* left, const float* right, float* results, size_t count);
+		static void TransformBoxesSse2(const float* matrices, const float* boxes, float* results, size_t count);
+		static uint32_t CullSpheresSse2(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count);
+
+		// built with AVX2 code generation in their own translation unit, only called once detection found AVX2 and FMA
+		static void MultiplyMatricesAvx2(const float* left, const float* right, float* results, size_t count);
+		static void TransformBoxesAvx2(const float* matrices, const float* boxes, float* results, size_t count);
+		static uint32_t CullSpheresAvx2(const float planes[6][4], const float* spheres, uint8_t* visible, size_t count);
+	};
+}
+
+#endif
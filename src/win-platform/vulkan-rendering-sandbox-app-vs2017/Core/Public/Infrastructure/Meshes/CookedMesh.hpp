@@ -0,0 +1,73 @@
+#ifndef _COOKED_MESH_HPP_
+#define	_COOKED_MESH_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Utils/GraphUtils.hpp"
+#include "Meshlets.hpp"
+
+namespace VulkanCore
+{
+	struct MeshLod
+	{
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		// simplification error relative to the bounding sphere diameter, 0 for the source mesh
+		float error = 0.0f;
+		// the meshlets tile the level's index range
+		uint32_t firstMeshlet = 0;
+		uint32_t meshletCount = 0;
+	};
+
+	// a mesh with its levels of detail, finest first, all of them index the one vertex buffer
+	struct CookedMesh
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<MeshLod> lods;
+		std::vector<Meshlet> meshlets;
+		float boundsCenter[3] = { 0.0f, 0.0f, 0.0f };
+		float boundsRadius = 0.0f;
+	};
+
+	// builds the levels of detail of a model offline and caches them in a binary file next to it
+	class MeshCooker
+	{
+	public:
+		const static uint32_t MAX_LODS = 6;
+		// levels stop once simplification cannot get below this many triangles
+		const static uint32_t MIN_LOD_TRIANGLES = 32;
+		const static uint32_t FILE_MAGIC = 0x4D444F4C; // "LODM"
+		const static uint32_t FILE_VERSION = 2;
+
+		static void Cook(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, CookedMesh& mesh);
+
+		// reads the cooked file of the model, cooking and writing it first when it is missing or out of date
+		static void LoadOrCook(const std::string& modelPath, CookedMesh& mesh);
+		static bool Load(const std::string& cookedPath, const std::string& sourcePath, CookedMesh& mesh);
+		static bool Save(const std::string& cookedPath, const std::string& sourcePath, const CookedMesh& mesh);
+		static std::string GetCookedPath(const std::string& modelPath);
+
+	protected:
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			// the source model the file was cooked from, any change to it invalidates the file
+			uint64_t sourceSize;
+			int64_t sourceWriteTime;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t lodCount;
+			uint32_t meshletCount;
+			uint32_t vertexSize;
+			float boundsCenter[3];
+			float boundsRadius;
+		};
+
+		static bool GetSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& writeTime);
+	};
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef _GLTF_MODEL_HPP_
+#define	_GLTF_MODEL_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Utils/GraphUtils.hpp"
+#include "../Scene/SceneGraph.hpp"
+
+namespace VulkanCore
+{
+	// strided view of one accessor inside a glTF buffer, nothing is converted until the data is written out
+	struct GltfStream
+	{
+		uint32_t buffer = 0;
+		size_t offset = 0;
+		uint32_t stride = 0;
+		// TINYGLTF_COMPONENT_TYPE_*, 0 when the primitive has no such attribute
+		uint32_t componentType = 0;
+		uint32_t componentCount = 0;
+		bool normalized = false;
+	};
+
+	struct GltfPrimitive
+	{
+		// ranges of the model's vertex and index data, indices are relative to firstVertex
+		uint32_t firstVertex = 0;
+		uint32_t vertexCount = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		uint32_t material = 0;
+		GltfStream position;
+		GltfStream color;
+		GltfStream textureCoords;
+		GltfStream indices;
+	};
+
+	struct GltfMesh
+	{
+		std::string name;
+		uint32_t firstPrimitive = 0;
+		uint32_t primitiveCount = 0;
+	};
+
+	struct GltfMaterial
+	{
+		std::string name;
+		float baseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		// relative to the working directory like every other asset path, empty without a texture file
+		std::string baseColorTexturePath;
+	};
+
+	// nodes are parents first, like in SceneGraph
+	struct GltfNode
+	{
+		std::string name;
+		uint32_t parent = NO_INDEX;
+		uint32_t mesh = NO_INDEX;
+		glm::vec3 translation = glm::vec3(0.0f);
+		glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+
+		const static uint32_t NO_INDEX = 0xFFFFFFFF;
+	};
+
+	// a glTF 2.0 model, .glb files are read from their binary chunk, .gltf files from JSON with embedded or external buffers;
+	// the buffers are kept as loaded and vertices are only assembled when flattened
+	class GltfModel
+	{
+	public:
+		// throws when the file cannot be read or uses an attribute layout that cannot become a Vertex
+		explicit GltfModel(const std::string& path);
+
+		const std::vector<GltfMesh>& GetMeshes() const;
+		const std::vector<GltfPrimitive>& GetPrimitives() const;
+		const std::vector<GltfMaterial>& GetMaterials() const;
+		const std::vector<GltfNode>& GetNodes() const;
+		uint32_t GetVertexCount() const;
+		uint32_t GetIndexCount() const;
+
+		// the meshes of every node in world space as one indexed triangle list, for the mesh cooker;
+		// primitive materials are not kept, the cooked mesh is drawn with a single material
+		void Flatten(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) const;
+
+		SceneNodeId AppendTo(SceneGraph& scene) const;
+
+		static bool IsGltfPath(const std::string& path);
+
+	protected:
+		std::vector<std::vector<uint8_t>> Buffers;
+		std::vector<GltfMesh> Meshes;
+		std::vector<GltfPrimitive> Primitives;
+		std::vector<GltfMaterial> Materials;
+		std::vector<GltfNode> Nodes;
+		uint32_t VertexCount = 0;
+		uint32_t IndexCount = 0;
+
+	};
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef _MESH_LOD_SELECTOR_HPP_
+#define	_MESH_LOD_SELECTOR_HPP_
+
+#include <cstdint>
+#include <vector>
+#include "CookedMesh.hpp"
+
+namespace VulkanCore
+{
+	struct MeshLodSettings
+	{
+		// largest simplification error, in pixels, a level may show on screen
+		float pixelError = 1.0f;
+		// a coarser level is only taken once it stays under the error by this fraction,
+		// so objects near a threshold do not switch back and forth every frame
+		float hysteresis = 0.25f;
+	};
+
+	class MeshLodSelector
+	{
+	public:
+		// diameter in pixels of a bounding sphere seen at the given distance
+		static float GetScreenSize(float boundsRadius, float distance, float verticalFieldOfView, uint32_t viewportHeight);
+
+		// coarsest level whose error projected at screenSize stays within the settings, starting from currentLod
+		static uint32_t SelectLod(const std::vector<MeshLod>& lods, float screenSize, uint32_t currentLod, const MeshLodSettings& settings = MeshLodSettings());
+	};
+}
+
+#endif
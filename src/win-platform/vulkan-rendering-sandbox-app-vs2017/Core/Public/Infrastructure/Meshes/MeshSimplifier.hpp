@@ -0,0 +1,55 @@
+#ifndef _MESH_SIMPLIFIER_HPP_
+#define	_MESH_SIMPLIFIER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanCore
+{
+	// quadric error metric simplification (Garland and Heckbert) of an indexed triangle list
+	// edges are collapsed onto one of their end points, so the result indexes the same vertex buffer as the input
+	class MeshSimplifier
+	{
+	public:
+		// positions are read as three floats every positionStride bytes
+		// collapses stop once at most targetIndexCount indices are left or the next one would exceed targetError,
+		// returns the error of the result as an object space distance
+		static float Simplify(
+			const std::vector<uint32_t>& indices,
+			const float* positions,
+			size_t vertexCount,
+			size_t positionStride,
+			size_t targetIndexCount,
+			float targetError,
+			std::vector<uint32_t>& destination);
+
+	protected:
+		// symmetric 4x4 matrix of the summed squared plane distances, weighted by triangle area
+		struct Quadric
+		{
+			double a00, a11, a22, a01, a02, a12;
+			double b0, b1, b2;
+			double c;
+			double weight;
+
+			void AddPlane(double nx, double ny, double nz, double d, double planeWeight);
+			void Add(const Quadric& other);
+			// area weighted mean squared distance of a point to the accumulated planes
+			double Evaluate(const float* point) const;
+		};
+
+		struct Collapse
+		{
+			uint32_t from;
+			uint32_t to;
+			double error;
+		};
+
+		// vertices sharing a position are welded so seams do not split the topology
+		static void WeldPositions(const float* positions, size_t vertexCount, size_t positionStride, std::vector<uint32_t>& positionIds);
+		static bool FlipsTriangle(const float* from, const float* to, const float* a, const float* b);
+	};
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef _MESHLETS_HPP_
+#define	_MESHLETS_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Utils/GraphUtils.hpp"
+
+namespace VulkanCore
+{
+	// a cluster of triangles that is culled as a whole, laid out like the Meshlet struct of meshlet_cull.comp
+	struct Meshlet
+	{
+		float center[3];
+		float radius;
+		// every triangle normal lies within the cone around the axis, a cutoff of 1 means the normals
+		// spread too far for the cluster to ever face away from the camera as a whole
+		float coneAxis[3];
+		float coneCutoff;
+		// the triangles are the index range [firstIndex, firstIndex + triangleCount * 3)
+		uint32_t firstIndex;
+		uint32_t triangleCount;
+		uint32_t vertexCount;
+		uint32_t padding;
+	};
+
+	static_assert(sizeof(Meshlet) == 48, "Meshlet has to match the std430 layout of meshlet_cull.comp");
+
+	class MeshletBuilder
+	{
+	public:
+		const static uint32_t MAX_VERTICES = 64;
+		const static uint32_t MAX_TRIANGLES = 124;
+
+		// reorders the triangles of the index range into meshlets and appends those, clusters are grown
+		// over shared vertices so they stay spatially compact
+		static void Build(
+			const std::vector<Vertex>& vertices,
+			std::vector<uint32_t>& indices,
+			uint32_t firstIndex,
+			uint32_t indexCount,
+			std::vector<Meshlet>& meshlets);
+
+		// checks that the meshlets cover the index range and respect the limits, bounds and cones,
+		// needs no device so cooked data can be verified anywhere
+		static bool Validate(
+			const std::vector<Vertex>& vertices,
+			const std::vector<uint32_t>& indices,
+			uint32_t firstIndex,
+			uint32_t indexCount,
+			const std::vector<Meshlet>& meshlets,
+			uint32_t firstMeshlet,
+			uint32_t meshletCount,
+			std::string& error);
+
+		// planes of the view frustum of a model space to clip space transform, normalized and facing inwards
+		static void GetFrustumPlanes(const glm::mat4& modelViewProjection, float planes[6][4]);
+
+		// CPU reference of meshlet_cull.comp, the camera position is in model space
+		static bool IsVisible(const Meshlet& meshlet, const float cameraPosition[3], const float planes[6][4]);
+	};
+}
+
+#endif
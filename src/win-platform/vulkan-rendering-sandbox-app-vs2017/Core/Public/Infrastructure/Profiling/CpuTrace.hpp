@@ -0,0 +1,70 @@
+#ifndef _CPU_TRACE_HPP_
+#define	_CPU_TRACE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VulkanCore
+{
+	struct CpuTraceEvent
+	{
+		// zone names are string literals, only the pointer is recorded
+		const char* name;
+		int64_t startNanoseconds;
+		int64_t durationNanoseconds;
+	};
+
+	// scoped zones recorded into per-thread buffers and exported as Chrome Trace Event JSON
+	class CpuTrace
+	{
+	public:
+		static const char* OUTPUT_VARIABLE;
+		const static size_t EVENTS_PER_THREAD = 1 << 16;
+
+		// enables tracing when the output variable is set, returns the trace path or an empty string
+		static std::string EnableFromEnvironment();
+
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled();
+		static int64_t Now();
+		static void Record(const char* name, int64_t startNanoseconds, int64_t endNanoseconds);
+
+		// zones still being recorded on other threads are not exported
+		static void WriteChromeTrace(const std::string& outputPath);
+
+	protected:
+		struct ThreadBuffer
+		{
+			uint32_t threadId = 0;
+			std::vector<CpuTraceEvent> events;
+			std::atomic<size_t> eventCount{ 0 };
+			std::atomic<uint64_t> droppedCount{ 0 };
+		};
+
+		static std::atomic<bool> Enabled;
+		static std::mutex RegistryLock;
+		static std::vector<std::shared_ptr<ThreadBuffer>> Registry;
+
+		static ThreadBuffer& GetThreadBuffer();
+	};
+
+	class CpuTraceZone
+	{
+	public:
+		explicit CpuTraceZone(const char* name);
+		~CpuTraceZone();
+
+		CpuTraceZone(const CpuTraceZone&) = delete;
+		CpuTraceZone& operator=(const CpuTraceZone&) = delete;
+
+	protected:
+		const char* Name;
+		int64_t StartNanoseconds;
+	};
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef _GPU_PROFILER_HPP_
+#define	_GPU_PROFILER_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace VulkanCore
+{
+	struct GpuScopeStatistics
+	{
+		double lastMilliseconds = 0.0;
+		double averageMilliseconds = 0.0;
+		double minMilliseconds = 0.0;
+		double maxMilliseconds = 0.0;
+		uint64_t lastFrameIndex = 0;
+		uint64_t sampleCount = 0;
+
+		// rolling window the average, min and max are computed over
+		std::vector<double> window;
+		size_t windowPosition = 0;
+	};
+
+	// timestamp queries around labelled scopes, results are read back once the frame fence has signaled
+	class GpuProfiler
+	{
+	public:
+		const static uint32_t INVALID_SCOPE = ~0u;
+
+		GpuProfiler(
+			VkDevice device,
+			VkPhysicalDevice physicalDevice,
+			uint32_t queueFamilyIndex,
+			uint32_t framesInFlight,
+			uint32_t maxScopesPerFrame = 32,
+			size_t statisticsWindow = 120);
+		~GpuProfiler();
+
+		bool IsSupported() const;
+
+		// the slot's previous results must be collected first, call after waiting for its fence
+		void BeginFrame(uint32_t frameSlot, uint64_t frameIndex);
+		void CollectResults(uint32_t frameSlot);
+
+		// scopes cannot start inside a render pass, the query reset is recorded with the first timestamp
+		uint32_t BeginScope(VkCommandBuffer commandBuffer, const std::string& name);
+		void EndScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+		const std::map<std::string, GpuScopeStatistics>& GetStatistics() const;
+		bool GetLastScopeTime(const std::string& name, uint64_t& frameIndex, double& milliseconds) const;
+		std::string FormatStatistics() const;
+
+	protected:
+		struct FrameSlot
+		{
+			uint64_t frameIndex = 0;
+			std::vector<std::string> scopeNames;
+			std::vector<bool> scopeEnded;
+		};
+
+		VkDevice vkDevice;
+		VkQueryPool vkQueryPool = VK_NULL_HANDLE;
+		float TimestampPeriod = 1.0f;
+		uint64_t TimestampMask = ~0ull;
+		uint32_t MaxScopesPerFrame;
+		size_t StatisticsWindow;
+		uint32_t CurrentSlot = 0;
+
+		std::vector<FrameSlot> Slots;
+		std::map<std::string, GpuScopeStatistics> Statistics;
+
+		void AddSample(const std::string& name, uint64_t frameIndex, double milliseconds);
+	};
+}
+
+#endif
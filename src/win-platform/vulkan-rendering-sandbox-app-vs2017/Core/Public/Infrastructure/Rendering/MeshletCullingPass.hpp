@@ -0,0 +1,63 @@
+#ifndef _MESHLET_CULLING_PASS_HPP_
+#define	_MESHLET_CULLING_PASS_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../Meshes/Meshlets.hpp"
+
+namespace VulkanCore
+{
+	// matches the push constant block of meshlet_cull.comp
+	struct MeshletCullingConstants
+	{
+		float frustumPlanes[6][4];
+		float cameraPosition[4];
+		uint32_t firstMeshlet;
+		uint32_t meshletCount;
+	};
+
+	// culls meshlets against the frustum and their normal cones on the GPU, the result is one indexed
+	// indirect draw per meshlet with an instance count of 0 for the rejected ones
+	class MeshletCullingPass
+	{
+	public:
+		const static uint32_t WORKGROUP_SIZE = 64;
+
+		// every frame in flight gets its own draw buffer
+		MeshletCullingPass(
+			VkDevice device,
+			VkPhysicalDevice physicalDevice,
+			VkCommandPool commandPool,
+			VkQueue graphicsQueue,
+			const std::string& shaderPath,
+			const std::vector<Meshlet>& meshlets,
+			uint32_t frameCount,
+			bool multiDrawIndirect);
+		~MeshletCullingPass();
+
+		// has to be recorded outside of a render pass, the draws are visible to the draw indirect stage afterwards
+		void Record(VkCommandBuffer commandBuffer, uint32_t frameIndex, const MeshletCullingConstants& constants) const;
+
+		// draws the culled meshlets with the pipeline, vertex and index buffers bound by the caller
+		void Draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t firstMeshlet, uint32_t meshletCount) const;
+
+	protected:
+		VkDevice vkDevice;
+		bool MultiDrawIndirect;
+
+		VkBuffer vkMeshletBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory vkMeshletBufferMemory = VK_NULL_HANDLE;
+		std::vector<VkBuffer> vkDrawBuffers;
+		std::vector<VkDeviceMemory> vkDrawBuffersMemory;
+
+		VkDescriptorSetLayout vkDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool vkDescriptorPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorSet> vkDescriptorSets;
+		VkPipelineLayout vkPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline vkPipeline = VK_NULL_HANDLE;
+	};
+}
+
+#endif
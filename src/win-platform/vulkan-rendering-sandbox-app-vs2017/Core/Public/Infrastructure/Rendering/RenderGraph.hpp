@@ -0,0 +1,175 @@
+#ifndef _RENDER_GRAPH_HPP_
+#define	_RENDER_GRAPH_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Profiling/GpuProfiler.hpp"
+
+namespace VulkanCore
+{
+	typedef uint32_t RenderGraphResource;
+
+	struct RenderGraphImageDescription
+	{
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkExtent2D extent = { 0, 0 };
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+	};
+
+	// layout and last accesses of an image outside of the graph
+	struct RenderGraphImageState
+	{
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		VkAccessFlags accessMask = 0;
+	};
+
+	// passes declare what they read and write, barriers, layout transitions, render passes and
+	// transient image memory are derived from the declarations when the graph is compiled
+	class RenderGraph
+	{
+	public:
+		RenderGraph(VkDevice device, VkPhysicalDevice physicalDevice);
+		~RenderGraph();
+
+		// imported images are owned outside of the graph and are bound again before every execution
+		RenderGraphResource ImportImage(
+			const std::string& name,
+			const RenderGraphImageDescription& description,
+			const RenderGraphImageState& initialState,
+			const RenderGraphImageState& finalState);
+		void SetImportedImage(RenderGraphResource resource, VkImage image, VkImageView imageView);
+
+		// transient images live for one execution, images with disjoint lifetimes share memory
+		RenderGraphResource CreateImage(const std::string& name, const RenderGraphImageDescription& description);
+
+		// passes are executed in the order they are added
+		uint32_t AddPass(const std::string& name, std::function<void(VkCommandBuffer)> execute);
+		void WriteColorAttachment(uint32_t pass, RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor = {});
+		void WriteDepthAttachment(uint32_t pass, RenderGraphResource resource, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clearDepth = { 1.0f, 0 });
+		// the multisampled color attachment is resolved into the single sampled destination at the end of the subpass
+		void ResolveAttachment(uint32_t pass, RenderGraphResource source, RenderGraphResource destination);
+		void ReadTexture(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask);
+		void ReadStorage(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask);
+		void WriteStorage(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask);
+		void ReadWriteStorage(uint32_t pass, RenderGraphResource resource, VkPipelineStageFlags stageMask);
+		void ReadTransfer(uint32_t pass, RenderGraphResource resource);
+		void WriteTransfer(uint32_t pass, RenderGraphResource resource);
+
+		// passes whose results never reach an imported image are culled
+		void Compile();
+		void Execute(VkCommandBuffer commandBuffer, GpuProfiler* profiler = nullptr);
+
+		VkRenderPass GetRenderPass(uint32_t pass) const;
+		VkImage GetImage(RenderGraphResource resource) const;
+		VkImageView GetImageView(RenderGraphResource resource) const;
+		bool IsPassCulled(uint32_t pass) const;
+		uint32_t GetCulledPassCount() const;
+		VkDeviceSize GetTransientMemorySize() const;
+		VkDeviceSize GetLazilyAllocatedMemorySize() const;
+
+	protected:
+		enum UsageType
+		{
+			USAGE_COLOR_ATTACHMENT,
+			USAGE_DEPTH_ATTACHMENT,
+			USAGE_RESOLVE_ATTACHMENT,
+			USAGE_SAMPLED,
+			USAGE_STORAGE,
+			USAGE_TRANSFER_SRC,
+			USAGE_TRANSFER_DST
+		};
+
+		struct ResourceUsage
+		{
+			RenderGraphResource resource;
+			UsageType type;
+			bool write;
+			VkImageLayout layout;
+			VkPipelineStageFlags stageMask;
+			VkAccessFlags accessMask;
+			VkAttachmentLoadOp loadOp;
+			VkClearValue clearValue;
+			RenderGraphResource resolveSource;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			std::function<void(VkCommandBuffer)> execute;
+			std::vector<ResourceUsage> usages;
+			bool culled = false;
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			std::map<std::vector<VkImageView>, VkFramebuffer> frameBuffers;
+		};
+
+		struct Resource
+		{
+			std::string name;
+			RenderGraphImageDescription description;
+			VkImageAspectFlags aspectMask = 0;
+			bool imported = false;
+			RenderGraphImageState initialState;
+			RenderGraphImageState finalState;
+
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView imageView = VK_NULL_HANDLE;
+			uint32_t firstPass = ~0u;
+			uint32_t lastPass = 0;
+			uint32_t memoryBlock = ~0u;
+			bool transientAttachment = false;
+		};
+
+		struct ResourceState
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags modifyStages = 0;
+			VkAccessFlags modifyAccess = 0;
+			VkPipelineStageFlags readStages = 0;
+			bool initialized = false;
+		};
+
+		// accesses of every image placed in the block, aliasing images wait on them
+		struct MemoryBlock
+		{
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			VkDeviceSize alignment = 1;
+			uint32_t memoryTypeBits = ~0u;
+			bool transientAttachments = false;
+			bool lazilyAllocated = false;
+			std::vector<RenderGraphResource> resources;
+			VkPipelineStageFlags stageMask = 0;
+			VkAccessFlags accessMask = 0;
+		};
+
+		VkDevice vkDevice;
+		VkPhysicalDevice vkPhysicalDevice;
+		bool IsCompiled = false;
+
+		std::vector<Resource> Resources;
+		std::vector<Pass> Passes;
+		std::vector<MemoryBlock> MemoryBlocks;
+
+		static bool IsAttachment(const ResourceUsage& usage);
+
+		void AddUsage(uint32_t pass, const ResourceUsage& usage);
+		void CullPasses();
+		void AllocateTransientImages();
+		void CreateRenderPass(Pass& pass, uint32_t passIndex);
+		bool IsReadAfter(RenderGraphResource resource, uint32_t passIndex) const;
+		VkFramebuffer GetFrameBuffer(Pass& pass, VkExtent2D& extent);
+		void AddBarrier(
+			const ResourceUsage& usage,
+			ResourceState& state,
+			std::vector<VkImageMemoryBarrier>& barriers,
+			VkPipelineStageFlags& srcStageMask,
+			VkPipelineStageFlags& dstStageMask);
+	};
+}
+
+#endif
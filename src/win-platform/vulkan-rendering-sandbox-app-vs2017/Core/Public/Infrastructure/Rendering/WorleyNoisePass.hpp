@@ -0,0 +1,69 @@
+#ifndef _WORLEY_NOISE_PASS_HPP_
+#define	_WORLEY_NOISE_PASS_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkanCore
+{
+	struct WorleyNoiseParameters
+	{
+		// pixels per noise cell, at least TILE_SIZE so a tile never spans more than two cells per axis
+		float cellSize = 100.0f;
+		float timeSpeed = 0.5f;
+	};
+
+	// matches the push constant block of worley_post_process.comp
+	struct WorleyNoiseConstants
+	{
+		float phase[2];
+		float inverseCellSize;
+	};
+
+	// CPU reference of worley_post_process.comp, the naive version searches nine cells per pixel
+	// like the fragment shader it replaces, the tiled one mirrors the shared memory tiles of the compute shader
+	class WorleyNoise
+	{
+	public:
+		const static uint32_t TILE_SIZE = 16;
+		const static uint32_t TILE_CELLS = 4;
+
+		static WorleyNoiseConstants GetConstants(const WorleyNoiseParameters& parameters, float time);
+		static float Random(float x, float y);
+
+		// squared distance to the nearest feature point for every pixel, row major
+		static void RenderNaive(uint32_t width, uint32_t height, const WorleyNoiseConstants& constants, std::vector<float>& distances);
+		static void RenderTiled(uint32_t width, uint32_t height, const WorleyNoiseConstants& constants, std::vector<float>& distances);
+
+		// color the shader adds to the frame for a squared distance
+		static void GetColor(float distance, float color[3]);
+	};
+
+	// adds animated Worley noise to an RGBA16F storage image in place
+	class WorleyNoisePass
+	{
+	public:
+		const static VkFormat TARGET_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+		WorleyNoisePass(VkDevice device, const std::string& shaderPath, const WorleyNoiseParameters& parameters = WorleyNoiseParameters());
+		~WorleyNoisePass();
+
+		// the target has to be in the general layout when the pass is recorded
+		void SetTarget(VkImageView imageView);
+		void Record(VkCommandBuffer commandBuffer, VkExtent2D extent, float time) const;
+
+	protected:
+		VkDevice vkDevice;
+		WorleyNoiseParameters Parameters;
+
+		VkDescriptorSetLayout vkDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool vkDescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet vkDescriptorSet = VK_NULL_HANDLE;
+		VkPipelineLayout vkPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline vkPipeline = VK_NULL_HANDLE;
+	};
+}
+
+#endif
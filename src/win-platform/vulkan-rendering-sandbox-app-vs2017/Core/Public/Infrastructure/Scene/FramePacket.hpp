@@ -0,0 +1,23 @@
+#ifndef _FRAME_PACKET_HPP_
+#define	_FRAME_PACKET_HPP_
+
+#include <cstdint>
+#include <vector>
+#include "../../Utils/GraphUtils.hpp"
+
+namespace VulkanCore
+{
+	// everything the simulation of one frame hands to rendering, the render thread never reads the scene
+	// graph itself so the next frame can be simulated while this one is recorded and submitted
+	struct FramePacket
+	{
+		uint64_t updateNumber = 0;
+		float time = 0.0f;
+		glm::vec3 eye = glm::vec3(0.0f);
+		glm::mat4 view = glm::mat4(1.0f);
+		// world transforms of all scene nodes, indexed by node id
+		std::vector<glm::mat4> worldTransforms;
+	};
+}
+
+#endif
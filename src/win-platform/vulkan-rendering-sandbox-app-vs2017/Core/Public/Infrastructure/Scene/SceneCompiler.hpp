@@ -0,0 +1,29 @@
+#ifndef _SCENE_COMPILER_HPP_
+#define	_SCENE_COMPILER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace VulkanCore
+{
+	// turns the JSON authoring form of a scene into the binary form SceneFile maps, for ex.
+	// { "textures": [ { "name", "path" } ],
+	//   "materials": [ { "name", "baseColor": [r, g, b, a], "baseColorTexture": <texture name> } ],
+	//   "meshes": [ { "name", "path" } ],
+	//   "nodes": [ { "name", "parent": <node name>, "translation": [x, y, z], "rotation": [x, y, z, w],
+	//                "scale": [x, y, z], "mesh": <mesh name>, "material": <material name> } ] }
+	// references are by name, nodes may be listed in any order
+	class SceneCompiler
+	{
+	public:
+		// throws std::runtime_error on missing fields, unknown or duplicate names and parent cycles
+		static void Compile(const nlohmann::json& scene, std::vector<uint8_t>& binary);
+		static void CompileFile(const std::string& scenePath, const std::string& outputPath);
+		// the authoring file with its extension replaced by .scn
+		static std::string GetCompiledPath(const std::string& scenePath);
+	};
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef _SCENE_FILE_HPP_
+#define	_SCENE_FILE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SceneGraph.hpp"
+
+namespace VulkanCore
+{
+	// the binary scene is a header followed by arrays of the structs below, every reference is an index into
+	// one of the arrays or an offset into the string table, and every offset is relative to the start of the
+	// file, so a mapped file is used as it is; little endian, sections are 16 byte aligned
+	struct SceneFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t fileSize;
+		uint32_t nodeCount;
+		uint32_t nodesOffset;
+		uint32_t meshCount;
+		uint32_t meshesOffset;
+		uint32_t materialCount;
+		uint32_t materialsOffset;
+		uint32_t textureCount;
+		uint32_t texturesOffset;
+		uint32_t stringsSize;
+		uint32_t stringsOffset;
+	};
+
+	// nodes are stored parents first, the order SceneGraph keeps them in
+	struct SceneFileNode
+	{
+		uint32_t name;
+		uint32_t parent;
+		float translation[3];
+		// x, y, z, w
+		float rotation[4];
+		float scale[3];
+		uint32_t mesh;
+		uint32_t material;
+	};
+
+	struct SceneFileMesh
+	{
+		uint32_t name;
+		uint32_t path;
+	};
+
+	struct SceneFileMaterial
+	{
+		uint32_t name;
+		float baseColorFactor[4];
+		uint32_t baseColorTexture;
+	};
+
+	struct SceneFileTexture
+	{
+		uint32_t name;
+		uint32_t path;
+	};
+
+	// a compiled scene mapped read only into memory, nothing is parsed or copied on open
+	class SceneFile
+	{
+	public:
+		const static uint32_t FILE_MAGIC = 0x424E4353; // "SCNB"
+		const static uint32_t FILE_VERSION = 1;
+		const static uint32_t NO_INDEX = 0xFFFFFFFF;
+		const static uint32_t SECTION_ALIGNMENT = 16;
+		// VK_RENDER_SCENE=<compiled scene> takes the model and its base color texture from the scene
+		const static char* PATH_VARIABLE;
+
+		// throws when the file cannot be mapped or fails Validate
+		explicit SceneFile(const std::string& path);
+		~SceneFile();
+		SceneFile(const SceneFile&) = delete;
+		SceneFile& operator=(const SceneFile&) = delete;
+
+		uint32_t GetNodeCount() const;
+		uint32_t GetMeshCount() const;
+		uint32_t GetMaterialCount() const;
+		uint32_t GetTextureCount() const;
+		const SceneFileNode* GetNodes() const;
+		const SceneFileMesh* GetMeshes() const;
+		const SceneFileMaterial* GetMaterials() const;
+		const SceneFileTexture* GetTextures() const;
+		const char* GetString(uint32_t offset) const;
+
+		// adds the nodes in file order, node i of the file becomes the returned id + i
+		SceneNodeId AppendTo(SceneGraph& scene) const;
+
+		// first node that references a mesh, NO_INDEX when there is none
+		uint32_t FindFirstMeshNode() const;
+
+		// checks the header, the section bounds and every index and string reference, one linear pass over
+		// the references with no allocation; throws std::runtime_error describing the first problem
+		static void Validate(const uint8_t* data, size_t size);
+
+		static std::string GetPathFromEnvironment();
+
+	protected:
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+		// platform handles of the mapping
+		void* FileHandle = nullptr;
+		void* MappingHandle = nullptr;
+
+		const SceneFileHeader& GetHeader() const;
+		void Unmap();
+	};
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef _SCENE_GRAPH_HPP_
+#define	_SCENE_GRAPH_HPP_
+
+#include <cstdint>
+#include <vector>
+#include "../../Utils/GraphUtils.hpp"
+#include <glm/gtc/quaternion.hpp>
+
+namespace VulkanCore
+{
+	typedef uint32_t SceneNodeId;
+
+	// transform hierarchy stored as parallel arrays indexed by node, every parent precedes its children
+	// so world transforms are brought up to date in one pass from the first changed node to the end
+	class SceneGraph
+	{
+	public:
+		const static SceneNodeId NO_PARENT = 0xFFFFFFFF;
+
+		void Reserve(size_t nodeCount);
+		void Clear();
+
+		// the parent has to exist already, which is what keeps parents ahead of their children
+		SceneNodeId AddNode(
+			SceneNodeId parent,
+			const glm::vec3& translation = glm::vec3(0.0f),
+			const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+			const glm::vec3& scale = glm::vec3(1.0f));
+
+		size_t GetNodeCount() const;
+		SceneNodeId GetParent(SceneNodeId node) const;
+
+		// local transforms, changing one marks the node and, on the next update, its subtree
+		const glm::vec3& GetTranslation(SceneNodeId node) const;
+		const glm::quat& GetRotation(SceneNodeId node) const;
+		const glm::vec3& GetScale(SceneNodeId node) const;
+		void SetTranslation(SceneNodeId node, const glm::vec3& translation);
+		void SetRotation(SceneNodeId node, const glm::quat& rotation);
+		void SetScale(SceneNodeId node, const glm::vec3& scale);
+
+		// valid after UpdateWorldTransforms
+		const glm::mat4& GetWorldTransform(SceneNodeId node) const;
+		const std::vector<glm::mat4>& GetWorldTransforms() const;
+
+		// recomputes the changed nodes and their descendants, returns how many were recomputed
+		uint32_t UpdateWorldTransforms();
+
+		// order that puts every node of an arbitrary hierarchy after its parent, siblings stay together;
+		// throws when a parent is out of range or the hierarchy has a cycle
+		static std::vector<SceneNodeId> SortParentsFirst(const std::vector<SceneNodeId>& parents);
+
+	protected:
+		std::vector<SceneNodeId> Parents;
+		std::vector<glm::vec3> Translations;
+		std::vector<glm::quat> Rotations;
+		std::vector<glm::vec3> Scales;
+		std::vector<glm::mat4> WorldTransforms;
+		std::vector<uint8_t> DirtyFlags;
+		// nodes ahead of the first dirty one cannot be affected by any change
+		size_t FirstDirtyNode = 0;
+
+		void MarkDirty(SceneNodeId node);
+	};
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef _PIPELINE_VARIANT_CACHE_HPP_
+#define	_PIPELINE_VARIANT_CACHE_HPP_
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanCore
+{
+	// bit i of a feature mask drives the boolean specialization constant with constant_id i
+	enum ShaderFeature : uint32_t
+	{
+		SHADER_FEATURE_TEXTURE = 1u << 0,
+		SHADER_FEATURE_VERTEX_COLOR = 1u << 1,
+		SHADER_FEATURE_ALPHA_TEST = 1u << 2
+	};
+
+	struct ShaderVariantSpecialization
+	{
+		const static uint32_t FEATURE_COUNT = 3;
+
+		std::array<VkBool32, FEATURE_COUNT> constants;
+		std::array<VkSpecializationMapEntry, FEATURE_COUNT> mapEntries;
+		VkSpecializationInfo info;
+
+		explicit ShaderVariantSpecialization(uint32_t features);
+		ShaderVariantSpecialization(const ShaderVariantSpecialization&) = delete;
+		ShaderVariantSpecialization& operator=(const ShaderVariantSpecialization&) = delete;
+	};
+
+	class PipelineVariantCache
+	{
+	public:
+		typedef std::function<VkPipeline(const VkSpecializationInfo&)> PipelineBuilder;
+
+		PipelineVariantCache(VkDevice device, PipelineBuilder builder);
+		~PipelineVariantCache();
+
+		VkPipeline GetPipeline(uint32_t features);
+		void AddPipeline(uint32_t features, VkPipeline pipeline);
+		void Clear();
+		std::vector<VkPipeline> Release();
+
+		size_t GetPipelineCount() const;
+
+	protected:
+		VkDevice vkDevice;
+		PipelineBuilder Builder;
+
+		std::unordered_map<uint32_t, VkPipeline> Pipelines;
+	};
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef _SHADER_COMPILER_HPP_
+#define	_SHADER_COMPILER_HPP_
+
+#include <string>
+
+namespace VulkanCore
+{
+	class ShaderCompiler
+	{
+	public:
+		static bool IsShaderSource(const std::string& fileName);
+		static bool CompileToSpirv(const std::string& sourcePath, const std::string& outputPath, std::string& log);
+
+	protected:
+		static std::string GetToolPath(const std::string& toolName);
+		static int RunCommand(const std::string& command);
+		static std::string ReadLog(const std::string& logPath);
+	};
+}
+
+#endif
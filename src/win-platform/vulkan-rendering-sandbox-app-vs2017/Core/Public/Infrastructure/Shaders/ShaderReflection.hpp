@@ -0,0 +1,68 @@
+#ifndef _SHADER_REFLECTION_HPP_
+#define	_SHADER_REFLECTION_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkanCore
+{
+	struct ShaderDescriptorBinding
+	{
+		uint32_t set = 0;
+		uint32_t binding = 0;
+		VkDescriptorType descriptorType = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		uint32_t descriptorCount = 1;
+		VkShaderStageFlags stageFlags = 0;
+		uint32_t blockSize = 0;
+		std::string name;
+	};
+
+	struct ShaderPushConstantRange
+	{
+		uint32_t offset = 0;
+		uint32_t size = 0;
+		VkShaderStageFlags stageFlags = 0;
+	};
+
+	struct ShaderVertexInput
+	{
+		uint32_t location = 0;
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		std::string name;
+	};
+
+	struct ShaderSpecializationConstant
+	{
+		uint32_t constantId = 0;
+		uint32_t size = 0;
+		std::string name;
+	};
+
+	struct ShaderReflectionData
+	{
+		VkShaderStageFlags stageFlags = 0;
+		std::vector<ShaderDescriptorBinding> descriptorBindings;
+		std::vector<ShaderPushConstantRange> pushConstantRanges;
+		std::vector<ShaderVertexInput> vertexInputs;
+		std::vector<ShaderSpecializationConstant> specializationConstants;
+
+		void Merge(const ShaderReflectionData& other);
+		std::vector<VkDescriptorSetLayoutBinding> GetDescriptorSetLayoutBindings(uint32_t set) const;
+		std::vector<VkPushConstantRange> GetPushConstantRanges() const;
+		void ValidateVertexInputs(const VkVertexInputAttributeDescription* attributes, size_t attributeCount) const;
+		bool IsLayoutCompatible(const ShaderReflectionData& stage) const;
+	};
+
+	class ShaderReflection
+	{
+	public:
+		static const uint32_t SPIRV_MAGIC = 0x07230203;
+
+		static void ValidateSpirv(const std::vector<uint32_t>& code, const std::string& sourceName);
+		static ShaderReflectionData Reflect(const std::vector<uint32_t>& code, const std::string& sourceName);
+	};
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _SHADER_WATCHER_HPP_
+#define	_SHADER_WATCHER_HPP_
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VulkanCore
+{
+	struct ShaderReloadResult
+	{
+		std::string sourcePath;
+		std::string outputPath;
+		std::vector<uint32_t> code;
+
+		// filled in by the reload handler on the watch thread, the pipeline is built from the stage code below
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		uint64_t pipelineGeneration = 0;
+		std::vector<uint32_t> vertexShaderCode;
+		std::vector<uint32_t> fragmentShaderCode;
+	};
+
+	// runs on the watch thread once a shader compiled, a reload it returns false for is not published
+	typedef std::function<bool(ShaderReloadResult&)> ShaderReloadHandler;
+
+	// watches the GLSL sources and recompiles changed shaders on a background thread
+	class ShaderWatcher
+	{
+	public:
+		ShaderWatcher(const std::string& sourceDirectory, const std::string& outputDirectory);
+		~ShaderWatcher();
+
+		// set before Start, the expensive part of applying a reload then stays off the render thread
+		void SetReloadHandler(ShaderReloadHandler handler);
+		void Start();
+		void Stop();
+		std::vector<ShaderReloadResult> ConsumeReloads();
+
+	protected:
+		std::string SourceDirectory;
+		std::string OutputDirectory;
+
+		std::thread WatchThread;
+		std::atomic<bool> IsRunning;
+		ShaderReloadHandler ReloadHandler;
+
+		std::mutex ReloadsLock;
+		std::vector<ShaderReloadResult> PendingReloads;
+
+		void WatchLoop();
+		std::set<std::string> WaitForChanges();
+		void Recompile(const std::string& fileName);
+
+#ifdef __linux__
+		int InotifyDescriptor = -1;
+#else
+		std::map<std::string, std::filesystem::file_time_type> LastWriteTimes;
+
+		std::set<std::string> ScanDirectory();
+#endif
+	};
+}
+
+#endif
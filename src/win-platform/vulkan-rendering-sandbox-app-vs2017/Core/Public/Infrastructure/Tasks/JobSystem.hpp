@@ -0,0 +1,120 @@
+#ifndef _JOB_SYSTEM_HPP_
+#define	_JOB_SYSTEM_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VulkanCore
+{
+	class JobSystem;
+
+	// counts the unfinished jobs of a batch, jobs queued after it reach zero run as its continuations
+	class JobCounter
+	{
+	public:
+		bool IsDone() const;
+
+	protected:
+		friend class JobSystem;
+
+		struct Continuation
+		{
+			const char* name;
+			std::function<void()> work;
+			JobCounter* counter;
+		};
+
+		// only ever decremented under the lock, a waiter that saw zero takes the lock once before it lets go
+		// of the counter, by then the job that finished the batch is done with it
+		std::atomic<uint32_t> PendingJobs{ 0 };
+		std::mutex Lock;
+		std::vector<Continuation> Continuations;
+		std::exception_ptr Failure;
+	};
+
+	// persistent workers that each own a deque, a worker pops its own newest job and steals the oldest one
+	// of another worker when it runs dry; threads outside the system queue into a shared injection queue
+	// and help with any job while they wait, so waiting never blocks a worker
+	class JobSystem
+	{
+	public:
+		// lock free deques have a fixed size, a job that does not fit runs right away instead
+		const static uint32_t DEQUE_CAPACITY = 4096;
+
+		explicit JobSystem(uint32_t workerCount = GetDefaultWorkerCount());
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// names are string literals, they label the trace zones of the jobs
+		void Run(const char* name, std::function<void()> work, JobCounter* counter = nullptr);
+		// queues the job once every job of the dependency finished, without holding a worker in the meantime
+		void RunAfter(JobCounter& dependency, const char* name, std::function<void()> work, JobCounter* counter = nullptr);
+
+		// runs other jobs until the counter reaches zero, then rethrows the first exception one of its jobs threw
+		void Wait(JobCounter& counter);
+
+		// splits [begin, end) into chunks of at least grainSize, the calling thread takes part
+		void ParallelFor(const char* name, size_t begin, size_t end, size_t grainSize, const std::function<void(size_t chunkBegin, size_t chunkEnd)>& work);
+
+		uint32_t GetWorkerCount() const;
+
+		// one worker less than hardware threads, the thread that waits is the last one
+		static uint32_t GetDefaultWorkerCount();
+		// the system engine subsystems share, created on first use
+		static JobSystem& GetShared();
+
+	protected:
+		struct Job
+		{
+			const char* name;
+			std::function<void()> work;
+			JobCounter* counter;
+		};
+
+		// Chase-Lev deque, only the owning worker pushes and pops at the bottom, anyone steals from the top
+		class WorkStealingDeque
+		{
+		public:
+			WorkStealingDeque();
+
+			bool Push(Job* job);
+			Job* Pop();
+			Job* Steal();
+
+		protected:
+			std::atomic<int64_t> Top{ 0 };
+			std::atomic<int64_t> Bottom{ 0 };
+			std::vector<std::atomic<Job*>> Jobs;
+		};
+
+		std::vector<WorkStealingDeque*> Deques;
+		std::vector<std::thread> Workers;
+
+		std::mutex InjectionLock;
+		std::deque<Job*> InjectedJobs;
+
+		// jobs queued but not yet taken, idle workers sleep while it is zero
+		std::atomic<int64_t> QueuedJobs{ 0 };
+		std::atomic<uint32_t> SleepingWorkers{ 0 };
+		std::atomic<bool> Stopping{ false };
+		std::mutex SleepLock;
+		std::condition_variable SleepSignal;
+
+		void Enqueue(Job* job);
+		Job* TakeJob(int32_t workerIndex);
+		void Execute(Job* job);
+		void Finish(JobCounter& counter, std::exception_ptr failure);
+		void WorkerLoop(uint32_t workerIndex);
+	};
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _TASK_GRAPH_HPP_
+#define	_TASK_GRAPH_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "JobSystem.hpp"
+
+namespace VulkanCore
+{
+	// tasks run as jobs as soon as all of their dependencies finished
+	class TaskGraph
+	{
+	public:
+		typedef uint32_t TaskId;
+
+		// names are string literals, they label the trace zones of the tasks
+		TaskId AddTask(const char* name, std::function<void()> work, const std::vector<TaskId>& dependencies = {});
+
+		// the calling thread works as well, the first exception thrown by a task is rethrown once running tasks finished
+		void Run(JobSystem& jobs);
+
+		size_t GetTaskCount() const;
+
+	protected:
+		struct Task
+		{
+			const char* name;
+			std::function<void()> work;
+			std::vector<TaskId> dependents;
+			uint32_t dependencyCount = 0;
+		};
+
+		std::vector<Task> Tasks;
+	};
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef _TRIPLE_BUFFER_HPP_
+#define	_TRIPLE_BUFFER_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+namespace VulkanCore
+{
+	// hands the latest value from one producer thread to one consumer thread without locks or waiting,
+	// the producer writes its own slot, the consumer reads its own and the third one is swapped between them
+	template <typename T>
+	class TripleBuffer
+	{
+	public:
+		// the producer's slot, only ever touched by the producer until it is published
+		T& GetWriteSlot()
+		{
+			return this->Slots[this->WriteIndex];
+		}
+
+		// makes the write slot the newest value, a value the consumer never picked up is overwritten
+		void Publish()
+		{
+			const uint32_t previous = this->State.exchange(this->WriteIndex | FRESH_BIT, std::memory_order_acq_rel);
+			this->WriteIndex = previous & INDEX_MASK;
+		}
+
+		// moves the newest published value into the read slot, false when nothing was published since
+		bool Acquire()
+		{
+			if ((this->State.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+			{
+				return false;
+			}
+
+			const uint32_t previous = this->State.exchange(this->ReadIndex, std::memory_order_acq_rel);
+			this->ReadIndex = previous & INDEX_MASK;
+			return true;
+		}
+
+		// the consumer's slot, stays valid until its next Acquire
+		const T& GetReadSlot() const
+		{
+			return this->Slots[this->ReadIndex];
+		}
+
+		// whether a published value is still waiting for the consumer
+		bool IsPending() const
+		{
+			return (this->State.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+		}
+
+	protected:
+		const static uint32_t INDEX_MASK = 0x3;
+		const static uint32_t FRESH_BIT = 0x4;
+
+		T Slots[3];
+		uint32_t WriteIndex = 0;
+		uint32_t ReadIndex = 2;
+		// index of the slot in the middle, with FRESH_BIT set while it holds an unread value
+		std::atomic<uint32_t> State{ 1 };
+	};
+}
+
+#endif
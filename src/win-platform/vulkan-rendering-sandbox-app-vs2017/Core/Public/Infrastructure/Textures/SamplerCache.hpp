@@ -0,0 +1,68 @@
+#ifndef _SAMPLER_CACHE_HPP_
+#define	_SAMPLER_CACHE_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace VulkanCore
+{
+	struct SamplerKey
+	{
+		VkSamplerCreateFlags flags;
+		VkFilter magFilter;
+		VkFilter minFilter;
+		VkSamplerMipmapMode mipmapMode;
+		VkSamplerAddressMode addressModeU;
+		VkSamplerAddressMode addressModeV;
+		VkSamplerAddressMode addressModeW;
+		float mipLodBias;
+		VkBool32 anisotropyEnable;
+		float maxAnisotropy;
+		VkBool32 compareEnable;
+		VkCompareOp compareOp;
+		float minLod;
+		float maxLod;
+		VkBorderColor borderColor;
+		VkBool32 unnormalizedCoordinates;
+
+		explicit SamplerKey(const VkSamplerCreateInfo& createInfo);
+
+		bool operator==(const SamplerKey& other) const;
+		VkSamplerCreateInfo ToCreateInfo() const;
+	};
+
+	struct SamplerKeyHash
+	{
+		size_t operator()(const SamplerKey& key) const;
+	};
+
+	class SamplerCache
+	{
+	public:
+		SamplerCache(VkDevice device, VkPhysicalDevice physicalDevice);
+		~SamplerCache();
+
+		VkSampler GetSampler(const VkSamplerCreateInfo& createInfo);
+		void Clear();
+
+		uint64_t GetHitCount() const;
+		uint64_t GetMissCount() const;
+		size_t GetSamplerCount() const;
+
+	protected:
+		VkDevice vkDevice;
+		float MaxSamplerAnisotropy;
+		VkBool32 AnisotropySupported;
+		uint32_t MaxSamplerAllocationCount;
+
+		uint64_t HitCount = 0;
+		uint64_t MissCount = 0;
+
+		std::unordered_map<SamplerKey, VkSampler, SamplerKeyHash> Samplers;
+
+		SamplerKey Normalize(const VkSamplerCreateInfo& createInfo) const;
+	};
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef _TEXTURE_STREAMER_HPP_
+#define	_TEXTURE_STREAMER_HPP_
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Utils/IOUtils.hpp"
+#include "../Profiling/GpuProfiler.hpp"
+
+namespace VulkanCore
+{
+	struct StreamedTexture
+	{
+		std::string filePath;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+
+		// decoded RGBA8 mip chain, level 0 is the finest one
+		std::vector<std::vector<stbi_uc>> mipData;
+
+		// finest level currently sampled, levels [residentMip, mipLevels) are resident
+		uint32_t residentMip = 0;
+		uint32_t requestedMip = 0;
+		uint64_t lastUsedFrame = 0;
+
+		// the coarse levels [tailMip, mipLevels) stay in the tail image for the texture's lifetime
+		uint32_t tailMip = 0;
+		VkImage tailImage = VK_NULL_HANDLE;
+		VkDeviceMemory tailImageMemory = VK_NULL_HANDLE;
+		VkImageView tailImageView = VK_NULL_HANDLE;
+
+		// finer levels stream into the detail image, allocated once for levels [detailMip, mipLevels)
+		uint32_t detailMip = 0;
+		VkDeviceSize detailBytes = 0;
+		VkImage detailImage = VK_NULL_HANDLE;
+		VkDeviceMemory detailImageMemory = VK_NULL_HANDLE;
+
+		// the tail image view, or a view of the detail image starting at residentMip
+		VkImageView imageView = VK_NULL_HANDLE;
+	};
+
+	class TextureStreamer
+	{
+	public:
+		// textures start with mips no larger than this resident, finer levels are streamed on demand
+		const static uint32_t INITIAL_RESIDENT_DIMENSION = 64;
+
+		TextureStreamer(
+			VkDevice device,
+			VkPhysicalDevice physicalDevice,
+			VkCommandPool commandPool,
+			VkQueue graphicsQueue,
+			VkDeviceSize budgetBytes = 0,
+			float heapBudgetFraction = 0.5f,
+			VkDeviceSize maxUploadBytesPerFrame = 16 * 1024 * 1024);
+		~TextureStreamer();
+
+		// decoding touches no Vulkan state and may run on any thread
+		static StreamedTexture DecodeTexture(const std::string& filePath);
+
+		uint32_t RegisterTexture(const std::string& filePath);
+		uint32_t RegisterTexture(StreamedTexture&& texture);
+		void RequestScreenSize(uint32_t textureId, float screenSpacePixels, uint64_t frameIndex);
+		// records this frame's uploads into its command buffer, true when an image view changed
+		bool Update(uint64_t frameIndex, VkCommandBuffer commandBuffer);
+
+		VkImageView GetImageView(uint32_t textureId) const;
+		uint32_t GetMipLevels(uint32_t textureId) const;
+		uint32_t GetResidentMip(uint32_t textureId) const;
+		VkDeviceSize GetBudget() const;
+		// includes images that were replaced but are still waiting to retire
+		VkDeviceSize GetResidentBytes() const;
+
+		// uploads are timed as "texture upload" scopes once a profiler is set
+		void SetProfiler(GpuProfiler* profiler);
+
+	protected:
+		struct RetiredImage
+		{
+			VkImage image;
+			VkDeviceMemory imageMemory;
+			VkImageView imageView;
+			VkDeviceSize size;
+			uint64_t retireFrame;
+		};
+
+		struct RetiredBuffer
+		{
+			VkBuffer buffer;
+			VkDeviceMemory bufferMemory;
+			uint64_t retireFrame;
+		};
+
+		VkDevice vkDevice;
+		VkPhysicalDevice vkPhysicalDevice;
+		VkCommandPool vkCommandPool;
+		VkQueue vkGraphicsQueue;
+		GpuProfiler* Profiler = nullptr;
+
+		VkDeviceSize Budget;
+		VkDeviceSize MaxUploadBytesPerFrame;
+		VkDeviceSize ResidentBytes = 0;
+		VkDeviceSize RetiredBytes = 0;
+		bool ResidencyChanged = false;
+
+		std::vector<StreamedTexture> Textures;
+		std::vector<RetiredImage> RetiredImages;
+		std::vector<RetiredBuffer> RetiredStagingBuffers;
+
+		static VkDeviceSize QueryDeviceLocalHeapSize(VkPhysicalDevice physicalDevice);
+		static void GenerateMipChain(StreamedTexture& texture, const stbi_uc* pixels);
+		static VkDeviceSize GetMipRangeSize(const StreamedTexture& texture, uint32_t firstMip);
+
+		void StageMips(
+			const StreamedTexture& texture,
+			uint32_t firstMip,
+			uint32_t endMip,
+			uint32_t imageBaseMip,
+			VkBuffer& stagingBuffer,
+			VkDeviceMemory& stagingBufferMemory,
+			std::vector<VkBufferImageCopy>& regions);
+
+		// evicted images hold their memory until they retire, so room made here may only be usable in a later update
+		bool EvictLeastRecentlyUsed(VkDeviceSize requiredBytes, uint64_t frameIndex, uint32_t protectedTextureId);
+		void CreateTailImage(uint32_t textureId);
+		void CreateDetailImage(uint32_t textureId, uint32_t detailMip, uint64_t frameIndex, VkCommandBuffer commandBuffer);
+		void UploadDetailMip(uint32_t textureId, uint32_t level, uint64_t frameIndex, VkCommandBuffer commandBuffer);
+		void EvictDetailImage(uint32_t textureId, uint64_t frameIndex);
+		void RetireImage(VkImage image, VkDeviceMemory imageMemory, VkImageView imageView, VkDeviceSize size, uint64_t frameIndex);
+		void CollectRetiredResources(uint64_t frameIndex, bool force);
+	};
+}
+
+#endif
@@ -1,15 +1,36 @@
 #ifndef _RENDER_ENGINE_HPP_
 #define	_RENDER_ENGINE_HPP_
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <vector>
 #include <iostream>
 #include <set>
 #include <map>
+#include <mutex>
+#include <condition_variable>
 #include "Utils/MemoryUtils.hpp"
 #include "Utils/IOUtils.hpp"
+#include "Infrastructure/Extensions/DeviceSelectionPolicy.hpp"
 #include "Infrastructure/Extensions/QueueFamilyIndices.hpp"
 #include "Infrastructure/Extensions/SwapChainSupportDetails.hpp"
+#include "Infrastructure/Meshes/CookedMesh.hpp"
+#include "Infrastructure/Meshes/MeshLodSelector.hpp"
+#include "Infrastructure/Profiling/CpuTrace.hpp"
+#include "Infrastructure/Profiling/GpuProfiler.hpp"
+#include "Infrastructure/Rendering/MeshletCullingPass.hpp"
+#include "Infrastructure/Rendering/RenderGraph.hpp"
+#include "Infrastructure/Rendering/WorleyNoisePass.hpp"
+#include "Infrastructure/Scene/FramePacket.hpp"
+#include "Infrastructure/Scene/SceneGraph.hpp"
+#include "Infrastructure/Shaders/PipelineVariantCache.hpp"
+#include "Infrastructure/Shaders/ShaderReflection.hpp"
+#include "Infrastructure/Shaders/ShaderWatcher.hpp"
+#include "Infrastructure/Tasks/TaskGraph.hpp"
+#include "Infrastructure/Tasks/TripleBuffer.hpp"
+#include "Infrastructure/Textures/SamplerCache.hpp"
+#include "Infrastructure/Textures/TextureStreamer.hpp"
 
 namespace VulkanCore
 {
@@ -17,18 +38,68 @@ namespace VulkanCore
 	 {
 	 public:
 		 const static int MAX_FRAMES_IN_FLIGHT = 2;
+		 // VK_RENDER_MSAA=<2, 4 or 8> requests multisampling, the device limits clamp it
+		 const static char* SAMPLE_COUNT_VARIABLE;
+		 // VK_RENDER_NOISE=1 adds the animated Worley noise post-process
+		 const static char* NOISE_VARIABLE;
+		 // VK_RENDER_MESHLET_CULLING=1 culls the meshlets of the model in a compute pass before drawing them
+		 const static char* MESHLET_CULLING_VARIABLE;
+		 // VK_RENDER_PIPELINED_UPDATE=1 simulates the next frame on an update thread while the current one is submitted
+		 const static char* PIPELINED_UPDATE_VARIABLE;
 		 RenderEngine(
 			 int width,
 			 int height,
 			 std::string modelPath,
 			 std::string baseColorTexturePath,
-			 GLFWwindow* window
+			 GLFWwindow* window,
+			 uint32_t sampleCount = 1,
+			 bool postProcessNoise = false,
+			 bool meshletCulling = false
+		 );
+		 // headless engine, frames are rendered into offscreen images and read back with ReadbackFrame
+		 RenderEngine(
+			 int width,
+			 int height,
+			 std::string modelPath,
+			 std::string baseColorTexturePath,
+			 uint32_t sampleCount = 1,
+			 bool postProcessNoise = false,
+			 bool meshletCulling = false
 		 );
 		 ~RenderEngine();
 		 virtual void BootstrapPipeline();
 		 virtual void CleanPipeline();
 		 virtual void Draw();
 		 virtual void WaitDevice();
+		 void ReadbackFrame(std::vector<uint8_t>& pixels);
+		 uint32_t GetFrameWidth() const;
+		 uint32_t GetFrameHeight() const;
+		 void SetFixedTimestep(double seconds);
+		 // in pipelined mode Draw renders the newest packet of UpdateFramePacket instead of simulating itself,
+		 // enabling it publishes the first packet so there is always one to render
+		 void SetPipelinedUpdate(bool enabled);
+		 bool IsPipelinedUpdate() const;
+		 // simulates the next frame and publishes its packet, only ever called from one thread at a time
+		 void UpdateFramePacket();
+		 // blocks until Draw picked up the last published packet, false once CancelFramePacketWait was called
+		 bool WaitForFramePacketConsumed();
+		 void CancelFramePacketWait();
+		 const std::vector<std::pair<std::string, double>>& GetLoadTimings() const;
+		 bool GetLastGpuFrameTime(uint64_t& frameIndex, double& milliseconds) const;
+		 const GpuProfiler* GetGpuProfiler() const;
+		 const RenderGraph* GetRenderGraph() const;
+		 std::string GetDeviceName() const;
+		 VkDeviceSize GetTextureResidentBytes() const;
+		 uint32_t GetSampleCount() const;
+		 uint32_t GetModelLod() const;
+		 const std::vector<MeshLod>& GetModelLods() const;
+		 const std::vector<Meshlet>& GetModelMeshlets() const;
+		 // meshlets of the current level the culling pass keeps, counted on the CPU with the same test
+		 uint32_t CountVisibleMeshlets() const;
+		 static uint32_t GetSampleCountFromEnvironment();
+		 static bool GetPostProcessNoiseFromEnvironment();
+		 static bool GetMeshletCullingFromEnvironment();
+		 static bool GetPipelinedUpdateFromEnvironment();
 		 bool FrameBufferResized = false;
 
 	 protected:
@@ -38,6 +109,13 @@ namespace VulkanCore
 		 std::string BaseColorTexturePath;
 		 GLFWwindow *GLWindow = nullptr;
 		 bool IsPipelineInitialized = false;
+		 bool IsHeadless = false;
+		 uint32_t RequestedSampleCount = 1;
+		 VkSampleCountFlagBits SampleCount = VK_SAMPLE_COUNT_1_BIT;
+		 bool PostProcessNoise = false;
+		 bool MeshletCulling = false;
+		 bool MultiDrawIndirect = false;
+		 bool UseValidationLayers = false;
 		 bool CheckVkValidationLayerSupport() const;
 		 VkResult CreateVkInstanceWithCheck(
 			 const VkInstanceCreateInfo* pCreateInfo,
@@ -54,41 +132,71 @@ namespace VulkanCore
 			 VkDebugReportCallbackEXT callback,
 			 const VkAllocationCallbacks* pAllocator);
 		 std::vector<const char*> GetRequiredExtensions() const;
+		 std::vector<const char*> GetRequiredDeviceExtensions() const;
 
 		 bool ThrottleCheck() const;
+		 void RunLoadPhase(const char* name, void (RenderEngine::*phase)());
+		 TaskGraph::TaskId AddLoadPhase(
+			 TaskGraph& bootstrap,
+			 const char* name,
+			 void (RenderEngine::*phase)(),
+			 const std::vector<TaskGraph::TaskId>& dependencies = {});
+		 void CreateGpuProfiler();
 		 void CreateVulkanInstance();
 		 void SetupDebugCallback();
 		 void CreateLogicalDevice();
 		 void CreateSwapChain();
+		 void CreateOffscreenTargets();
 		 void PickPhysicalDevice();
 		 void CreateSurface();
 		 void CreateImageViews();
+		 void DecodeTextures();
 		 void LoadTextures();
 		 void CreateTextureViews();
+		 void LoadShaders();
 		 void CreateDescriptorSetLayout();
+		 void CreatePipelineLayout();
 		 void CreateGraphicsPipeline();
-		 void CreateFrameBuffers();
+		 VkPipeline BuildGraphicsPipeline(
+			 const std::vector<uint32_t>& vertexShaderCode,
+			 const std::vector<uint32_t>& fragmentShaderCode,
+			 const VkSpecializationInfo* specializationInfo);
+		 // swaps in the pipeline of the newest reload, it was built by PrepareShaderReload on the watch thread
+		 void ApplyShaderReloads();
+		 bool PrepareShaderReload(ShaderReloadResult& reload);
+		 void DestroyRetiredPipelines(bool force);
 		 void CreateCommandPool();
 		 void CreateCommandBuffers();
+		 void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+		 void RecordMainPass(VkCommandBuffer commandBuffer);
+		 void PushDrawConstants(VkCommandBuffer commandBuffer, const DrawPushConstants& drawConstants) const;
 		 void CreatePipelineSyncObjects();
 		 void CleanSwapChain();
 		 void UpdateSwapChain();
 		 void InitializeSampler();
 		 void CreateDescriptorSet();
-		 bool IsDeviceSuitable(VkPhysicalDevice device) const;
+		 bool IsDeviceSuitable(VkPhysicalDevice device, std::string& rejectReason) const;
 		 bool CheckDeviceExtensionsSupport(VkPhysicalDevice device) const;
-		 void CreateRenderPass();
+		 VkSampleCountFlagBits ChooseSampleCount(uint32_t requestedSampleCount) const;
+		 void CreateRenderGraph();
+		 void RecordPresentCopy(VkCommandBuffer commandBuffer);
+		 void LoadModel();
 		 void CreateGeometryBuffers();
+		 void CreateMeshletCulling();
 		 void CreateDescriptorPool();
-		 void CreateUniformBuffer();
-		 void CreateDepthResources();
-		 void UpdateUniformBuffer(uint32_t currentImage);
+		 void UpdateFrameConstants();
+		 void BuildFramePacket(FramePacket& packet);
+		 void SelectModelLod(const glm::mat4& model, const glm::vec3& eye);
+		 float GetModelScreenSize(const glm::mat4& model, const glm::vec3& eye) const;
+		 void UpdateMeshletCulling(const glm::mat4& modelViewProjection, const glm::mat4& model, const glm::vec3& eye);
+		 void UpdateTextureStreaming(VkCommandBuffer commandBuffer);
+		 void UpdateTextureDescriptor(size_t frameSlot);
 
-		 static int RateDeviceSuitability(VkPhysicalDevice device);
 		 QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device) const;
 		 VkInstance vkInstance;
 		 VkDebugReportCallbackEXT vkCallback;
 		 VkPhysicalDevice vkPhysicalDevice = VK_NULL_HANDLE;
+		 DeviceSelectionPolicy DevicePolicy = DeviceSelectionPolicy::FromEnvironment();
 		 VkDevice vkDevice;
 		 VkQueue vkGraphicsQueue;
 		 VkQueue vkPresentQueue;
@@ -96,18 +204,32 @@ namespace VulkanCore
 		 VkSwapchainKHR vkSwapChain;
 		 std::vector<VkImage> vkSwapChainImages;
 		 std::vector<VkImageView> vkSwapChainImageViews;
-		 std::vector<VkFramebuffer> vkSwapChainFrameBuffers;
 		 VkFormat vkSwapChainImageFormat;
 		 VkExtent2D vkExtent;
 		 VkColorSpaceKHR vkSwapChainImageColorSpace;
+		 std::vector<VkDeviceMemory> vkOffscreenImagesMemory;
+		 uint32_t LastRenderedImage = 0;
 
+		 RenderGraph* FrameGraph = nullptr;
+		 RenderGraphResource BackBufferResource = 0;
+		 RenderGraphResource MultisampledColorResource = 0;
+		 RenderGraphResource SceneColorResource = 0;
+		 WorleyNoisePass* NoisePass = nullptr;
+		 float AnimationTime = 0.0f;
+		 RenderGraphResource DepthResource = 0;
+		 uint32_t MainPass = 0;
+		 uint32_t RecordingImageIndex = 0;
 		 VkRenderPass vkRenderPass;
 		 VkDescriptorSetLayout vkDescriptorSetLayout;
 		 VkDescriptorPool vkDescriptorPool;
+		 // one set per frame in flight, a set is only rewritten once the fence of its frame was waited on
 		 std::vector<VkDescriptorSet> vkDescriptorSets;
 
 		 VkPipelineLayout vkPipelineLayout;
+		 std::vector<VkPushConstantRange> PushConstantRanges;
 		 VkPipeline vkGraphicsPipeline;
+		 std::vector<std::pair<VkPipeline, uint64_t>> RetiredPipelines;
+		 DrawPushConstants ModelDrawConstants = {};
 
 		 // buffers
 
@@ -115,9 +237,24 @@ namespace VulkanCore
 		 VkDeviceMemory vkVertexBufferMemory;
 		 VkBuffer vkIndexBuffer;
 		 VkDeviceMemory vkIndexBufferMemory;
+		 // vertex and index data are released once uploaded, the levels of detail stay for selection
+		 CookedMesh ModelMesh;
+		 uint32_t ModelLod = 0;
+		 MeshLodSettings LodSettings;
+		 MeshletCullingPass* MeshletCuller = nullptr;
+		 MeshletCullingConstants CullingConstants = {};
+		 // the model is a node of the scene, its world transform is the model matrix
+		 SceneGraph Scene;
+		 SceneNodeId ModelNode = 0;
+		 // simulated frames, the scene graph belongs to whichever thread runs UpdateFramePacket
+		 TripleBuffer<FramePacket> FramePackets;
+		 bool PipelinedUpdate = false;
+		 uint64_t UpdateNumber = 0;
+		 // wakes the update thread when Draw acquires a packet, so it does not spin while one is pending
+		 std::mutex FramePacketLock;
+		 std::condition_variable FramePacketSignal;
+		 bool FramePacketWaitCancelled = false;
 
-		 std::vector<VkBuffer> vkUniformBuffers;
-		 std::vector<VkDeviceMemory> vkUniformBuffersMemory;
 
 		 // semaphores
 
@@ -125,6 +262,17 @@ namespace VulkanCore
 		 std::vector<VkSemaphore> vkRenderFinishedSemLocks;
 		 std::vector<VkFence> vkInFlightSyncFences;
 		 size_t currentFrame = 0;
+		 uint64_t frameNumber = 0;
+
+		 // timing
+
+		 std::chrono::high_resolution_clock::time_point StartTime;
+		 double FixedTimestep = 0.0;
+		 std::vector<std::pair<std::string, double>> LoadTimings;
+		 std::mutex LoadTimingsLock;
+		 GpuProfiler* Profiler = nullptr;
+		 uint64_t ProfilerLogInterval = 300;
+		 std::string TraceOutputPath;
 
 		 // command pool and etc.
 
@@ -133,18 +281,16 @@ namespace VulkanCore
 
 		 // Textures
 
-		 stbi_uc* PixelBuffer;
-		 VkImage vkTextureImage;
-		 VkDeviceMemory vkTextureImageMemory;
+		 TextureStreamer* TextureStreaming = nullptr;
+		 uint32_t BaseColorTextureId = 0;
+		 StreamedTexture DecodedBaseColorTexture;
 		 VkImageView vkTextureImageView;
+		 // the texture view each frame slot's descriptor set was last written with
+		 std::vector<VkImageView> DescriptorTextureViews;
+		 uint32_t BaseColorTextureBinding = 0;
+		 SamplerCache* Samplers = nullptr;
 		 VkSampler vkTextureSampler;
 
-		 // depth buffer
-
-		 std::vector<VkImage> vkDepthImages;
-		 std::vector<VkDeviceMemory> vkDepthImagesMemory;
-		 std::vector<VkImageView> vkDepthImagesView;
-
 		 const bool enableValidationLayers = true;
 		 const std::vector<const char*> validationLayers = {
 			 "VK_LAYER_LUNARG_standard_validation"
@@ -155,8 +301,24 @@ namespace VulkanCore
 
 		 // shaders
 
-		 VkShaderModule vkVertrexShader;
-		 VkShaderModule vkFragmentShader;
+		 const std::string ShaderSourceDirectory = "../Shaders";
+		 const std::string ShaderOutputDirectory = "../Shaders/Compiled";
+		 const std::string VertexShaderPath = "../Shaders/Compiled/base_ubo_vertrex_shader.vert.spv";
+		 const std::string FragmentShaderPath = "../Shaders/Compiled/base_fragment_shader.frag.spv";
+		 const std::string NoiseShaderPath = "../Shaders/Compiled/worley_post_process.comp.spv";
+		 const std::string MeshletCullingShaderPath = "../Shaders/Compiled/meshlet_cull.comp.spv";
+		 std::vector<uint32_t> VertexShaderCode;
+		 std::vector<uint32_t> FragmentShaderCode;
+		 ShaderReflectionData ShaderLayout;
+		 // the watch thread's view of the stage code, ahead of the bound pipeline until its reload is applied
+		 std::vector<uint32_t> HotReloadVertexShaderCode;
+		 std::vector<uint32_t> HotReloadFragmentShaderCode;
+		 // held while the swap chain is recreated or a reload pipeline is built against it
+		 std::mutex PipelineStateLock;
+		 uint64_t PipelineGeneration = 0;
+		 uint32_t MaterialFeatures = SHADER_FEATURE_TEXTURE;
+		 PipelineVariantCache* PipelineVariants = nullptr;
+		 ShaderWatcher* ShaderHotReload = nullptr;
 
 	 private:
 		std::chrono::time_point
@@ -36,18 +36,24 @@ namespace std {
 	};
 }
 
-struct UniformBufferObject
+// per-draw data recorded with vkCmdPushConstants, no buffer writes or descriptor updates needed
+struct DrawPushConstants
 {
-	glm::mat4 model;
-	glm::mat4 view;
-	glm::mat4 projection;
+	// projection * view * model, combined once per draw instead of once per vertex
+	glm::mat4 modelViewProjection;
+	uint32_t materialIndex;
 };
 
+// 128 bytes is the maxPushConstantsSize every implementation has to support
+static_assert(sizeof(DrawPushConstants) <= 128, "DrawPushConstants exceeds the guaranteed push constant size");
+
 struct GraphicsPipelineUtils
 {
 	static VkCommandBuffer BeginSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
 	static void EndSingleTimeCommands(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkCommandBuffer commandBuffer);
 	static VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkDevice device);
+	static VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkDevice device);
+	static VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t mipLevels, VkDevice device);
 	static VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling,
 	                             VkFormatFeatureFlags features, VkPhysicalDevice physicalDevice);
 	static VkFormat FindDepthFormat(VkPhysicalDevice physicalDevice);
@@ -2,6 +2,7 @@
 #define	_IO_UTILS_HPP_
 
 #include <stb_image.h>
+#include <stb_image_write.h>
 
 #include <string>
 #include "MemoryUtils.hpp"
@@ -14,13 +15,28 @@ class ShaderExtensions
 {
 public:
 	static std::vector<char> ReadShaderFile(const std::string& fileName);
+	static std::vector<uint32_t> ReadSpirvFile(const std::string& fileName);
 	static VkShaderModule CreateShaderModule(const VkDevice& device, const std::vector<char>& shaderText);
+	static VkShaderModule CreateShaderModule(const VkDevice& device, const std::vector<uint32_t>& shaderCode);
 	static stbi_uc* CreateTextureImage(const char* filePath, int* textureWidth, int* textureHeight, int* textureChannels);
+	static void SaveTextureImage(const char* filePath, int textureWidth, int textureHeight, const std::vector<uint8_t>& pixels);
 };
 
 class MeshExtensions
 {
 public:
+	static void LoadModel(const char* modelPath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+	static void CreateModelBuffers(
+		const std::vector<Vertex>& vertices,
+		const std::vector<uint32_t>& indices,
+		VkDevice device,
+		VkPhysicalDevice physicalDevice,
+		VkCommandPool commandPool,
+		VkQueue graphicsQueue,
+		VkBuffer& vertexBuffer,
+		VkDeviceMemory& vertexBufferMemory,
+		VkBuffer& indexBuffer,
+		VkDeviceMemory& indexBufferMemory);
 	static void LoadModelToMemoryBuffer(
 		const char* modelPath,
 		VkDevice device,
@@ -20,6 +20,13 @@ namespace MemoryUtils
 		VkMemoryPropertyFlags properties,
 		VkPhysicalDevice physicalDevice);
 
+	// same lookup as FindMemoryType for optional property sets, returns false instead of throwing
+	bool TryFindMemoryType(
+		uint32_t typeFilter,
+		VkMemoryPropertyFlags properties,
+		VkPhysicalDevice physicalDevice,
+		uint32_t& memoryTypeIndex);
+
 	void CopyBuffer(
 		VkBuffer srcBuffer,
 		VkBuffer dstBuffer,
@@ -39,14 +46,54 @@ namespace MemoryUtils
 		VkDeviceMemory& imageMemory,
 		VkDevice device,
 		VkPhysicalDevice physicalDevice);
+
+	void CreateImage(
+		uint32_t width,
+		uint32_t height,
+		uint32_t mipLevels,
+		VkFormat format,
+		VkImageTiling tiling,
+		VkImageUsageFlags usage,
+		VkMemoryPropertyFlags properties,
+		VkImage& image,
+		VkDeviceMemory& imageMemory,
+		VkDevice device,
+		VkPhysicalDevice physicalDevice);
+
 	uint32_t FindMemoryType(
 		VkPhysicalDevice physicalDevice,
 		uint32_t typeFilter,
 		VkMemoryPropertyFlags properties);
 
+	// stages and accesses an image in the layout is used with, throws for layouts nothing in the renderer uses
+	void GetLayoutSyncScope(
+		VkImageLayout layout,
+		VkPipelineStageFlags& stageMask,
+		VkAccessFlags& accessMask);
+
+	VkImageAspectFlags GetImageAspectFlags(VkFormat format);
+
+	void RecordImageLayoutTransition(
+		VkCommandBuffer commandBuffer,
+		VkImage image,
+		VkFormat format,
+		uint32_t mipLevels,
+		VkImageLayout oldLayout,
+		VkImageLayout newLayout);
+
+	void TransitionImageLayout(
+		VkImage image,
+		VkFormat format,
+		VkImageLayout oldLayout,
+		VkImageLayout newLayout,
+		VkDevice device,
+		VkCommandPool commandPool,
+		VkQueue graphicsQueue);
+
 	void TransitionImageLayout(
 		VkImage image,
 		VkFormat format,
+		uint32_t mipLevels,
 		VkImageLayout oldLayout,
 		VkImageLayout newLayout,
 		VkDevice device,
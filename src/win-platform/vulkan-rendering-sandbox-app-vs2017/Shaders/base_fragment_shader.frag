@@ -1,13 +1,34 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// material features, see ShaderFeature in PipelineVariantCache.hpp
+// constants are folded when the pipeline is created, disabled paths do not reach the driver ISA
+layout(constant_id = 0) const bool USE_TEXTURE = true;
+layout(constant_id = 1) const bool USE_VERTEX_COLOR = false;
+layout(constant_id = 2) const bool USE_ALPHA_TEST = false;
+
+const float ALPHA_CUTOFF = 0.5;
+
 layout(location = 0) in vec3 fragColor;
-layout(location = 1) in mat4 resultMat;
-layout(location = 5) in vec2 fragTextureCoord;
+layout(location = 1) in vec2 fragTextureCoord;
 layout(binding = 1) uniform sampler2D texSampler;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTextureCoord * 0.75);
+	vec4 color = vec4(1.0);
+
+	if (USE_TEXTURE) {
+		color = texture(texSampler, fragTextureCoord * 0.75);
+	}
+
+	if (USE_VERTEX_COLOR) {
+		color.rgb *= fragColor;
+	}
+
+	if (USE_ALPHA_TEST && color.a < ALPHA_CUTOFF) {
+		discard;
+	}
+
+	outColor = color;
 }
@@ -1,28 +1,31 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
-	mat4 view;
-	mat4 projection;
-} ubo;
+// per-draw data, see DrawPushConstants in GraphUtils.hpp
+layout(push_constant) uniform DrawConstants {
+	mat4 modelViewProjection;
+	uint materialIndex;
+} draw;
+
+// same constant as in the fragment shader, the color output is only written when it reads it
+layout(constant_id = 1) const bool USE_VERTEX_COLOR = false;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTextureCoord;
 
 layout(location = 0) out vec3 fragColor;
-layout(location = 1) out mat4 resultMat;
-layout(location = 5) out vec2 fragTextureCoord;
+layout(location = 1) out vec2 fragTextureCoord;
 
 out gl_PerVertex {
 	vec4 gl_Position;
 };
 
 void main() {
-	resultMat = ubo.projection * ubo.view * ubo.model;
-
-	gl_Position = resultMat * vec4(inPosition, 1.0);
-	fragColor = inColor;
+	gl_Position = draw.modelViewProjection * vec4(inPosition, 1.0);
 	fragTextureCoord = inTextureCoord;
+
+	if (USE_VERTEX_COLOR) {
+		fragColor = inColor;
+	}
 }
\ No newline at end of file
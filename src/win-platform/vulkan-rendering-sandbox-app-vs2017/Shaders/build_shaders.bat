@@ -0,0 +1,27 @@
+@echo off
+rem Compiles the GLSL sources of this directory into optimized SPIR-V under Compiled\
+rem test_* shaders are experiments and are not part of the build.
+
+setlocal enabledelayedexpansion
+
+set SHADER_DIR=%~dp0
+set OUTPUT_DIR=%SHADER_DIR%Compiled
+
+if "%VULKAN_SDK%"=="" set VULKAN_SDK=%SHADER_DIR%..\..\..\..\..\VulkanSDK\1.1.73.0
+
+set GLSLANG="%VULKAN_SDK%\Bin\glslangValidator.exe"
+set SPIRV_OPT="%VULKAN_SDK%\Bin\spirv-opt.exe"
+
+if not exist "%OUTPUT_DIR%" mkdir "%OUTPUT_DIR%"
+
+for %%f in ("%SHADER_DIR%*.vert" "%SHADER_DIR%*.frag" "%SHADER_DIR%*.comp") do (
+	set SHADER_NAME=%%~nxf
+	if /I not "!SHADER_NAME:~0,5!"=="test_" (
+		echo %%~nxf
+		%GLSLANG% -V "%%f" -o "%OUTPUT_DIR%\%%~nxf.unopt.spv" || exit /b 1
+		%SPIRV_OPT% -O "%OUTPUT_DIR%\%%~nxf.unopt.spv" -o "%OUTPUT_DIR%\%%~nxf.spv" || exit /b 1
+		del "%OUTPUT_DIR%\%%~nxf.unopt.spv"
+	)
+)
+
+exit /b 0
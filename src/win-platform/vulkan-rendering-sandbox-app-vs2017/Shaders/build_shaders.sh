@@ -0,0 +1,32 @@
+#!/bin/sh
+# Compiles the GLSL sources of this directory into optimized SPIR-V under Compiled/
+# test_* shaders are experiments and are not part of the build.
+
+set -e
+
+SHADER_DIR="$(cd "$(dirname "$0")" && pwd)"
+OUTPUT_DIR="$SHADER_DIR/Compiled"
+
+if [ -n "$VULKAN_SDK" ]; then
+	GLSLANG="$VULKAN_SDK/bin/glslangValidator"
+	SPIRV_OPT="$VULKAN_SDK/bin/spirv-opt"
+else
+	GLSLANG=glslangValidator
+	SPIRV_OPT=spirv-opt
+fi
+
+mkdir -p "$OUTPUT_DIR"
+
+for shader in "$SHADER_DIR"/*.vert "$SHADER_DIR"/*.frag "$SHADER_DIR"/*.comp; do
+	[ -f "$shader" ] || continue
+
+	name="$(basename "$shader")"
+	case "$name" in
+		test_*) continue ;;
+	esac
+
+	echo "$name"
+	"$GLSLANG" -V "$shader" -o "$OUTPUT_DIR/$name.unopt.spv"
+	"$SPIRV_OPT" -O "$OUTPUT_DIR/$name.unopt.spv" -o "$OUTPUT_DIR/$name.spv"
+	rm "$OUTPUT_DIR/$name.unopt.spv"
+done